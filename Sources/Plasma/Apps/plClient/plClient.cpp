@@ -1050,6 +1050,11 @@ void plClient::IQueueRoomLoad(const std::vector<plLocation>& locs, bool hold)
 
         fLoadRooms.push_back(new LoadRequest(loc, hold));
 
+        // Rooms are paged in one at a time, so get the disk reads for the rest
+        // of them going in the background while we work on the first.
+        plResManager* mgr = (plResManager*)hsgResMgr::ResMgr();
+        mgr->PreloadPage(loc);
+
         if (lastAgeName.empty() || info->GetAge() == lastAgeName)
             lastAgeName = info->GetAge();
         else
@@ -1082,6 +1087,9 @@ void plClient::ILoadNextRoom()
         bool isLoading = IIsRoomLoading(req->loc);
         if (alreadyLoaded || isLoading)
         {
+            // Don't leave the read-ahead data for this request lying around
+            ((plResManager*)hsgResMgr::ResMgr())->CancelPreload(req->loc);
+
             delete req;
             req = nullptr;
             fNumLoadingRooms--;
@@ -117,6 +117,7 @@ enum
     kArgPlayerId,
     kArgStartUpAgeName,
     kArgPvdFile,
+    kArgPhysXThreads,
     kArgSkipIntroMovies,
     kArgRenderer
 };
@@ -130,6 +131,7 @@ static const plCmdArgDef s_cmdLineArgs[] = {
     { kCmdArgFlagged  | kCmdTypeInt,        "PlayerId",        kArgPlayerId },
     { kCmdArgFlagged  | kCmdTypeString,     "Age",             kArgStartUpAgeName },
     { kCmdArgFlagged  | kCmdTypeString,     "PvdFile",         kArgPvdFile },
+    { kCmdArgFlagged  | kCmdTypeInt,        "PhysXThreads",    kArgPhysXThreads },
     { kCmdArgFlagged  | kCmdTypeBool,       "SkipIntroMovies", kArgSkipIntroMovies },
     { kCmdArgFlagged  | kCmdTypeString,     "Renderer",        kArgRenderer },
 };
@@ -1089,6 +1091,8 @@ int WINAPI wWinMain(HINSTANCE hInst, HINSTANCE hPrevInst, LPWSTR lpCmdLine, int
         NetCommSetIniStartUpAge(cmdParser.GetString(kArgStartUpAgeName));
     if (cmdParser.IsSpecified(kArgPvdFile))
         plPXSimulation::SetDefaultDebuggerEndpoint(cmdParser.GetString(kArgPvdFile));
+    if (cmdParser.IsSpecified(kArgPhysXThreads))
+        plPXSimulation::SetDefaultWorkerThreads(std::max(cmdParser.GetInt(kArgPhysXThreads), 0));
     if (cmdParser.IsSpecified(kArgRenderer))
         gClient.SetRequestedRenderingBackend(ParseRendererArgument(cmdParser.GetString(kArgRenderer)));
 #endif
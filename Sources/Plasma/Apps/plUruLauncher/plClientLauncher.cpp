@@ -304,6 +304,7 @@ void plClientLauncher::PatchClient()
     patcher.OnFileDownloadDesired(std::bind(&plClientLauncher::IApproveDownload, this, std::placeholders::_1));
     patcher.OnSelfPatch([&](const plFileName& file) { fClientExecutable = file; });
     patcher.OnRedistUpdate([&](const plFileName& file) { fInstallerThread->fRedistQueue.push_back(file); });
+    patcher.UseHashCache("patcher.cache"); // don't rehash the entire install every launch
 
     // Let's get 'er done.
     if (hsCheckBits(fFlags, kHaveSelfPatched)) {
@@ -420,14 +420,19 @@ void hsBounds3::TestPlane(const hsVector3 &n, hsPoint2 &depth) const
 {
     hsAssert(fType == kBoundsNormal, "TestPlane only valid for kBoundsNormal filled bounds");
 
-    float dmax = fMins.InnerProduct(n);
+    TestBoxPlane(fMins, fMaxs, n, depth);
+}
+
+void hsBounds3::TestBoxPlane(const hsPoint3& mins, const hsPoint3& maxs, const hsVector3& n, hsPoint2& depth)
+{
+    float dmax = mins.InnerProduct(n);
     float dmin = dmax;
 
     int i;
     for( i = 0; i < 3; i++ )
     {
         float dd;
-        dd = fMaxs[i] - fMins[i];
+        dd = maxs[i] - mins[i];
         dd *= n[i];
 
         if( dd < 0 )
@@ -146,6 +146,9 @@ public:
     // neg, pos, zero == disjoint, I contain other, overlap
     virtual int32_t TestBound(const hsBounds3& other) const; 
 
+    // Same as TestPlane, for an axis aligned box kept outside of any bounds object
+    static void TestBoxPlane(const hsPoint3& mins, const hsPoint3& maxs, const hsVector3& n, hsPoint2& depth);
+
     static float ClosestPointToLine(const hsPoint3 *p, const hsPoint3 *v0, const hsPoint3 *v1, hsPoint3 *out);
     static float ClosestPointToInfiniteLine(const hsPoint3* p, const hsVector3* v, hsPoint3* out);
 
@@ -276,6 +279,7 @@ public:
     void MakeSymmetric(const hsPoint3* p) override; // Expands bounds to be symmetric about p
     void InscribeSphere() override;
     virtual void Unalign();
+    bool IsAxisAligned() const { return (fExtFlags & kAxisAligned) != 0; }
 
     void Transform(const hsMatrix44 *m) override;
     virtual void Translate(const hsVector3 &v);
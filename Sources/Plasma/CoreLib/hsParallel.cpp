@@ -0,0 +1,202 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include "hsParallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <string_theory/format>
+
+#include "hsLockGuard.h"
+#include "hsThread.h"
+
+// Upper bound on pool workers; parallel jobs in the engine are short bursts
+// from the main thread, so a very wide pool only adds wakeup latency.
+static constexpr size_t kMaxWorkers = 15;
+
+// Chunks per thread, so uneven chunks still balance out
+static constexpr size_t kChunksPerThread = 4;
+
+namespace
+{
+    class hsWorkerPool
+    {
+        std::mutex                          fMutex;
+        std::condition_variable             fWake;
+        std::deque<std::function<void()>>   fTasks;
+        std::vector<std::thread>            fThreads;
+        bool                                fQuit;
+
+        void IRun()
+        {
+            for (;;) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(fMutex);
+                    fWake.wait(lock, [this] { return fQuit || !fTasks.empty(); });
+                    if (fTasks.empty())
+                        return;
+                    task = std::move(fTasks.front());
+                    fTasks.pop_front();
+                }
+                task();
+            }
+        }
+
+    public:
+        hsWorkerPool() : fQuit()
+        {
+            size_t numThreads = std::thread::hardware_concurrency();
+            numThreads = std::min(numThreads > 1 ? numThreads - 1 : 0, kMaxWorkers);
+
+            fThreads.reserve(numThreads);
+            for (size_t i = 0; i < numThreads; ++i) {
+                fThreads.emplace_back(hsThread::StartSimpleThread([this, i] {
+                    hsThread::SetThisThreadName(ST::format("hsParallel{02d}", i));
+                    IRun();
+                }));
+            }
+        }
+
+        ~hsWorkerPool()
+        {
+            {
+                hsLockGuard(fMutex);
+                fQuit = true;
+            }
+            fWake.notify_all();
+            for (std::thread& thread : fThreads)
+                thread.join();
+        }
+
+        size_t GetNumWorkers() const { return fThreads.size(); }
+
+        void Post(std::function<void()> task, size_t copies)
+        {
+            {
+                hsLockGuard(fMutex);
+                for (size_t i = 0; i < copies; ++i)
+                    fTasks.emplace_back(task);
+            }
+            if (copies == 1)
+                fWake.notify_one();
+            else
+                fWake.notify_all();
+        }
+
+        static hsWorkerPool& Instance()
+        {
+            static hsWorkerPool s_instance;
+            return s_instance;
+        }
+    };
+
+    // Shared between the caller and its helpers.  Helpers that only get to run
+    // after the caller has returned find no chunks left and never touch fFn.
+    struct hsParallelJob
+    {
+        const std::function<void(size_t, size_t)>* fFn;
+        size_t                  fCount;
+        size_t                  fChunkSize;
+        size_t                  fNumChunks;
+        std::atomic<size_t>     fNextChunk;
+        std::atomic<size_t>     fChunksDone;
+        std::mutex              fMutex;
+        std::condition_variable fDone;
+
+        void RunChunks()
+        {
+            size_t chunk;
+            while ((chunk = fNextChunk.fetch_add(1)) < fNumChunks) {
+                size_t begin = chunk * fChunkSize;
+                size_t end = std::min(begin + fChunkSize, fCount);
+                (*fFn)(begin, end);
+
+                if (fChunksDone.fetch_add(1) + 1 == fNumChunks) {
+                    hsLockGuard(fMutex);
+                    fDone.notify_all();
+                }
+            }
+        }
+    };
+}
+
+void hsParallelFor(size_t count, size_t minGrain, const std::function<void(size_t, size_t)>& fn)
+{
+    if (count == 0)
+        return;
+
+    minGrain = std::max<size_t>(minGrain, 1);
+    hsWorkerPool& pool = hsWorkerPool::Instance();
+    size_t numThreads = pool.GetNumWorkers() + 1;
+    size_t numChunks = std::min((count + minGrain - 1) / minGrain, numThreads * kChunksPerThread);
+    if (numChunks <= 1 || numThreads == 1) {
+        fn(0, count);
+        return;
+    }
+
+    auto job = std::make_shared<hsParallelJob>();
+    job->fFn = &fn;
+    job->fCount = count;
+    job->fChunkSize = (count + numChunks - 1) / numChunks;
+    job->fNumChunks = (count + job->fChunkSize - 1) / job->fChunkSize;
+    job->fNextChunk = 0;
+    job->fChunksDone = 0;
+
+    pool.Post([job] { job->RunChunks(); }, std::min(job->fNumChunks, numThreads) - 1);
+    job->RunChunks();
+
+    std::unique_lock<std::mutex> lock(job->fMutex);
+    job->fDone.wait(lock, [&job] { return job->fChunksDone == job->fNumChunks; });
+}
+
+size_t hsParallelThreadCount()
+{
+    return hsWorkerPool::Instance().GetNumWorkers() + 1;
+}
@@ -47,12 +47,17 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 #include <cctype>
 #if HS_BUILD_FOR_WIN32
+#   include "hsWindows.h"
 #   include <io.h>
 #endif
 #include <algorithm>
+#include <limits>
 #include <string_theory/format>
 
 #if HS_BUILD_FOR_UNIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #endif
 
@@ -786,6 +791,101 @@ void hsReadOnlyStream::CopyToMem(void* mem)
         memmove(mem, fData, fStop-fData);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////
+
+hsMappedStream::hsMappedStream()
+    : hsReadOnlyStream(0, nullptr)
+#if HS_BUILD_FOR_WIN32
+    , fFileHandle(INVALID_HANDLE_VALUE), fMapHandle()
+#endif
+{ }
+
+hsMappedStream::~hsMappedStream()
+{
+    Close();
+}
+
+bool hsMappedStream::Open(const plFileName& name)
+{
+    hsAssert(fStart == nullptr, "hsMappedStream::Open Stream already opened");
+
+    const void* data = nullptr;
+    uint64_t size = 0;
+
+#if HS_BUILD_FOR_WIN32
+    fFileHandle = CreateFileW(name.WideString().data(), GENERIC_READ, FILE_SHARE_READ,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fFileHandle == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+    if (GetFileSizeEx(fFileHandle, &fileSize) && fileSize.QuadPart > 0)
+        size = fileSize.QuadPart;
+
+    if (size > 0 && size <= std::numeric_limits<uint32_t>::max()) {
+        fMapHandle = CreateFileMappingW(fFileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (fMapHandle)
+            data = MapViewOfFile(fMapHandle, FILE_MAP_READ, 0, 0, 0);
+    }
+#else
+    int fd = open(name.AsString().c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
+        size = info.st_size;
+
+    if (size > 0 && size <= std::numeric_limits<uint32_t>::max()) {
+        void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED)
+            data = map;
+    }
+
+    // The mapping holds its own reference to the file
+    close(fd);
+#endif
+
+    if (!data) {
+        Close();
+        return false;
+    }
+
+    fStart = fData = static_cast<const char*>(data);
+    fStop = fStart + size;
+    fPosition = 0;
+    return true;
+}
+
+void hsMappedStream::Close()
+{
+#if HS_BUILD_FOR_WIN32
+    if (fStart)
+        UnmapViewOfFile(fStart);
+    if (fMapHandle)
+        CloseHandle(fMapHandle);
+    if (fFileHandle != INVALID_HANDLE_VALUE)
+        CloseHandle(fFileHandle);
+    fMapHandle = nullptr;
+    fFileHandle = INVALID_HANDLE_VALUE;
+#else
+    if (fStart)
+        munmap(const_cast<char*>(fStart), fStop - fStart);
+#endif
+
+    fStart = fData = fStop = nullptr;
+    fPosition = 0;
+}
+
+void hsMappedStream::SetPosition(uint32_t position)
+{
+    if (fStart + position > fStop)
+        hsThrow("SetPosition went past end of stream");
+
+    fData = fStart + position;
+    fPosition = position;
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////////
 
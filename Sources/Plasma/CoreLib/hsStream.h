@@ -274,6 +274,33 @@ public:
     void CopyToMem(void* mem);
 };
 
+// read only stream over a file mapped into memory
+// Reads are plain copies out of the mapping, and GetData() lets callers carve
+// out windows over parts of the file without going through the stream at all.
+class hsMappedStream : public hsReadOnlyStream {
+#if HS_BUILD_FOR_WIN32
+    void*       fFileHandle;
+    void*       fMapHandle;
+#endif
+
+public:
+    hsMappedStream();
+    hsMappedStream(const hsMappedStream& other) = delete;
+    hsMappedStream(hsMappedStream&& other) = delete;
+    ~hsMappedStream();
+
+    const hsMappedStream& operator=(const hsMappedStream& other) = delete;
+    hsMappedStream& operator=(hsMappedStream&& other) = delete;
+
+    bool  Open(const plFileName& name);
+    void  Close();
+
+    void  SetPosition(uint32_t position) override;
+
+    // Pointer to the first byte of the mapped file, or nullptr if not open.
+    const uint8_t* GetData() const { return reinterpret_cast<const uint8_t*>(fStart); }
+};
+
 // write only mem stream
 class hsWriteOnlyStream : public hsStream {
 protected:
@@ -62,6 +62,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "pfConsoleCommandUtilities.h"
 #include "pfDispatchLog.h"
 
+#include "pnDispatch/plDispatchStats.h"
 #include "pnFactory/plFactory.h"
 #include "pnInputCore/plKeyMap.h"
 #include "pnKeyedObject/plFixedKey.h"
@@ -134,6 +135,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "plParticleSystem/plParticleGenerator.h"
 #include "plParticleSystem/plParticleSystem.h"
 #include "plPhysX/plPXPhysicalControllerCore.h"
+#include "plPhysX/plPXSimulation.h"
 #include "plPhysX/plSimulationMgr.h"
 #include "plPhysical/plPhysicalSDLModifier.h"
 #include "plPipeline/plDebugText.h"
@@ -2435,6 +2437,44 @@ PF_CONSOLE_CMD( Dispatch_Log,       // groupName
     plDispatchLog::GetInstance()->SetFlags(plDispatchLog::GetInstance()->GetFlags() & ~plDispatchLog::kInclude);
 }
 
+PF_CONSOLE_SUBGROUP( Dispatch, Stats )
+
+PF_CONSOLE_CMD( Dispatch_Stats,
+               Enable,
+               "bool on",
+               "Records per message class counts, receive times, fan-out and queue wait. "
+               "Totals also show up in the 'Dispatch Time' and 'Dispatch Receives' stat groups." )
+{
+    bool on = (bool)params[0];
+    plDispatchStats::SetEnabled(on);
+    PrintString(ST::format("Dispatch stats {}", on ? "enabled" : "disabled"));
+}
+
+PF_CONSOLE_CMD( Dispatch_Stats,
+               Reset,
+               "",
+               "Clears the recorded dispatch stats" )
+{
+    plDispatchStats::Reset();
+}
+
+PF_CONSOLE_CMD( Dispatch_Stats,
+               DumpCSV,
+               "...",
+               "Writes the recorded dispatch stats to a CSV file (defaults to Dispatch.csv in the profile folder)" )
+{
+    plFileName fileName;
+    if (numParams > 0)
+        fileName = static_cast<const ST::string&>(params[0]);
+    else
+        fileName = plFileName::Join(plProfileManagerFull::Instance().GetProfilePath(), "Dispatch.csv");
+
+    if (plDispatchStats::DumpCSV(fileName))
+        PrintString(ST::format("Dispatch stats written to {}", fileName));
+    else
+        PrintString(ST::format("ERROR: Could not write {}", fileName));
+}
+
 #endif // LIMIT_CONSOLE_COMMANDS
 
 //////////////////////////////////////////////////////////////////////////////
@@ -2489,6 +2529,20 @@ PF_CONSOLE_CMD( Registry, SetLoggingLevel, "int level", "Sets the logging level
     }
 }
 
+PF_CONSOLE_CMD( Registry, MemoryMapPages, "bool map", "Sets whether page files are memory mapped instead of read through a buffered stream." )
+{
+    bool map = params[ 0 ];
+    plResMgrSettings::Get().SetMemoryMapPages( map );
+    PrintString(ST::format("Page memory mapping {}", map ? "enabled" : "disabled"));
+}
+
+PF_CONSOLE_CMD( Registry, PreloadPages, "bool preload", "Sets whether queued rooms are read into memory on a background thread before they are paged in." )
+{
+    bool preload = params[ 0 ];
+    plResMgrSettings::Get().SetPreloadPages( preload );
+    PrintString(ST::format("Page preloading {}", preload ? "enabled" : "disabled"));
+}
+
 class pfConsoleActiveRefPeeker
 {
     public:
@@ -5066,6 +5120,16 @@ PF_CONSOLE_CMD(Physics,
     plSimulationMgr::GetInstance()->ResetKickables();
 }
 
+PF_CONSOLE_CMD(Physics,
+               ParallelSubworlds,
+               "bool enable",
+               "Step independent physics subworlds concurrently")
+{
+    bool enable = params[0];
+    plSimulationMgr::GetInstance()->GetPhysX()->SetParallelSubworlds(enable);
+    PrintString(enable ? "Stepping subworlds concurrently" : "Stepping subworlds one at a time");
+}
+
 #endif // LIMIT_CONSOLE_COMMANDS
 
 
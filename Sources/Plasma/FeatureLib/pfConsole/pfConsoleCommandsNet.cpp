@@ -56,6 +56,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "pfConsole.h"
 #include "pfConsoleCommandUtilities.h"
 
+#include "pnAsyncCore/pnAsyncCore.h"
 #include "pnKeyedObject/plFixedKey.h"
 #include "pnKeyedObject/plKey.h"
 #include "pnKeyedObject/plKeyImp.h"
@@ -190,6 +191,34 @@ PF_CONSOLE_CMD( Net,        // groupName
 
 #endif
 
+// Net.IoThreads
+PF_CONSOLE_CMD( Net,
+                IoThreads,
+                "int threads",
+                "Set the number of network IO threads (0 = automatic). Only takes effect from general.ini" )
+{
+    AsyncCoreSetIoThreadCount((int)params[0]);
+}
+
+#ifndef LIMIT_CONSOLE_COMMANDS
+// Net.IoStats
+PF_CONSOLE_CMD( Net,
+                IoStats,
+                "",
+                "Print network IO handler counters" )
+{
+    long handlers = AsyncPerfGetCounter(kAsyncPerfSocketHandlersTotal);
+    long totalUs = AsyncPerfGetCounter(kAsyncPerfSocketHandlerTimeUsTotal);
+    PrintString(ST::format("Handlers queued: {}, run: {}",
+                           AsyncPerfGetCounter(kAsyncPerfSocketHandlersQueued), handlers));
+    PrintString(ST::format("Handler time: avg {}us, max {}us",
+                           handlers ? totalUs / handlers : 0,
+                           AsyncPerfGetCounter(kAsyncPerfSocketHandlerTimeUsMax)));
+    PrintString(ST::format("Bytes in flight: {}",
+                           AsyncPerfGetCounter(kAsyncPerfSocketBytesInFlight)));
+}
+#endif
+
 
 #ifndef LIMIT_CONSOLE_COMMANDS
 
@@ -75,7 +75,6 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "plProfile.h"
 #include "plQuality.h"
 #include "hsResMgr.h"
-#include "hsSIMD.h"
 #include "hsTimer.h"
 #include "plTweak.h"
 
@@ -87,6 +86,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "plPipeline/hsG3DDeviceSelector.h"
 #include "plPipeline/plFogEnvironment.h"
 #include "plPipeline/plRenderTarget.h"
+#include "plPipeline/plSoftwareSkin.h"
 #include "plPipeline/plStatusLogDrawer.h"
 #include "plPipeline/hsWinRef.h"
 
@@ -8557,9 +8557,12 @@ bool      plDXPipeline::ISoftwareVertexBlend(plDrawableSpans* drawable, const st
     }
 
     // Now go through each of the group/buffer (= a real vertex buffer) pairs we found,
-    // and blend into it. We'll lock the buffer once, and then for each span that
-    // uses it, set the matrix palette and and then do the blend for that span.
-    // When we've done all the spans for a group/buffer, we unlock it and move on.
+    // and gather up the spans that blend into it. We'll lock the buffer once, and then
+    // for each span that uses it, set the matrix palette and queue the blend for that span.
+    // The blends themselves all run together at the end, spread across worker threads.
+    static std::vector<plSoftwareSkin::Span> skinSpans;
+    skinSpans.clear();
+
     for (size_t i = 0; i < kMaxBufferGroups; i++)
     {
         for (size_t j = 0; j < kMaxVertexBuffers; j++)
@@ -8583,17 +8586,16 @@ bool      plDXPipeline::ISoftwareVertexBlend(plDrawableSpans* drawable, const st
                         hsMatrix44* matrixPalette = drawable->GetMatrixPalette(span.fBaseMatrix);
                         matrixPalette[0] = span.fLocalToWorld;
 
-                        uint8_t* ptr = vRef->fOwner->GetVertBufferData(vRef->fIndex);
-                        ptr += span.fVStartIdx * vRef->fOwner->GetVertexSize();
-                        IBlendVertsIntoBuffer( (plSpan*)&span,
-                                                matrixPalette, span.fNumMatrices,
-                                                ptr, 
-                                                vRef->fOwner->GetVertexFormat(), 
-                                                vRef->fOwner->GetVertexSize(), 
-                                                destPtr + span.fVStartIdx * vRef->fVertexSize, 
-                                                vRef->fVertexSize, 
-                                                span.fVLength,
-                                                span.fLocalUVWChans );
+                        // Dropped support for localUVWChans at templatization of code
+                        hsAssert(span.fLocalUVWChans == 0, "support for skinned UVWs dropped. reimplement me?");
+
+                        plSoftwareSkin::Span& skin = skinSpans.emplace_back();
+                        skin.fLocalToWorld = span.fLocalToWorld;
+                        skin.fPalette = matrixPalette;
+                        skin.fSrc = vRef->fOwner->GetVertBufferData(vRef->fIndex) + span.fVStartIdx * vRef->fOwner->GetVertexSize();
+                        skin.fDest = destPtr + span.fVStartIdx * vRef->fVertexSize;
+                        skin.fCount = span.fVLength;
+                        skin.fFormat = vRef->fOwner->GetVertexFormat();
                         vRef->SetDirty(true);
                     }
                 }
@@ -8602,6 +8604,8 @@ bool      plDXPipeline::ISoftwareVertexBlend(plDrawableSpans* drawable, const st
         }
     }
 
+    plSoftwareSkin::BlendSpans(skinSpans);
+
     plProfile_EndTiming(Skin);
 
     if( drawable->GetBlendingSpanVector().Empty() )
@@ -8733,166 +8737,6 @@ inline void inlTESTPOINT(const hsPoint3& destP,
         maxZ = destP.fZ;
 }
 
-//// IBlendVertsIntoBuffer ////////////////////////////////////////////////////
-//  Given a pointer into a buffer of verts that have blending data in the D3D
-//  format, blends them into the destination buffer given without the blending
-//  info.
-
-#define SPLIT_SKIN_BUFFER(src, pt, vec) \
-    decltype(src) pt = &src[0];         \
-    decltype(src) vec = &src[4];        //
-
-#define SPLIT_SKIN_TRIPLES(src, pt, vec)                    \
-    hsPoint3* pt = reinterpret_cast<hsPoint3*>(&src[0]);    \
-    hsVector3* vec = reinterpret_cast<hsVector3*>(&src[4]); //
-
-static inline void ISkinVertexFPU(const hsMatrix44& xfm, float wgt,
-                                  const float* srcBuf, float* dstBuf)
-{
-    const float& m00 = xfm.fMap[0][0];
-    const float& m01 = xfm.fMap[0][1];
-    const float& m02 = xfm.fMap[0][2];
-    const float& m03 = xfm.fMap[0][3];
-    const float& m10 = xfm.fMap[1][0];
-    const float& m11 = xfm.fMap[1][1];
-    const float& m12 = xfm.fMap[1][2];
-    const float& m13 = xfm.fMap[1][3];
-    const float& m20 = xfm.fMap[2][0];
-    const float& m21 = xfm.fMap[2][1];
-    const float& m22 = xfm.fMap[2][2];
-    const float& m23 = xfm.fMap[2][3];
-
-    SPLIT_SKIN_BUFFER(srcBuf, pt_src, vec_src);
-    SPLIT_SKIN_BUFFER(dstBuf, pt_dst, vec_dst);
-
-    // position
-    {
-        const float& srcX = pt_src[0];
-        const float& srcY = pt_src[1];
-        const float& srcZ = pt_src[2];
-
-        pt_dst[0] += (srcX * m00 + srcY * m01 + srcZ * m02 + m03) * wgt;
-        pt_dst[1] += (srcX * m10 + srcY * m11 + srcZ * m12 + m13) * wgt;
-        pt_dst[2] += (srcX * m20 + srcY * m21 + srcZ * m22 + m23) * wgt;
-    }
-
-    // normal
-    {
-        const float& srcX = vec_src[0];
-        const float& srcY = vec_src[1];
-        const float& srcZ = vec_src[2];
-
-        vec_dst[0] += (srcX * m00 + srcY * m01 + srcZ * m02) * wgt;
-        vec_dst[1] += (srcX * m10 + srcY * m11 + srcZ * m12) * wgt;
-        vec_dst[2] += (srcX * m20 + srcY * m21 + srcZ * m22) * wgt;
-    }
-}
-
-#ifdef HAVE_SSE3
-static inline void ISkinDpSSE3(const float* src, float* dst, const __m128& mc0,
-                               const __m128& mc1, const __m128& mc2, const __m128& mwt)
-{
-    __m128 msr = _mm_load_ps(src);
-    __m128 _x  = _mm_mul_ps(_mm_mul_ps(mc0, msr), mwt);
-    __m128 _y  = _mm_mul_ps(_mm_mul_ps(mc1, msr), mwt);
-    __m128 _z  = _mm_mul_ps(_mm_mul_ps(mc2, msr), mwt);
-
-    __m128 hbuf1 = _mm_hadd_ps(_x, _y);
-    __m128 hbuf2 = _mm_hadd_ps(_z, _z);
-    hbuf1 = _mm_hadd_ps(hbuf1, hbuf2);
-    __m128 _dst = _mm_load_ps(dst);
-    _dst = _mm_add_ps(_dst, hbuf1);
-    _mm_store_ps(dst, _dst);
-}
-#endif // HAVE_SSE3
-
-static inline void ISkinVertexSSE3(const hsMatrix44& xfm, float wgt,
-                                   const float* srcBuf, float* dstBuf)
-{
-#ifdef HAVE_SSE3
-    __m128 mc0 = _mm_load_ps(xfm.fMap[0]);
-    __m128 mc1 = _mm_load_ps(xfm.fMap[1]);
-    __m128 mc2 = _mm_load_ps(xfm.fMap[2]);
-    __m128 mwt = _mm_set_ps1(wgt);
-
-    SPLIT_SKIN_BUFFER(srcBuf, pt_src, vec_src);
-    SPLIT_SKIN_BUFFER(dstBuf, pt_dst, vec_dst);
-
-    ISkinDpSSE3(pt_src, pt_dst, mc0, mc1, mc2, mwt);
-    ISkinDpSSE3(vec_src, vec_dst, mc0, mc1, mc2, mwt);
-#endif // HAVE_SSE3
-}
-
-typedef void(*skin_vert_ptr)(const hsMatrix44&, float, const float*, float*);
-
-template<skin_vert_ptr T>
-static void IBlendVertBuffer(plSpan* span, hsMatrix44* matrixPalette, int numMatrices,
-                             const uint8_t* src, uint8_t format, uint32_t srcStride,
-                             uint8_t* dest, uint32_t destStride, uint32_t count,
-                             uint16_t localUVWChans)
-{
-    alignas(32) float srcBuf[8]{};
-    SPLIT_SKIN_TRIPLES(srcBuf, srcPt, srcVec);
-
-    uint32_t indices;
-    float weights[4];
-
-    // Dropped support for localUVWChans at templatization of code
-    hsAssert(localUVWChans == 0, "support for skinned UVWs dropped. reimplement me?");
-    const size_t uvChanSize = plGBufferGroup::CalcNumUVs(format) * sizeof(float) * 3;
-    uint8_t numWeights = (format & plGBufferGroup::kSkinWeightMask) >> 4;
-
-    for (uint32_t i = 0; i < count; ++i) {
-        // Extract data
-        src = inlExtract<hsPoint3>(src, srcPt);
-
-        float weightSum = 0.f;
-        for (uint8_t j = 0; j < numWeights; ++j) {
-            src = inlExtract<float>(src, &weights[j]);
-            weightSum += weights[j];
-        }
-        weights[numWeights] = 1.f - weightSum;
-
-        if (format & plGBufferGroup::kSkinIndices)
-            src = inlExtract<uint32_t>(src, &indices);
-        else
-            indices = 1 << 8;
-        src = inlExtract<hsVector3>(src, srcVec);
-
-        // Destination buffers (float4 for SSE alignment)
-        alignas(32) float destBuf[8]{};
-        SPLIT_SKIN_TRIPLES(destBuf, destPt, destVec);
-
-        // Blend
-        for (uint32_t j = 0; j < numWeights + 1; ++j) {
-            if (weights[j])
-                T(matrixPalette[indices & 0xFF], weights[j], srcBuf, destBuf);
-            indices >>= 8;
-        }
-        // Probably don't really need to renormalize this. There errors are
-        // going to be subtle and "smooth".
-        /* hsFastMath::NormalizeAppr(destNorm); */
-
-        // Slam data into position now
-        dest = inlStuff<hsPoint3>(dest, reinterpret_cast<hsPoint3*>(destPt));
-        dest = inlStuff<hsVector3>(dest, reinterpret_cast<hsVector3*>(destVec));
-
-        // memcpy the colors and UVs
-        inlCopy(src, dest, sizeof(uint32_t) * 2 + uvChanSize);
-    }
-}
-
-// CPU-optimized functions requiring dispatch
-hsCpuFunctionDispatcher<plDXPipeline::blend_vert_buffer_ptr> plDXPipeline::blend_vert_buffer {
-    &IBlendVertBuffer<ISkinVertexFPU>,
-    nullptr,                                // SSE1
-    nullptr,                                // SSE2
-    &IBlendVertBuffer<ISkinVertexSSE3>
-};
-
-#undef SPLIT_SKIN_TRIPLES
-#undef SPLIT_SKIN_BUFFER
-
 // ISetPipeConsts //////////////////////////////////////////////////////////////////
 // A shader can request that the pipeline fill in certain constants that are indeterminate
 // until the pipeline is about to render the object the shader is applied to. For example,
@@ -11957,6 +11801,9 @@ void plDXPipeline::IPreprocessAvatarTextures()
     fLayerState[1].fBlendFlags = uint32_t(-1);
     inlEnsureLightingOff();
 
+    IPrioritizeClothingOutfits();
+    uint32_t numRebuilt = 0;
+
     for (plClothingOutfit* co : fClothingOutfits)
     {
         if (co->fBase == nullptr || co->fBase->fBaseTexture == nullptr)
@@ -11969,6 +11816,10 @@ void plDXPipeline::IPreprocessAvatarTextures()
             continue;
         }
 
+        // Anyone past our budget stays dirty and gets picked up next frame
+        if (numRebuilt++ >= kAvTexMaxRebuildsPerFrame)
+            break;
+
         if (rt == nullptr)
         {
             rt = IGetNextAvRT();
@@ -402,11 +402,6 @@ protected:
     void            IMakeOcclusionSnap();
 
     bool            IAvatarSort(plDrawableSpans* d, const std::vector<int16_t>& visList);
-    void            IBlendVertsIntoBuffer( plSpan* span, 
-                                            hsMatrix44* matrixPalette, int numMatrices,
-                                            const uint8_t *src, uint8_t format, uint32_t srcStride, 
-                                            uint8_t *dest, uint32_t destStride, uint32_t count, uint16_t localUVWChans )
-                                                { blend_vert_buffer.call(span, matrixPalette, numMatrices, src, format, srcStride, dest, destStride, count, localUVWChans); };
     bool            ISoftwareVertexBlend(plDrawableSpans* drawable, const std::vector<int16_t>& visList);
 
 
@@ -607,13 +602,6 @@ public:
 
     void RenderSpans(plDrawableSpans *ice, const std::vector<int16_t>& visList) override;
 
-    //  CPU-optimized functions
-protected:
-    typedef void(*blend_vert_buffer_ptr)(plSpan*, hsMatrix44*, int, const uint8_t *,
-                                         uint8_t , uint32_t, uint8_t *, uint32_t,
-                                         uint32_t, uint16_t);
-    static hsCpuFunctionDispatcher<blend_vert_buffer_ptr> blend_vert_buffer;
-
 private:
     static plDXEnumerate enumerator;
 };
@@ -50,6 +50,8 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 #include "pfJournalBook.h"
 
+#include <algorithm>
+#include <cstring>
 #include <cwchar>
 
 #include "HeadSpin.h"
@@ -152,6 +154,11 @@ class pfEsHTMLChunk
         bool    fOnCover; // if true, the movie is on the cover
         uint8_t   fMovieIndex; // the index of the movie in the source code, used for identification
 
+        // Last resized copy of our image (for fNoResizeImg), so we don't
+        // resample the source mipmap every time the page is drawn
+        hsRef<plMipmap> fResizedImg;
+        plMipmap*       fResizedSrc = nullptr;
+
         enum Flags
         {
             kFontBold   = 0x00000001,
@@ -1246,6 +1253,7 @@ pfJournalBook::pfJournalBook(ST::string esHTMLSource, plKey coverImageKey, plKey
     fTintCover = false;
     fAreEditing = false;
     fWantEditing = false;
+    fRenderedPageClock = 0;
     fDefLoc = hintLoc;
     fUncompiledSource = std::move(esHTMLSource);
 
@@ -1815,6 +1823,7 @@ void    pfJournalBook::IHandleCheckClick( uint32_t idx, pfBookData::WhichSide wh
     // Special processing for checkboxes--toggle our state, switch our opacity
     // and then send a notify about our new state
     bool check = !fVisibleLinks[idx].IsChecked();
+    IClearRenderedPages();
     if( check )
     {
         fVisibleLinks[ idx ].SetChecked(true);
@@ -2440,6 +2449,8 @@ bool    pfJournalBook::IGetNextOption( const char *&string, const char *end, ST:
 
 void    pfJournalBook::IFreeSource()
 {
+    IClearRenderedPages();
+
     for (pfEsHTMLChunk* chunk : fHTMLSource)
         delete chunk;
     fHTMLSource.clear();
@@ -2536,12 +2547,6 @@ void    pfJournalBook::IRenderPage( uint32_t page, uint32_t whichDTMap, bool sup
     // Make sure our page starts are up-to-snuff, at least to this point
     IRecalcPageStarts( page );
 
-    // Render!
-    hsColorRGBA color;
-    color.Set( 0, 0, 0, 0 );
-    if( !suppressRendering )
-        dtMap->ClearToColor( color );
-
     hsGMaterial *material = nullptr;
     if (whichDTMap == pfJournalDlgProc::kTagLeftDTMap)
         material = fBookGUIs[fCurBookGUI]->PageMaterial(pfBookData::kLeftPage);
@@ -2567,6 +2572,16 @@ void    pfJournalBook::IRenderPage( uint32_t page, uint32_t whichDTMap, bool sup
         }
     }
 
+    // Drawn this one before? Then just copy it back
+    if (!suppressRendering && IRestoreRenderedPage(page, whichDTMap, dtMap))
+        return;
+
+    // Render!
+    hsColorRGBA color;
+    color.Set( 0, 0, 0, 0 );
+    if( !suppressRendering )
+        dtMap->ClearToColor( color );
+
     hsAssert(page < fPageStarts.size() || page > fLastPage, "UnInitialized page start!");
     if (page <= fLastPage
         && page < fPageStarts.size())   // Added this as a crash-prevention bandaid - MT
@@ -2579,6 +2594,8 @@ void    pfJournalBook::IRenderPage( uint32_t page, uint32_t whichDTMap, bool sup
         hsColorRGBA fontColor;
         int16_t     fontSpacing;
         bool        needSFX = false;
+        bool        canCache = !suppressRendering;
+        size_t      firstLink = fVisibleLinks.size();
 
         // Find the current text link
         pfEsHTMLChunk* currLinkChunk = IFindTextLink(fPageStarts[page]);
@@ -2708,6 +2725,7 @@ void    pfJournalBook::IRenderPage( uint32_t page, uint32_t whichDTMap, bool sup
                         // Invalidate our cache starting with the next page
                         if (fPageStarts.size() > page + 1)
                             fPageStarts.resize(page + 1);
+                        IClearRenderedPages();
 
                         y += 512;
                         break;
@@ -2727,7 +2745,9 @@ void    pfJournalBook::IRenderPage( uint32_t page, uint32_t whichDTMap, bool sup
                 case pfEsHTMLChunk::kImage:
                     {
                         plMipmap *mip = plMipmap::ConvertNoRef(chunk->fImageKey != nullptr ? chunk->fImageKey->ObjectIsLoaded() : nullptr);
-                        if (mip != nullptr)
+                        if (mip == nullptr)
+                            canCache = false;   // Still loading, so we'll want to draw it again later
+                        else
                         {
                             // First, determine if we need to be processing FX messages
                             if( chunk->fFlags & pfEsHTMLChunk::kGlowing )
@@ -2805,6 +2825,7 @@ void    pfJournalBook::IRenderPage( uint32_t page, uint32_t whichDTMap, bool sup
                     break;
 
                 case pfEsHTMLChunk::kMovie: {
+                    canCache = false;   // Movie layers get re-added to the material on every render
                     movieAlreadyLoaded = (IMovieAlreadyLoaded(chunk) != nullptr); // have we already cached it?
                     plLayerAVI *movieLayer = IMakeMovieLayer(chunk, x, y, (plMipmap*)dtMap, whichDTMap, suppressRendering);
                     if (movieLayer)
@@ -2870,12 +2891,80 @@ void    pfJournalBook::IRenderPage( uint32_t page, uint32_t whichDTMap, bool sup
             fBookGUIs[fCurBookGUI]->RegisterForSFX( (pfBookData::WhichSide)( fBookGUIs[fCurBookGUI]->CurSFXPages() | thisWhich ) );
         else
             fBookGUIs[fCurBookGUI]->RegisterForSFX( (pfBookData::WhichSide)( fBookGUIs[fCurBookGUI]->CurSFXPages() & ~thisWhich ) );
+
+        if (canCache && !needSFX)
+            ISaveRenderedPage(page, whichDTMap, dtMap, firstLink);
     }
 
     if( !suppressRendering )
         dtMap->FlushToHost();
 }
 
+//// IRestoreRenderedPage ////////////////////////////////////////////////////
+//  If we have a still-valid copy of this page for this DTMap, copies it back
+//  into the DTMap along with its links, and does the same end-of-render
+//  bookkeeping IRenderPage would have.
+
+bool    pfJournalBook::IRestoreRenderedPage( uint32_t page, uint32_t whichDTMap, plDynamicTextMap *dtMap )
+{
+    auto it = fRenderedPages.find(std::make_pair(page, whichDTMap));
+    if (it == fRenderedPages.end())
+        return false;
+
+    pfRenderedPage& cached = it->second;
+    size_t imageSize = dtMap->IsValid() ? dtMap->GetHeight() * dtMap->GetRowBytes() : 0;
+    if (page > fLastPage || page + 1 >= fPageStarts.size()
+        || fPageStarts[page] != cached.fStart || fPageStarts[page + 1] != cached.fEnd
+        || dtMap->GetWidth() != cached.fWidth || dtMap->GetHeight() != cached.fHeight
+        || cached.fShowLinkRects != s_ShowLinkRects || cached.fPixels.size() != imageSize)
+    {
+        fRenderedPages.erase(it);
+        return false;
+    }
+
+    memcpy(dtMap->GetImage(), cached.fPixels.data(), imageSize);
+    fVisibleLinks.insert(fVisibleLinks.end(), cached.fLinks.begin(), cached.fLinks.end());
+    cached.fLastUsed = ++fRenderedPageClock;
+
+    pfBookData::WhichSide thisWhich = ( whichDTMap == pfJournalDlgProc::kTagRightDTMap ) ? pfBookData::kRightSide : ( whichDTMap == pfJournalDlgProc::kTagLeftDTMap )  ? pfBookData::kLeftSide : pfBookData::kNoSides;
+    fBookGUIs[fCurBookGUI]->RegisterForSFX( (pfBookData::WhichSide)( fBookGUIs[fCurBookGUI]->CurSFXPages() & ~thisWhich ) );
+
+    dtMap->FlushToHost();
+    return true;
+}
+
+//// ISaveRenderedPage ///////////////////////////////////////////////////////
+//  Stores a copy of the page just rendered, evicting the least recently used
+//  page if we're full.
+
+void    pfJournalBook::ISaveRenderedPage( uint32_t page, uint32_t whichDTMap, plDynamicTextMap *dtMap, size_t firstLink )
+{
+    static constexpr size_t kMaxRenderedPages = 8;
+
+    if (!dtMap->IsValid() || page + 1 >= fPageStarts.size())
+        return;
+
+    auto key = std::make_pair(page, whichDTMap);
+    if (fRenderedPages.size() >= kMaxRenderedPages && fRenderedPages.find(key) == fRenderedPages.end())
+    {
+        auto oldest = std::min_element(fRenderedPages.begin(), fRenderedPages.end(),
+            [](const auto& a, const auto& b) { return a.second.fLastUsed < b.second.fLastUsed; });
+        fRenderedPages.erase(oldest);
+    }
+
+    pfRenderedPage& cached = fRenderedPages[key];
+    cached.fStart = fPageStarts[page];
+    cached.fEnd = fPageStarts[page + 1];
+    cached.fWidth = (uint16_t)dtMap->GetWidth();
+    cached.fHeight = (uint16_t)dtMap->GetHeight();
+    cached.fShowLinkRects = s_ShowLinkRects;
+    cached.fLastUsed = ++fRenderedPageClock;
+
+    const uint8_t* image = (const uint8_t*)dtMap->GetImage();
+    cached.fPixels.assign(image, image + dtMap->GetHeight() * dtMap->GetRowBytes());
+    cached.fLinks.assign(fVisibleLinks.begin() + firstLink, fVisibleLinks.end());
+}
+
 //// IMoveMovies /////////////////////////////////////////////////////////////
 
 void    pfJournalBook::IMoveMovies( hsGMaterial *source, hsGMaterial *dest )
@@ -2916,8 +3005,9 @@ void    pfJournalBook::IMoveMovies( hsGMaterial *source, hsGMaterial *dest )
 
 void    pfJournalBook::IDrawMipmap( pfEsHTMLChunk *chunk, uint16_t x, uint16_t y, plMipmap *mip, plDynamicTextMap *dtMap, uint32_t whichDTMap, bool dontRender )
 {
-    hsRef<plMipmap> copy(new plMipmap(), hsStealRef);
-    copy->CopyFrom(mip);
+    // Composite() only reads from the source, so we can use the image as-is
+    // unless it needs resizing
+    plMipmap* image = mip;
     if (chunk->fNoResizeImg)
     {
         // book is NOT square, there is a h/w ratio of 1/0.7
@@ -2967,8 +3057,16 @@ void    pfJournalBook::IDrawMipmap( pfEsHTMLChunk *chunk, uint16_t x, uint16_t y
                 x -= xShift;
         }
         
-        copy->SetCurrLevel(0); // resize the image so it will look unchanged when rendered on the altered book
-        copy->ResizeNicely((uint16_t)width,(uint16_t)height,plMipmap::kDefaultFilter);
+        hsRef<plMipmap>& copy = chunk->fResizedImg;
+        if (!copy || chunk->fResizedSrc != mip || copy->GetWidth() != width || copy->GetHeight() != height)
+        {
+            copy.Steal(new plMipmap());
+            copy->CopyFrom(mip);
+            copy->SetCurrLevel(0); // resize the image so it will look unchanged when rendered on the altered book
+            copy->ResizeNicely((uint16_t)width,(uint16_t)height,plMipmap::kDefaultFilter);
+            chunk->fResizedSrc = mip;
+        }
+        image = copy.Get();
     }
     if( !dontRender )
     {
@@ -2991,7 +3089,7 @@ void    pfJournalBook::IDrawMipmap( pfEsHTMLChunk *chunk, uint16_t x, uint16_t y
                 opts.fFlags = ( chunk->fFlags & pfEsHTMLChunk::kBlendAlpha ) ? plMipmap::kCopySrcAlpha : plMipmap::kForceOpaque;
             opts.fOpacity = (uint8_t)(chunk->fCurrOpacity * 255.f);
         }
-        dtMap->Composite(copy.Get(), x, y, &opts);
+        dtMap->Composite(image, x, y, &opts);
     }
 
     if( chunk->fFlags & pfEsHTMLChunk::kCanLink )
@@ -3004,9 +3102,9 @@ void    pfJournalBook::IDrawMipmap( pfEsHTMLChunk *chunk, uint16_t x, uint16_t y
         if (dontRender) {
             fVisibleLinks.emplace_back(chunk, 0, 0, 0, 0);
         } else {
-            fVisibleLinks.emplace_back(chunk, x + xOffs, y, (int16_t)(copy->GetWidth()), (int16_t)(copy->GetHeight()));
+            fVisibleLinks.emplace_back(chunk, x + xOffs, y, (int16_t)(image->GetWidth()), (int16_t)(image->GetHeight()));
             if (s_ShowLinkRects)
-                dtMap->FrameRect(x, y, (int16_t)(copy->GetWidth()), (int16_t)(copy->GetHeight()), s_LinkRectColor);
+                dtMap->FrameRect(x, y, (int16_t)(image->GetWidth()), (int16_t)(image->GetHeight()), s_LinkRectColor);
         }
     }
 }
@@ -3523,6 +3621,7 @@ void    pfJournalBook::SetBookSize( float width, float height )
 {
     fWidthScale = 1.f - width;
     fHeightScale = 1.f - height;
+    IClearRenderedPages();
 
     if( fBookGUIs[fCurBookGUI]->CurBook() == this )
         fBookGUIs[fCurBookGUI]->SetCurrSize( fWidthScale, fHeightScale );
@@ -3533,6 +3632,10 @@ void    pfJournalBook::SetBookSize( float width, float height )
 
 void    pfJournalBook::ILoadAllImages( bool unload )
 {
+    // Pages drawn while images were (un)loading aren't cached, but drop
+    // everything anyway in case the images come back different
+    IClearRenderedPages();
+
     // load the cover
     if (fCoverFromHTML && fCoverMipKey != nullptr)
     {
@@ -3549,6 +3652,8 @@ void    pfJournalBook::ILoadAllImages( bool unload )
     {
         if (chunk->fType == pfEsHTMLChunk::kImage && chunk->fImageKey != nullptr)
         {
+            chunk->fResizedImg = nullptr;
+            chunk->fResizedSrc = nullptr;
             if( unload )
                 fBookGUIs[fCurBookGUI]->GetKey()->Release(chunk->fImageKey);
             else
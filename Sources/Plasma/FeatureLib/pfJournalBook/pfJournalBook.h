@@ -463,7 +463,7 @@ class pfJournalBook : public hsKeyedObject
         uint32_t  GetCurrentPage() const { return fCurrentPage; }
 
         // Set the margin (defaults to 16 pixels)
-        void    SetPageMargin( uint32_t margin ) { fPageTMargin = fPageLMargin = fPageBMargin = fPageRMargin = margin; }
+        void    SetPageMargin( uint32_t margin ) { fPageTMargin = fPageLMargin = fPageBMargin = fPageRMargin = margin; IClearRenderedPages(); }
 
         // Turns on or off page turning
         void    AllowPageTurning( bool allow ) { fAllowTurning = allow; }
@@ -539,6 +539,22 @@ class pfJournalBook : public hsKeyedObject
         // Can be images or lines of text.
         std::vector<pfJournalVisibleLink> fVisibleLinks;
 
+        // Pages we've already drawn, keyed on page number and target DTMap, so
+        // flipping back and forth through a book doesn't redraw the same text
+        // and images every time. Only pages that draw the same way every time
+        // are kept (no movies, glowing or fading images, or unloaded images).
+        struct pfRenderedPage
+        {
+            uint32_t    fStart, fEnd;   // Page starts when we drew it
+            uint16_t    fWidth, fHeight;
+            bool        fShowLinkRects;
+            uint32_t    fLastUsed;
+            std::vector<uint8_t>                fPixels;
+            std::vector<pfJournalVisibleLink>   fLinks;
+        };
+        std::map<std::pair<uint32_t, uint32_t>, pfRenderedPage> fRenderedPages;
+        uint32_t fRenderedPageClock;
+
         static std::map<ST::string,pfBookData*> fBookGUIs;
         ST::string fCurBookGUI;
 
@@ -562,6 +578,12 @@ class pfJournalBook : public hsKeyedObject
         // Renders one (1) page into the given DTMap
         void    IRenderPage( uint32_t page, uint32_t whichDTMap, bool suppressRendering = false );
 
+        // Rendered page cache helpers. IRestoreRenderedPage returns true if the page
+        // was copied back into the DTMap and needs no further rendering.
+        bool    IRestoreRenderedPage( uint32_t page, uint32_t whichDTMap, plDynamicTextMap *dtMap );
+        void    ISaveRenderedPage( uint32_t page, uint32_t whichDTMap, plDynamicTextMap *dtMap, size_t firstLink );
+        void    IClearRenderedPages() { fRenderedPages.clear(); }
+
         // moves the movie layers from one material onto another
         void    IMoveMovies( hsGMaterial *source, hsGMaterial *dest);
 
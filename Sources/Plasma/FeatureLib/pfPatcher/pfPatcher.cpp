@@ -41,13 +41,16 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 *==LICENSE==*/
 
 #include <algorithm>
+#include <cstring>
 #include <deque>
+#include <map>
 #include <mutex>
 
 #include "pfPatcher.h"
 
 #include "HeadSpin.h"
 #include "plFileSystem.h"
+#include "hsParallel.h"
 #include "hsStream.h"
 #include "hsThread.h"
 #include "hsTimer.h"
@@ -161,9 +164,26 @@ struct pfPatcherWorker final
         { }
     };
 
+    /** Checksum of a local file, valid as long as its size and mtime don't change */
+    struct HashCacheEntry
+    {
+        uint64_t fFileSize;
+        uint64_t fModifyTime;
+        uint8_t fChecksum[MD5_DIGEST_LENGTH];
+    };
+
+    /** Up to this many file downloads may be in flight at once */
+    static constexpr uint32_t kMaxConcurrentDownloads = 4;
+
+    static constexpr uint32_t kHashCacheVersion = 2;
+
     std::deque<Request> fRequests;
     std::deque<pfPatcherQueuedFile> fQueuedFiles;
 
+    plFileName fHashCacheFile;
+    std::map<ST::string, HashCacheEntry> fHashCache;
+    bool fHashCacheDirty;
+
     std::recursive_mutex fRequestMut;
     std::mutex fFileMut;
     hsSemaphore fFileSignal;
@@ -180,6 +200,8 @@ struct pfPatcherWorker final
 
     volatile bool fStarted;
     volatile bool fRequestActive;
+    uint32_t fActiveRequests;
+    bool fExclusiveRequest;
     volatile bool fWantPython;
     volatile bool fWantSDL;
 
@@ -198,8 +220,15 @@ struct pfPatcherWorker final
 
     void EndPatch(ENetError result, const ST::string& msg={});
     bool IssueRequest();
+    void IStartRequest(const Request& req);
+    void IRequestFinished();
     void Run();
-    void IHashFile(pfPatcherQueuedFile& file);
+    bool IWantFile(const pfPatcherQueuedFile& file) const;
+    bool ILocalFileMatches(const plFileName& path, const pfPatcherQueuedFile& file, HashCacheEntry& hashed) const;
+    void IHashFiles(size_t count);
+    void IEnqueueFile(pfPatcherQueuedFile& file);
+    void ILoadHashCache();
+    void ISaveHashCache();
     void IDecompressSound(const pfPatcherQueuedFile& sound) const;
     void ProcessFile();
     void WhitelistFile(const plFileName& file, bool justDownloaded, hsStream* s=nullptr);
@@ -310,6 +339,7 @@ public:
 
 void pfPatcherWorker::IAuthThingDownloadCB(ENetError result, const plFileName& filename, hsStream* writer)
 {
+    IRequestFinished();
     if (IS_NET_SUCCESS(result)) {
         PatcherLogGreen("\tDownloaded Legacy File '{}'", filename);
         IssueRequest();
@@ -327,6 +357,7 @@ void pfPatcherWorker::IAuthThingDownloadCB(ENetError result, const plFileName& f
 
 void pfPatcherWorker::IGotAuthFileList(ENetError result, const std::vector<NetCliAuthFileInfo>& infos)
 {
+    IRequestFinished();
     if (IS_NET_SUCCESS(result)) {
         // so everything goes directly into the Requests deque because AuthSrv lists
         // don't have any hashes attached. WHY did eap think this was a good idea?!?!
@@ -365,6 +396,7 @@ void pfPatcherWorker::IHandleManifestDownload(const ST::string& group, const std
 
 void pfPatcherWorker::IPreloaderManifestDownloadCB(ENetError result, const ST::string& group, const std::vector<NetCliFileManifestEntry>& manifest)
 {
+    IRequestFinished();
     if (IS_NET_SUCCESS(result)) {
         IHandleManifestDownload(group, manifest);
     } else {
@@ -375,6 +407,7 @@ void pfPatcherWorker::IPreloaderManifestDownloadCB(ENetError result, const ST::s
 
 void pfPatcherWorker::IFileManifestDownloadCB(ENetError result, const ST::string& group, const std::vector<NetCliFileManifestEntry>& manifest)
 {
+    IRequestFinished();
     if (IS_NET_SUCCESS(result))
         IHandleManifestDownload(group, manifest);
     else {
@@ -392,6 +425,7 @@ void pfPatcherWorker::IFileThingDownloadCB(ENetError result, const plFileName& f
     // the callback code may crash due to either a permissions error or the
     // zlib decompression not being complete.
     stream->Close();
+    IRequestFinished();
 
     if (IS_NET_SUCCESS(result)) {
         PatcherLogGreen("\tDownloaded File '{}'", stream->GetFileName());
@@ -420,8 +454,8 @@ void pfPatcherWorker::IFileThingDownloadCB(ENetError result, const plFileName& f
 // ===================================================
 
 pfPatcherWorker::pfPatcherWorker() :
-    fStarted(false), fCurrBytes(0), fTotalBytes(0), fRequestActive(true),
-    fWantPython(), fWantSDL()
+    fHashCacheDirty(), fStarted(false), fCurrBytes(0), fTotalBytes(0), fRequestActive(true),
+    fActiveRequests(), fExclusiveRequest(), fWantPython(), fWantSDL()
 { }
 
 pfPatcherWorker::~pfPatcherWorker()
@@ -466,14 +500,33 @@ void pfPatcherWorker::EndPatch(ENetError result, const ST::string& msg)
 bool pfPatcherWorker::IssueRequest()
 {
     hsLockGuard(fRequestMut);
-    if (fRequests.empty()) {
+
+    // File downloads are pipelined, but anything else (manifests, file lists) produces
+    // more work for us, so it gets the connection all to itself.
+    while (fStarted && !fRequests.empty() && !fExclusiveRequest) {
+        bool exclusive = fRequests.front().fType != Request::kFile;
+        if (exclusive ? fActiveRequests != 0 : fActiveRequests >= kMaxConcurrentDownloads)
+            break;
+
+        Request req = std::move(fRequests.front());
+        fRequests.pop_front();
+
+        ++fActiveRequests;
+        fExclusiveRequest = exclusive;
+        fRequestActive = true;
+        IStartRequest(req);
+    }
+
+    if (fActiveRequests == 0) {
         fRequestActive = false;
         fFileSignal.Signal(); // make sure the patch thread doesn't deadlock!
         return false;
-    } else
-        fRequestActive = true;
+    }
+    return true;
+}
 
-    const Request& req = fRequests.front();
+void pfPatcherWorker::IStartRequest(const Request& req)
+{
     switch (req.fType) {
         case Request::kFile:
             req.fStream->Begin();
@@ -518,9 +571,15 @@ bool pfPatcherWorker::IssueRequest()
             break;
         DEFAULT_FATAL(req.fType);
     }
+}
 
-    fRequests.pop_front();
-    return true;
+void pfPatcherWorker::IRequestFinished()
+{
+    hsLockGuard(fRequestMut);
+    hsAssert(fActiveRequests != 0, "finished a request we never started?");
+    fExclusiveRequest = false;
+    if (--fActiveRequests == 0)
+        fFileSignal.Signal(); // in case the patch thread is waiting on us to wrap up
 }
 
 void pfPatcherWorker::Run()
@@ -535,6 +594,7 @@ void pfPatcherWorker::Run()
     // When there are no files in my deque and no requests in my deque, we exit without errors.
     PatcherLogWhite("--- Patch Started ({} requests) ---", fRequests.size());
     fStarted = true;
+    ILoadHashCache();
     IssueRequest();
 
     // Now, work until we're done processing files
@@ -553,35 +613,100 @@ void pfPatcherWorker::Run()
                 break;
     } while (fStarted);
 
+    // If we bailed early, other downloads may still be in flight. Don't go away
+    // until they're done calling back into us.
+    for (;;) {
+        {
+            hsLockGuard(fRequestMut);
+            if (fActiveRequests == 0)
+                break;
+        }
+        fFileSignal.Wait();
+    }
+
+    ISaveHashCache();
     EndPatch(kNetSuccess);
 }
 
-void pfPatcherWorker::IHashFile(pfPatcherQueuedFile& file)
+bool pfPatcherWorker::IWantFile(const pfPatcherQueuedFile& file) const
 {
     // Only accept game code if we want it
     if (!fWantPython && file.fClientPath.GetFileExt().compare_i("pak") == 0) {
         PatcherLogRed("\tDeclined unwanted Python code '{}'", file.fClientPath);
-        return;
+        return false;
     }
     if (!fWantSDL && file.fClientPath.GetFileExt().compare_i("sdl") == 0) {
         PatcherLogRed("\tDeclined unwanted SDL '{}'", file.fClientPath);
-        return;
+        return false;
     }
+    return true;
+}
+
+bool pfPatcherWorker::ILocalFileMatches(const plFileName& path, const pfPatcherQueuedFile& file, HashCacheEntry& hashed) const
+{
+    plFileInfo mine(path);
+    if (mine.FileSize() != file.fFileSize)
+        return false;
+
+    // If the file hasn't been touched since we last hashed it, trust the old hash
+    auto it = fHashCache.find(path.AsString());
+    if (it != fHashCache.end() && it->second.fFileSize == mine.FileSize() && it->second.fModifyTime == mine.ModifyTime())
+        return memcmp(it->second.fChecksum, file.fChecksum.GetValue(), sizeof(it->second.fChecksum)) == 0;
+
+    plMD5Checksum cliMD5(path);
+    if (!cliMD5.IsValid())
+        return false;
+
+    hashed.fFileSize = mine.FileSize();
+    hashed.fModifyTime = mine.ModifyTime();
+    memcpy(hashed.fChecksum, cliMD5.GetValue(), sizeof(hashed.fChecksum));
+    return cliMD5 == file.fChecksum;
+}
 
-    // Check to see if ours matches
-    plFileName clientPathForComparison = file.fClientPath;
-    if ((file.fFlags & kBundle) && fFindBundleExe) {
-        clientPathForComparison = fFindBundleExe(clientPathForComparison);
+void pfPatcherWorker::IHashFiles(size_t count)
+{
+    // Sort out which files we care about and where they live up front, since the
+    // callbacks for that aren't necessarily thread safe...
+    std::vector<plFileName> paths(count);
+    for (size_t i = 0; i < count; ++i) {
+        const pfPatcherQueuedFile& file = fQueuedFiles[i];
+        if (!IWantFile(file))
+            continue;
+
+        paths[i] = file.fClientPath;
+        if ((file.fFlags & kBundle) && fFindBundleExe)
+            paths[i] = fFindBundleExe(paths[i]);
     }
-    plFileInfo mine(clientPathForComparison);
-    if (mine.FileSize() == file.fFileSize) {
-        plMD5Checksum cliMD5(clientPathForComparison);
-        if (cliMD5 == file.fChecksum) {
-            WhitelistFile(file.fClientPath, false);
-            return;
+
+    // ...then do the disk thrashing and hashing in parallel
+    std::vector<uint8_t> matches(count);
+    std::vector<HashCacheEntry> hashed(count);
+    hsParallelFor(count, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            hashed[i].fFileSize = uint64_t(-1);
+            if (paths[i].IsValid())
+                matches[i] = ILocalFileMatches(paths[i], fQueuedFiles[i], hashed[i]);
         }
+    });
+
+    for (size_t i = 0; i < count; ++i) {
+        if (!paths[i].IsValid())
+            continue;
+
+        if (hashed[i].fFileSize != uint64_t(-1) && fHashCacheFile.IsValid()) {
+            fHashCache[paths[i].AsString()] = hashed[i];
+            fHashCacheDirty = true;
+        }
+
+        if (matches[i])
+            WhitelistFile(fQueuedFiles[i].fClientPath, false);
+        else
+            IEnqueueFile(fQueuedFiles[i]);
     }
+}
 
+void pfPatcherWorker::IEnqueueFile(pfPatcherQueuedFile& file)
+{
     // It's different... but do we want it?
     if (fFileDownloadDesired) {
         if (!fFileDownloadDesired(file.fClientPath)) {
@@ -613,28 +738,37 @@ void pfPatcherWorker::IHashFile(pfPatcherQueuedFile& file)
 void pfPatcherWorker::IDecompressSound(const pfPatcherQueuedFile& file) const
 {
     PatcherLogGreen("\tDecompressing SFX '{}'", file.fClientPath);
-    if (hsCheckBits(file.fFlags, kSndFlagCacheSplit))
-        plAudioFileReader::CacheFile(file.fClientPath, true);
-    if (hsCheckBits(file.fFlags, kSndFlagCacheStereo))
-        plAudioFileReader::CacheFile(file.fClientPath, false);
+    // Split and stereo playback share one cache file, so only build it once
+    if (hsCheckBits(file.fFlags, kSndFlagCacheSplit) || hsCheckBits(file.fFlags, kSndFlagCacheStereo))
+        plAudioFileReader::CacheFile(file.fClientPath);
 }
 
 void pfPatcherWorker::ProcessFile()
 {
+    // Hash in batches so downloads can start before the whole manifest is checked
+    const size_t maxHashBatch = hsParallelThreadCount() * 4;
+
     do {
         pfPatcherQueuedFile& file = fQueuedFiles.front();
         switch (file.fType) {
-        case pfPatcherQueuedFile::Type::kManifestHash:
-            IHashFile(file);
+        case pfPatcherQueuedFile::Type::kManifestHash: {
+            size_t count = 1;
+            while (count < fQueuedFiles.size() && count < maxHashBatch &&
+                   fQueuedFiles[count].fType == pfPatcherQueuedFile::Type::kManifestHash)
+                ++count;
+            IHashFiles(count);
+            while (count--)
+                fQueuedFiles.pop_front();
             break;
+        }
         case pfPatcherQueuedFile::Type::kSoundDecompress:
             IDecompressSound(file);
+            fQueuedFiles.pop_front();
             break;
         }
-        fQueuedFiles.pop_front();
 
-        if (!fRequestActive)
-            IssueRequest();
+        // Top up the download pipeline with anything we just found
+        IssueRequest();
     } while (!fQueuedFiles.empty());
 }
 
@@ -665,6 +799,63 @@ void pfPatcherWorker::WhitelistFile(const plFileName& file, bool justDownloaded,
     }
 }
 
+void pfPatcherWorker::ILoadHashCache()
+{
+    if (!fHashCacheFile.IsValid())
+        return;
+
+    hsUNIXStream s;
+    if (!s.Open(fHashCacheFile, "rb"))
+        return;
+
+    if (s.ReadLE32() != kHashCacheVersion)
+        return;
+
+    uint32_t count = s.ReadLE32();
+    for (uint32_t i = 0; i < count && !s.AtEnd(); ++i) {
+        ST::string path = s.ReadSafeString();
+        HashCacheEntry& entry = fHashCache[path];
+        entry.fFileSize = s.ReadLE32();
+        entry.fFileSize |= uint64_t(s.ReadLE32()) << 32;
+        entry.fModifyTime = s.ReadLE32();
+        entry.fModifyTime |= uint64_t(s.ReadLE32()) << 32;
+        s.Read(sizeof(entry.fChecksum), entry.fChecksum);
+    }
+    PatcherLogWhite("\tLoaded {} cached file hashes", fHashCache.size());
+}
+
+void pfPatcherWorker::ISaveHashCache()
+{
+    if (!fHashCacheFile.IsValid() || !fHashCacheDirty)
+        return;
+
+    // Forget about anything that's gone away since we hashed it
+    for (auto it = fHashCache.begin(); it != fHashCache.end();) {
+        if (plFileInfo(it->first).Exists())
+            ++it;
+        else
+            it = fHashCache.erase(it);
+    }
+
+    hsUNIXStream s;
+    if (!s.Open(fHashCacheFile, "wb")) {
+        PatcherLogRed("\tUnable to save file hashes to '{}'", fHashCacheFile);
+        return;
+    }
+
+    s.WriteLE32(kHashCacheVersion);
+    s.WriteLE32((uint32_t)fHashCache.size());
+    for (const auto& [path, entry] : fHashCache) {
+        s.WriteSafeString(path);
+        s.WriteLE32((uint32_t)entry.fFileSize);
+        s.WriteLE32((uint32_t)(entry.fFileSize >> 32));
+        s.WriteLE32((uint32_t)entry.fModifyTime);
+        s.WriteLE32((uint32_t)(entry.fModifyTime >> 32));
+        s.Write(sizeof(entry.fChecksum), entry.fChecksum);
+    }
+    fHashCacheDirty = false;
+}
+
 void pfPatcherWorker::EnqueuePreloaderLists()
 {
     PatcherLogYellow("\tWARNING: *** Falling back to AuthSrv file lists to get game code ***");
@@ -744,6 +935,11 @@ void pfPatcher::OnSelfPatch(FileDownloadFunc cb)
     fWorker->fSelfPatch = std::move(cb);
 }
 
+void pfPatcher::UseHashCache(const plFileName& cacheFile)
+{
+    fWorker->fHashCacheFile = cacheFile;
+}
+
 // ===================================================
 
 void pfPatcher::RequestGameCode(bool python, bool sdl)
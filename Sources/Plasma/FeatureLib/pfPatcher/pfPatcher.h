@@ -148,6 +148,12 @@ public:
     /** This is called when the current application has been updated. */
     void OnSelfPatch(FileDownloadFunc cb);
 
+    /** Remember the MD5 of every local file we check in \p cacheFile, keyed on the file's
+     *  size and modification time, so files that haven't changed since the last patch
+     *  don't need to be hashed again.
+     */
+    void UseHashCache(const plFileName& cacheFile);
+
     void RequestGameCode(bool python = true, bool sdl = true);
     void RequestManifest(const ST::string& mfs);
     void RequestManifest(const std::vector<ST::string>& mfs);
@@ -56,6 +56,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 ***/
 
 static std::atomic<long> s_perf[kNumAsyncPerfCounters];
+static unsigned          s_ioThreadCount;
 
 /*****************************************************************************
 *
@@ -84,6 +85,16 @@ long PerfSetCounter(unsigned id, long n)
     return s_perf[id].exchange(n);
 }
 
+//============================================================================
+long PerfMaxCounter(unsigned id, long n)
+{
+    ASSERT(id < kNumAsyncPerfCounters);
+    long prev = s_perf[id].load();
+    while (prev < n && !s_perf[id].compare_exchange_weak(prev, n))
+        ;
+    return prev;
+}
+
 /*****************************************************************************
 *
 *   Public exports
@@ -93,7 +104,7 @@ long PerfSetCounter(unsigned id, long n)
 //===========================================================================
 void AsyncCoreInitialize()
 {
-    SocketInitialize();
+    SocketInitialize(s_ioThreadCount);
 }
 
 //============================================================================
@@ -105,6 +116,18 @@ void AsyncCoreDestroy(unsigned waitMs)
     ThreadDestroy(waitMs);
 }
 
+//============================================================================
+void AsyncCoreSetIoThreadCount(unsigned threads)
+{
+    s_ioThreadCount = threads;
+}
+
+//============================================================================
+unsigned AsyncCoreGetIoThreadCount()
+{
+    return s_ioThreadCount;
+}
+
 //============================================================================
 long AsyncPerfGetCounter(unsigned id)
 {
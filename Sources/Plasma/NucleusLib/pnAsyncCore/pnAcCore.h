@@ -53,6 +53,11 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 void AsyncCoreInitialize ();
 void AsyncCoreDestroy (unsigned waitMs);
 
+// Number of socket IO worker threads to start; zero picks a count from the
+// hardware.  Only takes effect if called before AsyncCoreInitialize.
+void AsyncCoreSetIoThreadCount (unsigned threads);
+unsigned AsyncCoreGetIoThreadCount ();
+
 /*****************************************************************************
 *
 *   Performance counters
@@ -71,6 +76,13 @@ enum EAsyncPerfCounter {
     kAsyncPerfNameLookupAttemptsCurr,
     kAsyncPerfNameLookupAttemptsTotal,
 
+    // Socket IO handlers
+    kAsyncPerfSocketBytesInFlight,
+    kAsyncPerfSocketHandlersQueued,
+    kAsyncPerfSocketHandlersTotal,
+    kAsyncPerfSocketHandlerTimeUsTotal,
+    kAsyncPerfSocketHandlerTimeUsMax,
+
     // Threads
     kAsyncPerfThreadsCurr,
     kAsyncPerfThreadsTotal,
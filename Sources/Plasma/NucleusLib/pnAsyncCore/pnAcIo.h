@@ -63,6 +63,12 @@ typedef struct AsyncCancelIdStruct *   AsyncCancelId;
 
 constexpr unsigned kAsyncSocketBufferSize   = 1460;
 
+struct AsyncSocketBuffer
+{
+    const void *    data;
+    size_t          bytes;
+};
+
 class AsyncNotifySocketCallbacks
 {
 public:
@@ -106,6 +112,15 @@ bool AsyncSocketSend (
     size_t                  bytes
 );
 
+// Sends several buffers back to back with a single gathered write.
+// Any data that can't be written immediately is copied, so the
+// buffers may be reused as soon as this returns.
+bool AsyncSocketSend (
+    AsyncSocket             sock,
+    const AsyncSocketBuffer buffers[],
+    size_t                  count
+);
+
 void AsyncSocketEnableNagling (
     AsyncSocket             sock,
     bool                    enable
@@ -43,12 +43,14 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "pnAcIo.h"
 
 #include <algorithm>
+#include <chrono>
 #include <list>
 #include <memory>
 #include <mutex>
 #include <string_theory/format>
 #include <thread>
 #include <utility>
+#include <vector>
 
 #include "hsLockGuard.h"
 #include "hsThread.h"
@@ -56,9 +58,11 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "hsWindows.h"
 
 // Must include asio after hsWindows.h so asio sees our definition of _WIN32_WINNT!
+#include <asio/bind_executor.hpp>
 #include <asio/executor_work_guard.hpp>
 #include <asio/io_context.hpp>
 #include <asio/ip/tcp.hpp>
+#include <asio/strand.hpp>
 #include <asio/write.hpp>
 
 #include "pnNetCommon/plNetAddress.h"
@@ -70,9 +74,13 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 using tcp = asio::ip::tcp;
 
-// handles 8 CPU computer w/hyperthreading (we use 2 threads per logical CPU)
+// upper bound for an explicitly configured IO thread count
 static constexpr unsigned int kMaxWorkerThreads = 32;
 
+// a client only holds a handful of sockets, and each one's handlers are
+// serialized on its strand, so more threads than this just sit idle
+static constexpr unsigned int kMaxAutoWorkerThreads = 4;
+
 // wait before checking for backlog problems
 static constexpr unsigned kBacklogInitMs = 3 * 60 * 1000;
 
@@ -81,30 +89,26 @@ static constexpr unsigned kBacklogFailMs = 2 * 60 * 1000;
 
 static constexpr size_t kMinBacklogBytes = 4 * 1024;
 
+// number of spent write buffers each socket keeps around for reuse
+static constexpr size_t kMaxFreeWriteOps = 8;
+
 struct AsyncIoPool
 {
     asio::io_context                                           fContext;
     asio::executor_work_guard<asio::io_context::executor_type> fWorkGuard;
-    AsyncThreadRef                                             fThreadHandles[kMaxWorkerThreads];
+    std::vector<AsyncThreadRef>                                fThreadHandles;
 
-    AsyncIoPool() : fWorkGuard(fContext.get_executor())
+    AsyncIoPool(unsigned int threadCount)
+        : fContext((int)threadCount), fWorkGuard(fContext.get_executor())
     {
-        // calculate number of IO worker threads to create
-        unsigned int threadCount = std::max(std::thread::hardware_concurrency() * 2, 2U);
-        if (threadCount > kMaxWorkerThreads) {
-            threadCount = kMaxWorkerThreads;
-            LogMsg(kLogError, "kMaxWorkerThreads too small!");
-        }
-
         // create IO worker threads
-        size_t i = 0;
-        for (auto& threadHandle : fThreadHandles) {
-            threadHandle = AsyncThreadCreate([this, i] {
+        fThreadHandles.reserve(threadCount);
+        for (size_t i = 0; i < threadCount; i++) {
+            fThreadHandles.emplace_back(AsyncThreadCreate([this, i] {
                 hsThread::SetThisThreadName(ST::format("AcSocketPool{02d}", i));
                 // This can be run concurrently from several threads
                 fContext.run();
-            });
-            i++;
+            }));
         }
     }
 
@@ -158,18 +162,21 @@ struct AsyncSocketStruct
 {
     std::recursive_mutex        fCritsect;
     tcp::socket                 fSock;
+    asio::strand<tcp::socket::executor_type> fStrand;
     AsyncNotifySocketCallbacks* fCallbacks;
     unsigned int                fConnectionType;
     uint8_t                     fBuffer[kAsyncSocketBufferSize];
     size_t                      fBytesLeft;
     std::list<WriteOperation *> fWriteOps;
+    std::vector<WriteOperation *> fFreeWriteOps;
+    bool                        fWriteInFlight;
     unsigned                    initTimeMs;
     unsigned                    closeTimeMs;
 
     AsyncSocketStruct(ConnectOperation& op)
-        : fSock(std::move(op.fSock)), fCallbacks(op.fCallbacks),
-          fConnectionType(op.fConnectionType),
-          fBuffer(), fBytesLeft(), initTimeMs(), closeTimeMs()
+        : fSock(std::move(op.fSock)), fStrand(asio::make_strand(fSock.get_executor())),
+          fCallbacks(op.fCallbacks), fConnectionType(op.fConnectionType),
+          fBuffer(), fBytesLeft(), fWriteInFlight(), initTimeMs(), closeTimeMs()
     { }
 };
 
@@ -179,12 +186,20 @@ static std::recursive_mutex         s_connectCrit;
 static std::list<ConnectOperation>  s_connectList;
 static uintptr_t                    s_nextConnectCancelId = 1;
 
-void SocketInitialize()
+void SocketInitialize(unsigned ioThreads)
 {
     if (s_ioPool)
         return;
 
-    s_ioPool = new AsyncIoPool;
+    // calculate number of IO worker threads to create
+    if (ioThreads == 0) {
+        ioThreads = std::clamp(std::thread::hardware_concurrency() / 2, 1U, kMaxAutoWorkerThreads);
+    } else if (ioThreads > kMaxWorkerThreads) {
+        LogMsg(kLogError, "Requested {} IO threads, clamping to {}", ioThreads, kMaxWorkerThreads);
+        ioThreads = kMaxWorkerThreads;
+    }
+
+    s_ioPool = new AsyncIoPool(ioThreads);
 }
 
 void SocketDestroy(unsigned exitThreadWaitMs)
@@ -207,12 +222,35 @@ void SocketDestroy(unsigned exitThreadWaitMs)
     }
 }
 
+// Wraps a socket completion handler so it runs on the socket's strand, which
+// keeps its read and write handlers from running concurrently on different
+// IO threads, and accounts for it in the handler perf counters.
+template <typename HandlerT>
+static auto SocketBindHandler(AsyncSocket sock, HandlerT&& handler)
+{
+    PerfAddCounter(kAsyncPerfSocketHandlersQueued, 1);
+    return asio::bind_executor(sock->fStrand,
+        [handler = std::forward<HandlerT>(handler)](const asio::error_code& err, size_t bytes) mutable {
+            PerfSubCounter(kAsyncPerfSocketHandlersQueued, 1);
+
+            // The socket may be deleted by the handler, so only touch the counters afterward
+            auto start = std::chrono::steady_clock::now();
+            handler(err, bytes);
+            auto elapsed = std::chrono::steady_clock::now() - start;
+
+            long elapsedUs = (long)std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+            PerfAddCounter(kAsyncPerfSocketHandlersTotal, 1);
+            PerfAddCounter(kAsyncPerfSocketHandlerTimeUsTotal, elapsedUs);
+            PerfMaxCounter(kAsyncPerfSocketHandlerTimeUsMax, elapsedUs);
+        });
+}
+
 static void SocketStartAsyncRead(AsyncSocket sock)
 {
     hsLockGuard(sock->fCritsect);
     uint8_t* start = sock->fBuffer + sock->fBytesLeft;
     size_t   count = sizeof(sock->fBuffer) - sock->fBytesLeft;
-    sock->fSock.async_read_some(asio::buffer(start, count),
+    sock->fSock.async_read_some(asio::buffer(start, count), SocketBindHandler(sock,
         [sock](const asio::error_code& err, size_t bytes) {
         if (err) {
             bool isEOFError     = (err.category() == asio::error::get_misc_category() && err.value() == asio::error::eof);
@@ -265,7 +303,7 @@ static void SocketStartAsyncRead(AsyncSocket sock)
         }
 
         SocketStartAsyncRead(sock);
-    });
+    }));
 }
 
 static void SocketGetAddresses(AsyncSocket sock, plNetAddress* localAddr,
@@ -401,8 +439,53 @@ void AsyncSocketConnectCancel(AsyncCancelId cancelId)
     }
 }
 
+static void FreeWriteOp(WriteOperation* op)
+{
+    op->~WriteOperation();
+    delete[] reinterpret_cast<uint8_t*>(op);
+}
+
+static WriteOperation* AllocWriteOp(AsyncSocket conn, size_t bytes)
+{
+    // Standard sized buffers are recycled; only oversize sends allocate
+    if (bytes <= kMinBacklogBytes && !conn->fFreeWriteOps.empty()) {
+        WriteOperation* op = conn->fFreeWriteOps.back();
+        conn->fFreeWriteOps.pop_back();
+        return op;
+    }
+
+    // Allocate storage alongside the operation structure itself
+    size_t bytesAlloc = std::max(bytes, kMinBacklogBytes);
+    auto membuf = new uint8_t[sizeof(WriteOperation) + bytesAlloc];
+
+    WriteOperation* op = new (membuf) WriteOperation;
+    op->fAllocSize = bytesAlloc;
+    op->buffer = membuf + sizeof(WriteOperation);
+    return op;
+}
+
+static void ReleaseWriteOp(AsyncSocket conn, WriteOperation* op)
+{
+    if (op->fAllocSize == kMinBacklogBytes && conn->fFreeWriteOps.size() < kMaxFreeWriteOps) {
+        op->bytes = 0;
+        op->bytesProcessed = 0;
+        op->bytesCommitted = 0;
+        conn->fFreeWriteOps.emplace_back(op);
+    } else {
+        FreeWriteOp(op);
+    }
+}
+
 void AsyncSocketDelete(AsyncSocket conn)
 {
+    {
+        hsLockGuard(conn->fCritsect);
+        for (WriteOperation* op : conn->fWriteOps)
+            FreeWriteOp(op);
+        for (WriteOperation* op : conn->fFreeWriteOps)
+            FreeWriteOp(op);
+    }
+
     delete conn;
 }
 
@@ -433,30 +516,9 @@ void AsyncSocketDisconnect(AsyncSocket conn, bool hardClose)
     conn->closeTimeMs |= 1;
 }
 
-static bool SocketQueueAsyncWrite(AsyncSocket conn, const void* data, size_t bytes)
+// Appends data to the socket's pending write buffers.  conn->fCritsect must be held.
+static void SocketQueueWriteData(AsyncSocket conn, const void* data, size_t bytes)
 {
-    hsLockGuard(s_connectCrit);
-
-    // check for data backlog
-    if (!conn->fWriteOps.empty()) {
-        WriteOperation* firstQueuedWrite = conn->fWriteOps.front();
-        unsigned currTimeMs = hsTimer::GetMilliSeconds<unsigned>();
-        if (((long)(currTimeMs - firstQueuedWrite->queueTimeMs) >= (long)kBacklogFailMs) && ((long)(currTimeMs - conn->initTimeMs) >= (long)kBacklogInitMs)) {
-            PerfAddCounter(kAsyncPerfSocketDisconnectBacklog, 1);
-
-            if (conn->fConnectionType) {
-                LogMsg(
-                    kLogPerf,
-                    "Backlog, c:{} q:{}, i:{}",
-                    conn->fConnectionType,
-                    currTimeMs - firstQueuedWrite->queueTimeMs,
-                    currTimeMs - conn->initTimeMs);
-            }
-            AsyncSocketDisconnect((AsyncSocket)conn, true);
-            return false;
-        }
-    }
-
     // If the last buffer still has space available then add data to it
     if (!conn->fWriteOps.empty()) {
         WriteOperation* op = conn->fWriteOps.back();
@@ -471,15 +533,9 @@ static bool SocketQueueAsyncWrite(AsyncSocket conn, const void* data, size_t byt
     }
 
     if (bytes) {
-        // Allocate storage alongside the operation structure itself
-        size_t bytesAlloc = std::max(bytes, kMinBacklogBytes);
-        auto membuf = new uint8_t[sizeof(WriteOperation) + bytesAlloc];
-
-        WriteOperation* op = new (membuf) WriteOperation;
+        WriteOperation* op = AllocWriteOp(conn, bytes);
         conn->fWriteOps.emplace_back(op);
 
-        op->fAllocSize = bytesAlloc;
-        op->buffer = membuf + sizeof(WriteOperation);
         op->bytes = bytes;
         op->bytesProcessed = 0;
         op->queueTimeMs = hsTimer::GetMilliSeconds<unsigned>();
@@ -487,17 +543,35 @@ static bool SocketQueueAsyncWrite(AsyncSocket conn, const void* data, size_t byt
 
         PerfAddCounter(kAsyncPerfSocketBytesWaitQueued, bytes);
     }
+}
 
+// Hands everything queued but not yet committed to a single async write.  Only
+// one write is in flight per socket, so composed writes can never interleave
+// on the wire; the completion handler chains the next one.  conn->fCritsect
+// must be held.
+static void SocketStartAsyncWrite(AsyncSocket conn)
+{
     std::vector<asio::const_buffer> allWrites;
     allWrites.reserve(conn->fWriteOps.size());
+    size_t bytesCommitted = 0;
     for (WriteOperation* op : conn->fWriteOps) {
         if (op->bytes - op->bytesCommitted > 0) {
             allWrites.emplace_back(op->AsBuffer());
+            bytesCommitted += op->bytes - op->bytesCommitted;
             op->bytesCommitted = op->bytes;
         }
     }
-    async_write(conn->fSock, allWrites, [conn](const asio::error_code& err, size_t bytes) {
-        hsLockGuard(s_connectCrit);
+
+    conn->fWriteInFlight = !allWrites.empty();
+    if (!conn->fWriteInFlight)
+        return;
+
+    PerfAddCounter(kAsyncPerfSocketBytesInFlight, (long)bytesCommitted);
+    asio::async_write(conn->fSock, allWrites, SocketBindHandler(conn,
+        [conn, bytesCommitted](const asio::error_code& err, size_t bytes) {
+        PerfSubCounter(kAsyncPerfSocketBytesInFlight, (long)bytesCommitted);
+
+        hsLockGuard(conn->fCritsect);
         while (bytes != 0) {
             hsAssert(conn->fWriteOps.size() > 0, "buffer mismatch");
             WriteOperation* op = conn->fWriteOps.front();
@@ -507,42 +581,115 @@ static bool SocketQueueAsyncWrite(AsyncSocket conn, const void* data, size_t byt
             bytes -= opBytesWritten;
             if (op->bytes == op->bytesProcessed) {
                 conn->fWriteOps.pop_front();
+                ReleaseWriteOp(conn, op);
             }
         }
-    });
+
+        // A failed socket keeps its write flagged as in flight, so that
+        // anything sent afterward just waits in the queue for the backlog
+        // check or AsyncSocketDelete to dispose of it.
+        if (err) {
+            LogMsg(kLogError, "Failed to write to socket: {}", err.message());
+            return;
+        }
+
+        SocketStartAsyncWrite(conn);
+    }));
+}
+
+static bool SocketQueueAsyncWrite(AsyncSocket conn, const AsyncSocketBuffer buffers[], size_t count)
+{
+    hsLockGuard(conn->fCritsect);
+
+    // check for data backlog
+    if (!conn->fWriteOps.empty()) {
+        WriteOperation* firstQueuedWrite = conn->fWriteOps.front();
+        unsigned currTimeMs = hsTimer::GetMilliSeconds<unsigned>();
+        if (((long)(currTimeMs - firstQueuedWrite->queueTimeMs) >= (long)kBacklogFailMs) && ((long)(currTimeMs - conn->initTimeMs) >= (long)kBacklogInitMs)) {
+            PerfAddCounter(kAsyncPerfSocketDisconnectBacklog, 1);
+
+            if (conn->fConnectionType) {
+                LogMsg(
+                    kLogPerf,
+                    "Backlog, c:{} q:{}, i:{}",
+                    conn->fConnectionType,
+                    currTimeMs - firstQueuedWrite->queueTimeMs,
+                    currTimeMs - conn->initTimeMs);
+            }
+            AsyncSocketDisconnect((AsyncSocket)conn, true);
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (buffers[i].bytes)
+            SocketQueueWriteData(conn, buffers[i].data, buffers[i].bytes);
+    }
+
+    if (!conn->fWriteInFlight)
+        SocketStartAsyncWrite(conn);
 
     return true;
 }
 
 bool AsyncSocketSend(AsyncSocket conn, const void* data, size_t bytes)
 {
-    ASSERT(conn);
     ASSERT(data);
     ASSERT(bytes);
 
+    AsyncSocketBuffer buffer { data, bytes };
+    return AsyncSocketSend(conn, &buffer, 1);
+}
+
+bool AsyncSocketSend(AsyncSocket conn, const AsyncSocketBuffer buffers[], size_t count)
+{
+    ASSERT(conn);
+    ASSERT(buffers);
+    ASSERT(count);
+
     hsLockGuard(conn->fCritsect);
 
     // This is why we set the socket to non-blocking... If we can write the
     // data right away, we do so in order to save extra allocations for the
     // write buffer.  Otherwise, we must queue it for an async write below.
+    size_t first = 0;
+    size_t firstOffset = 0;
     if (conn->fWriteOps.empty()) {
+        std::vector<asio::const_buffer> gather;
+        gather.reserve(count);
+        size_t totalBytes = 0;
+        for (size_t i = 0; i < count; i++) {
+            gather.emplace_back(asio::buffer(buffers[i].data, buffers[i].bytes));
+            totalBytes += buffers[i].bytes;
+        }
+
         asio::error_code err;
-        size_t           bytesSent = conn->fSock.write_some(asio::buffer(data, bytes), err);
+        size_t           bytesSent = conn->fSock.write_some(gather, err);
         if (!err) {
             // All data was written, nothing left to do!
-            if (bytesSent >= bytes)
+            if (bytesSent >= totalBytes)
                 return true;
 
             // Skip the data we already sent, in order to queue it below
-            data = (const uint8_t*)data + bytesSent;
-            bytes -= bytesSent;
+            while (bytesSent >= buffers[first].bytes) {
+                bytesSent -= buffers[first].bytes;
+                first++;
+            }
+            firstOffset = bytesSent;
         } else if (err != asio::error::would_block) {
             LogMsg(kLogError, "Failed to write data to socket: {}", err.message());
             AsyncSocketDisconnect(conn, true);
         }
     }
 
-    return SocketQueueAsyncWrite(conn, data, bytes);
+    if (firstOffset == 0)
+        return SocketQueueAsyncWrite(conn, buffers + first, count - first);
+
+    // Partially sent buffer; queue a trimmed copy of the list
+    std::vector<AsyncSocketBuffer> remaining(buffers + first, buffers + count);
+    remaining[0].data = (const uint8_t*)remaining[0].data + firstOffset;
+    remaining[0].bytes -= firstOffset;
+    return SocketQueueAsyncWrite(conn, remaining.data(), remaining.size());
 }
 
 void AsyncSocketEnableNagling(AsyncSocket conn, bool enable)
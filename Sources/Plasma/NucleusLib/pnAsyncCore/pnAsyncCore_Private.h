@@ -54,6 +54,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 long PerfAddCounter (unsigned id, long n);
 long PerfSubCounter (unsigned id, long n);
 long PerfSetCounter (unsigned id, long n);
+long PerfMaxCounter (unsigned id, long n);
 
 
 /*****************************************************************************
@@ -71,7 +72,7 @@ void DnsDestroy (unsigned exitThreadWaitMs);
 *
 ***/
 
-void SocketInitialize();
+void SocketInitialize(unsigned ioThreads);
 void SocketDestroy(unsigned exitThreadWaitMs);
 
 
@@ -51,12 +51,15 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "pnMessage/plTimeMsg.h"
 #include "pnKeyedObject/plKey.h"
 #include "plDispatchLogBase.h"
+#include "plDispatchStats.h"
 #include "pnNetCommon/plNetApp.h"
 #include "pnNetCommon/plSynchedObject.h"
 #include "pnNetCommon/pnNetCommon.h"
 #include "hsThread.h"
 #include "plProfile.h"
 
+#include <algorithm>
+
 #ifdef HS_DEBUGGING
 #include "hsDebug.h"
 #endif
@@ -75,12 +78,18 @@ public:
     std::vector<plKey>              fReceivers;
 
     plMessage*                      fMsg;
+    uint64_t                        fEnqueueTicks;  // only set while plDispatchStats is enabled
 
     plMsgWrap(plMessage* msg)
-        : fMsg(msg), fNext(), fBack()
+        : fMsg(msg), fNext(), fBack(), fEnqueueTicks()
     { hsRefCnt_SafeRef(msg); }
     virtual ~plMsgWrap() { hsRefCnt_SafeUnRef(fMsg); }
 
+    // Wraps are recycled rather than deleted, which also lets us hang on to
+    // the receiver list's storage between messages.
+    static plMsgWrap*   Create(plMessage* msg);
+    static void         Destroy(plMsgWrap* wrap);
+
     plMsgWrap&      ClearReceivers() { fReceivers.clear(); return *this; }
     plMsgWrap&      AddReceiver(plKey rcv)
                     {
@@ -92,6 +101,50 @@ public:
     size_t          GetNumReceivers() const { return fReceivers.size(); }
 };
 
+static std::vector<plMsgWrap*>  s_msgWrapPool;
+static std::mutex               s_msgWrapPoolMutex;
+static constexpr size_t         kMaxPooledMsgWraps = 512;
+
+plMsgWrap* plMsgWrap::Create(plMessage* msg)
+{
+    plMsgWrap* wrap = nullptr;
+    {
+        hsLockGuard(s_msgWrapPoolMutex);
+        if (!s_msgWrapPool.empty())
+        {
+            wrap = s_msgWrapPool.back();
+            s_msgWrapPool.pop_back();
+        }
+    }
+
+    if (!wrap)
+        return new plMsgWrap(msg);
+
+    wrap->fMsg = msg;
+    hsRefCnt_SafeRef(msg);
+    return wrap;
+}
+
+void plMsgWrap::Destroy(plMsgWrap* wrap)
+{
+    hsRefCnt_SafeUnRef(wrap->fMsg);
+    wrap->fMsg = nullptr;
+    wrap->fNext = nullptr;
+    wrap->fBack = nullptr;
+    wrap->fEnqueueTicks = 0;
+    wrap->ClearReceivers();
+
+    {
+        hsLockGuard(s_msgWrapPoolMutex);
+        if (s_msgWrapPool.size() < kMaxPooledMsgWraps)
+        {
+            s_msgWrapPool.emplace_back(wrap);
+            return;
+        }
+    }
+    delete wrap;
+}
+
 int32_t                 plDispatch::fNumBufferReq = 0;
 bool                    plDispatch::fMsgActive = false;
 plMsgWrap*              plDispatch::fMsgCurrent = nullptr;
@@ -105,13 +158,18 @@ std::mutex              plDispatch::fMsgDispatchLock; // mutex for IMsgDispatch
 
 
 plDispatch::plDispatch()
-: fOwner(), fFutureMsgQueue(), fQueuedMsgOn(true)
+: fOwner(), fFutureMsgQueue(), fQueuedMsgHead(), fQueuedMsgOn(true)
 {
+    // Size the table for every class up front, so broadcasts and
+    // registrations never have to grow it
+    fRegisteredExactTypes.resize(plFactory::GetNumClasses());
 }
 
 plDispatch::~plDispatch()
 {
-    hsAssert(fRegisteredExactTypes.empty(), "registered type after Dispatch shutdown");
+    hsAssert(std::all_of(fRegisteredExactTypes.cbegin(), fRegisteredExactTypes.cend(),
+                         [](plTypeFilter* filt) { return filt == nullptr; }),
+             "registered type after Dispatch shutdown");
     ITrashUndelivered();
 }
 
@@ -130,7 +188,7 @@ void plDispatch::ITrashUndelivered()
         plMsgWrap* nuke = fFutureMsgQueue;
         fFutureMsgQueue = fFutureMsgQueue->fNext;
         hsRefCnt_SafeUnRef(nuke->fMsg);
-        delete nuke;
+        plMsgWrap::Destroy(nuke);
     }
 
     // If we're the main dispatch, any unsent messages at this
@@ -143,8 +201,8 @@ void plDispatch::ITrashUndelivered()
         {
             plMsgWrap* nuke = fMsgHead;
             fMsgHead = fMsgHead->fNext;
-            // hsRefCnt_SafeUnRef(nuke->fMsg);      // MOOSE - done in plMsgWrap dtor
-            delete nuke;
+            // hsRefCnt_SafeUnRef(nuke->fMsg);      // MOOSE - done in plMsgWrap::Destroy
+            plMsgWrap::Destroy(nuke);
         }
 
         // reset static members which we just deleted - MOOSE
@@ -180,7 +238,7 @@ plMsgWrap* plDispatch::IDequeue(plMsgWrap** head, plMsgWrap** tail)
 
 bool plDispatch::ISortToDeferred(plMessage* msg)
 {
-    plMsgWrap* msgWrap = new plMsgWrap(msg);
+    plMsgWrap* msgWrap = plMsgWrap::Create(msg);
     if( !fFutureMsgQueue )
     {
         if( IGetOwner() )
@@ -209,7 +267,7 @@ void plDispatch::ICheckDeferred(double secs)
     {
         plMsgWrap* send = IDequeue(&fFutureMsgQueue, nullptr);
         MsgSend(send->fMsg);
-        delete send;
+        plMsgWrap::Destroy(send);
     }
 
     uint16_t timeIdx = plTimeMsg::Index();
@@ -235,6 +293,11 @@ bool plDispatch::IListeningForExactType(uint16_t hClass)
 
 void plDispatch::IMsgEnqueue(plMsgWrap* msgWrap, bool async)
 {
+#ifndef PLASMA_EXTERNAL_RELEASE
+    if (plDispatchStats::IsEnabled())
+        msgWrap->fEnqueueTicks = hsTimer::GetTicks();
+#endif // PLASMA_EXTERNAL_RELEASE
+
     {
         hsLockGuard(fMsgCurrentMutex);
 
@@ -316,6 +379,14 @@ void plDispatch::IMsgDispatch()
         if (plDispatchLogBase::IsLogging())
             startTicks = hsTimer::GetTicks();
 
+#ifndef PLASMA_EXTERNAL_RELEASE
+        bool recordStats = msg && plDispatchStats::IsEnabled();
+        uint16_t msgClassIdx = recordStats ? msg->ClassIndex() : 0;
+        uint64_t enqueueTicks = fMsgCurrent->fEnqueueTicks;
+        uint64_t dispatchTicks = recordStats ? hsTimer::GetTicks() : 0;
+        uint64_t handlerTicks = 0;
+#endif // PLASMA_EXTERNAL_RELEASE
+
         int numReceivers=0;
         for (size_t i = 0; fMsgCurrent && i < fMsgCurrent->GetNumReceivers(); i++)
         {
@@ -374,10 +445,11 @@ void plDispatch::IMsgDispatch()
                 plProfile_EndTiming(MsgReceive);
 
 #ifndef PLASMA_EXTERNAL_RELEASE
+                rcvTicks = hsTimer::GetTicks() - rcvTicks;
+                handlerTicks += rcvTicks;
+
                 if (plDispatchLogBase::IsLoggingLong())
                 {
-                    rcvTicks = hsTimer::GetTicks() - rcvTicks;
-
                     float rcvTime = hsTimer::GetMilliSeconds<float>(rcvTicks);
                     // If the receiver takes more than 5 ms to process its message, log it
                     if (rcvTime > 5.f)
@@ -392,6 +464,15 @@ void plDispatch::IMsgDispatch()
             }
         }
 
+#ifndef PLASMA_EXTERNAL_RELEASE
+        // Messages queued before stats were turned on have no enqueue time
+        if (recordStats)
+        {
+            uint64_t waitTicks = enqueueTicks ? dispatchTicks - enqueueTicks : 0;
+            plDispatchStats::Record(msgClassIdx, handlerTicks, waitTicks, numReceivers);
+        }
+#endif // PLASMA_EXTERNAL_RELEASE
+
         // for message logging
 //      if (plDispatchLogBase::IsLogging())
 //      {
@@ -407,7 +488,7 @@ void plDispatch::IMsgDispatch()
 
         msgCurrentLock.lock();
 
-        delete fMsgCurrent;
+        plMsgWrap::Destroy(fMsgCurrent);
         // TEMP
         fMsgCurrent = (class plMsgWrap *)(uintptr_t)0xdeadc0de;
     }
@@ -471,7 +552,7 @@ bool plDispatch::MsgSend(plMessage* msg, bool async)
     else if((timeMsg = plTimeMsg::ConvertNoRef(msg)))
         ICheckDeferred(timeMsg->DSeconds());
 
-    plMsgWrap* msgWrap = new plMsgWrap(msg);
+    plMsgWrap* msgWrap = plMsgWrap::Create(msg);
     msg->UnRef();
 
     // broadcast
@@ -483,8 +564,7 @@ bool plDispatch::MsgSend(plMessage* msg, bool async)
             plTypeFilter* filt = fRegisteredExactTypes[idx];
             if( filt )
             {
-                for (const plKey& rcvr : filt->fReceivers)
-                    msgWrap->AddReceiver(rcvr);
+                msgWrap->fReceivers = filt->fReceivers;
 
                 if( msg->HasBCastFlag(plMessage::kClearAfterBCast) )
                 {
@@ -508,13 +588,25 @@ void plDispatch::MsgQueueOnOff(bool sw)
 {
     fQueuedMsgOn = sw;
 }
+// Link of the oldest message on the queue, so that every queued message has
+// a non-null fQueueNext and queueing one twice can be caught
+static char s_queueEndMarker;
+static plMessage* const kQueueEnd = reinterpret_cast<plMessage*>(&s_queueEndMarker);
+
 void plDispatch::MsgQueue(plMessage* msg)
 {
     if (fQueuedMsgOn)
     {
-        hsLockGuard(fQueuedMsgListMutex);
         hsAssert(msg,"Message missing");
-        fQueuedMsgList.push_back(msg);
+        hsAssert(msg->fQueueNext == nullptr, "Message is already in the queue");
+
+        // Any number of threads can push here without taking a lock. The
+        // main thread takes the whole stack at once in MsgQueueProcess.
+        plMessage* head = fQueuedMsgHead.load(std::memory_order_relaxed);
+        do
+            msg->fQueueNext = head ? head : kQueueEnd;
+        while (!fQueuedMsgHead.compare_exchange_weak(head, msg, std::memory_order_release,
+                                                     std::memory_order_relaxed));
     }
     else
         MsgSend(msg, false);
@@ -522,34 +614,71 @@ void plDispatch::MsgQueue(plMessage* msg)
 
 void plDispatch::MsgQueueProcess()
 {
-    // Process all messages on Queue, unlock while sending them
-    // this would allow other threads to put new messages on the list while we send()
-    bool empty = false;
-    while (!empty)
+    // Grab everything that's been queued so far, and keep going until other
+    // threads stop putting new messages on the queue while we send()
+    plMessage* pending;
+    while ((pending = fQueuedMsgHead.exchange(nullptr, std::memory_order_acquire)))
     {
-        plMessage * pMsg = nullptr;
+        // The stack is newest first, so flip it around to send in queued order
+        plMessage* ordered = kQueueEnd;
+        while (pending != kQueueEnd)
         {
-            hsLockGuard(fQueuedMsgListMutex);
-            empty = fQueuedMsgList.empty();
-            if (!empty)
-            {
-                pMsg = fQueuedMsgList.front();
-                fQueuedMsgList.pop_front();
-            }
+            plMessage* next = pending->fQueueNext;
+            pending->fQueueNext = ordered;
+            ordered = pending;
+            pending = next;
         }
-        if (pMsg)
+
+        while (ordered != kQueueEnd)
+        {
+            plMessage* pMsg = ordered;
+            ordered = ordered->fQueueNext;
+            pMsg->fQueueNext = nullptr;
             MsgSend(pMsg, false);
+        }
     }
 }
 
-void plDispatch::RegisterForType(uint16_t hClass, const plKey& receiver)
+//
+// Returns every class index that derives from hClass, including hClass itself.
+// Asking the factory about every class on each registration adds up quickly
+// when hundreds of objects register for the same base message type, so the
+// answer is built once per class and kept around.
+//
+const std::vector<uint16_t>& plDispatch::IGetDerivedClasses(uint16_t hClass)
 {
-    int i;
-    for( i = 0; i < plFactory::GetNumClasses(); i++ )
+    static std::mutex s_derivedMutex;
+    static std::vector<std::vector<uint16_t>> s_derivedClasses;
+    static std::vector<bool> s_derivedBuilt;
+    static const std::vector<uint16_t> s_noClasses;
+
+    hsLockGuard(s_derivedMutex);
+    if (s_derivedClasses.empty())
     {
-        if( plFactory::DerivesFrom(hClass, i) )
-            RegisterForExactType(i, receiver);
+        s_derivedClasses.resize(plFactory::GetNumClasses());
+        s_derivedBuilt.resize(plFactory::GetNumClasses());
     }
+
+    if (hClass >= s_derivedClasses.size())
+        return s_noClasses;
+
+    std::vector<uint16_t>& derived = s_derivedClasses[hClass];
+    if (!s_derivedBuilt[hClass])
+    {
+        for (uint16_t i = 0; i < s_derivedClasses.size(); i++)
+        {
+            if (plFactory::DerivesFrom(hClass, i))
+                derived.emplace_back(i);
+        }
+        s_derivedBuilt[hClass] = true;
+    }
+    return derived;
+}
+
+void plDispatch::RegisterForType(uint16_t hClass, const plKey& receiver)
+{
+    for (uint16_t i : IGetDerivedClasses(hClass))
+        RegisterForExactType(i, receiver);
 }
 
 void plDispatch::RegisterForExactType(uint16_t hClass, const plKey& receiver)
@@ -571,10 +700,10 @@ void plDispatch::RegisterForExactType(uint16_t hClass, const plKey& receiver)
 
 void plDispatch::UnRegisterForType(uint16_t hClass, const plKey& receiver)
 {
-    for (size_t i = 0; i < fRegisteredExactTypes.size(); i++)
+    for (uint16_t i : IGetDerivedClasses(hClass))
     {
-        if (plFactory::DerivesFrom(hClass, uint16_t(i)))
-            IUnRegisterForExactType(uint16_t(i), receiver);
+        if (i < fRegisteredExactTypes.size())
+            IUnRegisterForExactType(i, receiver);
     }
 }
 
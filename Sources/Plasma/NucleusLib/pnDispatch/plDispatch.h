@@ -43,7 +43,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #ifndef plDispatch_inc
 #define plDispatch_inc
 
-#include <list>
+#include <atomic>
 #include <mutex>
 #include "plgDispatch.h"
 #include "hsThread.h"
@@ -82,17 +82,16 @@ protected:
     static std::vector<plMessage*>  fMsgWatch;
     static MsgRecieveCallback       fMsgRecieveCallback;
 
-    std::vector<plTypeFilter*>      fRegisteredExactTypes;
-    std::list<plMessage*>           fQueuedMsgList;
-    std::mutex                      fQueuedMsgListMutex; // mutex for above
+    std::vector<plTypeFilter*>      fRegisteredExactTypes;  // Indexed by class; RegisterForType fills in every derived class
+    std::atomic<plMessage*>         fQueuedMsgHead;     // Lock-free stack of messages from MsgQueue, newest first
     bool                            fQueuedMsgOn;       // Turns on or off Queued Messages, Plugins need them off
 
     hsKeyedObject*                  IGetOwner() { return fOwner; }
     plKey                           IGetOwnerKey() { return IGetOwner() ? IGetOwner()->GetKey() : nullptr; }
-    int                             IFindType(uint16_t hClass);
-    int                             IFindSender(const plKey& sender);
     bool                            IUnRegisterForExactType(uint16_t idx, const plKey& receiver);
 
+    static const std::vector<uint16_t>& IGetDerivedClasses(uint16_t hClass);
+
     static plMsgWrap*               IInsertToQueue(plMsgWrap** back, plMsgWrap* isert);
     static plMsgWrap*               IDequeue(plMsgWrap** head, plMsgWrap** tail);
 
@@ -0,0 +1,148 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include "plDispatchStats.h"
+
+#include "hsStream.h"
+#include "hsThread.h"
+#include "hsTimer.h"
+#include "plProfile.h"
+
+#include "pnFactory/plFactory.h"
+
+#include <algorithm>
+#include <string_theory/format>
+
+bool                                        plDispatchStats::fEnabled = false;
+std::mutex                                  plDispatchStats::fMutex;
+std::vector<plDispatchStats::ClassStats>    plDispatchStats::fStats;
+
+uint32_t plDispatchStats::IFanOutBucket(uint32_t numReceivers)
+{
+    uint32_t bucket = 0;
+    while (numReceivers && bucket < kNumFanOutBuckets - 1)
+    {
+        numReceivers >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+void plDispatchStats::Record(uint16_t classIdx, uint64_t handlerTicks, uint64_t waitTicks, uint32_t numReceivers)
+{
+    hsLockGuard(fMutex);
+
+    if (classIdx >= fStats.size())
+        fStats.resize(std::max<size_t>(classIdx + 1, plFactory::GetNumClasses()), ClassStats());
+
+    ClassStats& stats = fStats[classIdx];
+    stats.fCount++;
+    stats.fHandlerTicks += handlerTicks;
+    stats.fMaxHandlerTicks = std::max(stats.fMaxHandlerTicks, handlerTicks);
+    stats.fWaitTicks += waitTicks;
+    stats.fMaxWaitTicks = std::max(stats.fMaxWaitTicks, waitTicks);
+    stats.fReceivers += numReceivers;
+    stats.fMaxReceivers = std::max(stats.fMaxReceivers, numReceivers);
+    stats.fFanOut[IFanOutBucket(numReceivers)]++;
+
+#ifdef PL_PROFILE_ENABLED
+    // The profile manager holds on to its vars for the life of the process,
+    // so these are never freed. There is at most one pair per message class.
+    if (!stats.fTimeVar)
+    {
+        ST::string className = plFactory::GetNameOfClass(classIdx);
+        stats.fTimeVar = new plProfileVar(className, ST_LITERAL("Dispatch Time"), plProfileVar::kDisplayTime);
+        stats.fCountVar = new plProfileVar(className, ST_LITERAL("Dispatch Receives"), plProfileVar::kDisplayCount);
+    }
+    stats.fTimeVar->Inc(int(handlerTicks));
+    stats.fCountVar->Inc(int(numReceivers));
+#endif
+}
+
+void plDispatchStats::Reset()
+{
+    hsLockGuard(fMutex);
+
+    // Keep the profile vars, they're owned by the profile manager now
+    for (ClassStats& stats : fStats)
+    {
+        plProfileVar* timeVar = stats.fTimeVar;
+        plProfileVar* countVar = stats.fCountVar;
+        stats = ClassStats();
+        stats.fTimeVar = timeVar;
+        stats.fCountVar = countVar;
+    }
+}
+
+bool plDispatchStats::DumpCSV(const plFileName& filename)
+{
+    hsUNIXStream s;
+    if (!s.Open(filename, "wb"))
+        return false;
+
+    s.WriteString(ST_LITERAL("Class,Count,Total ms,Avg ms,Max ms,Avg Wait ms,Max Wait ms,"
+                             "Receivers,Avg Fan-out,Max Fan-out,"
+                             "Fan-out 0,Fan-out 1,Fan-out 2-3,Fan-out 4-7,Fan-out 8-15,Fan-out 16-31,Fan-out 32+\r\n"));
+
+    hsLockGuard(fMutex);
+    for (size_t i = 0; i < fStats.size(); i++)
+    {
+        const ClassStats& stats = fStats[i];
+        if (!stats.fCount)
+            continue;
+
+        double totalMs = hsTimer::GetMilliSeconds<double>(stats.fHandlerTicks);
+        s.WriteString(ST::format("{},{},{.3f},{.4f},{.3f},{.4f},{.3f},{},{.2f},{}",
+                                 plFactory::GetNameOfClass(uint16_t(i)), stats.fCount,
+                                 totalMs, totalMs / stats.fCount,
+                                 hsTimer::GetMilliSeconds<double>(stats.fMaxHandlerTicks),
+                                 hsTimer::GetMilliSeconds<double>(stats.fWaitTicks) / stats.fCount,
+                                 hsTimer::GetMilliSeconds<double>(stats.fMaxWaitTicks),
+                                 stats.fReceivers, double(stats.fReceivers) / stats.fCount,
+                                 stats.fMaxReceivers));
+        for (uint32_t bucket : stats.fFanOut)
+            s.WriteString(ST::format(",{}", bucket));
+        s.WriteString(ST_LITERAL("\r\n"));
+    }
+
+    return true;
+}
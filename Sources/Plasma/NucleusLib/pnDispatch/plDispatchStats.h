@@ -0,0 +1,97 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+#ifndef plDispatchStats_inc
+#define plDispatchStats_inc
+
+#include "HeadSpin.h"
+
+#include <mutex>
+#include <vector>
+
+class plFileName;
+class plProfileVar;
+
+//
+// Per-message-class accounting for plDispatch. When enabled, every message
+// delivered by IMsgDispatch is tallied against its creatable class: how many
+// were sent, how long their receivers took, how many receivers each one
+// reached, and how long it sat in the queue before delivery.
+//
+class plDispatchStats
+{
+public:
+    enum { kNumFanOutBuckets = 7 };   // 0, 1, 2-3, 4-7, 8-15, 16-31, 32+
+
+    struct ClassStats
+    {
+        uint32_t    fCount;
+        uint64_t    fHandlerTicks;
+        uint64_t    fMaxHandlerTicks;
+        uint64_t    fWaitTicks;
+        uint64_t    fMaxWaitTicks;
+        uint64_t    fReceivers;
+        uint32_t    fMaxReceivers;
+        uint32_t    fFanOut[kNumFanOutBuckets];
+
+        plProfileVar*   fTimeVar;
+        plProfileVar*   fCountVar;
+    };
+
+protected:
+    static bool                     fEnabled;
+    static std::mutex               fMutex;
+    static std::vector<ClassStats>  fStats;
+
+    static uint32_t IFanOutBucket(uint32_t numReceivers);
+
+public:
+    static bool IsEnabled() { return fEnabled; }
+    static void SetEnabled(bool on) { fEnabled = on; }
+
+    static void Record(uint16_t classIdx, uint64_t handlerTicks, uint64_t waitTicks, uint32_t numReceivers);
+    static void Reset();
+
+    // Writes one row per message class that has been dispatched since the last Reset()
+    static bool DumpCSV(const plFileName& filename);
+};
+
+#endif // plDispatchStats_inc
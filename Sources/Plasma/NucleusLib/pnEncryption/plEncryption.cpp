@@ -41,8 +41,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 *==LICENSE==*/
 
 #include "plEncryption.h"
-
-#include <openssl/rc4.h>
+#include "plRC4.h"
 
 /*****************************************************************************
 *
@@ -85,15 +84,7 @@ static void Rc4Codec (
     void *          data
 ) {
     // RC4 uses the same algorithm to both encrypt and decrypt
-    uint8_t * temp = (uint8_t *)malloc(bytes);
-
-    IGNORE_WARNINGS_BEGIN("deprecated-declarations")
-    RC4((RC4_KEY *)key->handle, bytes, (const unsigned char *)data, temp);
-    IGNORE_WARNINGS_END
-
-    memcpy(data, temp, bytes);
-
-    free(temp);
+    ((plRC4 *)key->handle)->Process(data, bytes);
 }
 
 } using namespace Crypt;
@@ -114,10 +105,7 @@ CryptKey * CryptKeyCreate (
     CryptKey * key = nullptr;
     switch (algorithm) {
         case kCryptRc4: {
-            IGNORE_WARNINGS_BEGIN("deprecated-declarations")
-            RC4_KEY * rc4 = new RC4_KEY;
-            RC4_set_key(rc4, bytes, (const unsigned char *)data);
-            IGNORE_WARNINGS_END
+            plRC4 * rc4 = new plRC4(data, bytes);
 
             key = new CryptKey;
             key->algorithm = kCryptRc4;
@@ -141,7 +129,7 @@ void CryptKeyClose (
     if (!key)
         return;
 
-    delete (RC4_KEY *)key->handle;
+    delete (plRC4 *)key->handle;
     delete key;
 }
 
@@ -0,0 +1,116 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include "plRC4.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+plRC4::plRC4(const void* key, size_t keyBytes)
+    : fI(), fJ(), fKeystream(), fKeystreamPos(kKeystreamBytes)
+{
+    hsAssert(key && keyBytes, "RC4 requires a key");
+
+    for (size_t i = 0; i < std::size(fS); ++i)
+        fS[i] = (uint8_t)i;
+
+    const uint8_t* k = reinterpret_cast<const uint8_t*>(key);
+    uint8_t j = 0;
+    for (size_t i = 0; i < std::size(fS); ++i) {
+        j += fS[i] + k[i % keyBytes];
+        std::swap(fS[i], fS[j]);
+    }
+}
+
+void plRC4::IGenerateKeystream()
+{
+    // The state lives in locals so the compiler can keep it in registers
+    uint8_t i = fI;
+    uint8_t j = fJ;
+    for (uint8_t& out : fKeystream) {
+        i += 1;
+        uint8_t si = fS[i];
+        j += si;
+        uint8_t sj = fS[j];
+        fS[i] = sj;
+        fS[j] = si;
+        out = fS[(uint8_t)(si + sj)];
+    }
+    fI = i;
+    fJ = j;
+    fKeystreamPos = 0;
+}
+
+void plRC4::Process(void* data, size_t bytes)
+{
+    uint8_t* buf = reinterpret_cast<uint8_t*>(data);
+    while (bytes) {
+        if (fKeystreamPos == kKeystreamBytes)
+            IGenerateKeystream();
+
+        size_t count = std::min(bytes, kKeystreamBytes - fKeystreamPos);
+        xor_block.call(buf, fKeystream + fKeystreamPos, count);
+        fKeystreamPos += count;
+        buf += count;
+        bytes -= count;
+    }
+}
+
+void plRC4::xor_block_fpu(uint8_t* data, const uint8_t* keystream, size_t bytes)
+{
+    for (size_t i = 0; i < bytes; ++i)
+        data[i] ^= keystream[i];
+}
+
+// CPU-optimized functions requiring dispatch
+hsCpuFunctionDispatcher<plRC4::xor_block_ptr> plRC4::xor_block {
+    &plRC4::xor_block_fpu,
+    nullptr,                // SSE1
+    &plRC4::xor_block_sse2,
+    nullptr,                // SSE3
+    nullptr,                // SSSE3
+    nullptr,                // SSE41
+    nullptr,                // SSE42
+    nullptr,                // AVX
+    &plRC4::xor_block_avx2
+};
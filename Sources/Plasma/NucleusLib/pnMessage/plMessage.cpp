@@ -55,6 +55,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 plMessage::plMessage()
 :   fBCastFlags(kLocalPropagate),
     fTimeStamp(),
+    fQueueNext(),
     fNetRcvrPlayerIDs(),
     dispatchBreak()
 {
@@ -64,6 +65,7 @@ plMessage::plMessage(const plKey &s,
             const plKey &r, 
             const double* t)
 :   fSender(s),
+    fQueueNext(),
     fBCastFlags(kLocalPropagate),
     fNetRcvrPlayerIDs(),
     dispatchBreak()
@@ -94,6 +94,11 @@ private:
     std::vector<plKey>      fReceivers;
     double                  fTimeStamp;
 
+    // Link for plDispatch::MsgQueue, non-null while the message is waiting
+    // there. A message may only be in that queue once at a time, so don't
+    // MsgQueue it again until it has been sent.
+    plMessage*              fQueueNext;
+
 protected:
     uint32_t                  fBCastFlags;
     std::vector<uint32_t>*    fNetRcvrPlayerIDs;
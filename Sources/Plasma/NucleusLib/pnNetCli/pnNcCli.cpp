@@ -144,6 +144,7 @@ struct NetCli {
 
     // Message buffers
     uint8_t                    sendBuffer[kAsyncSocketBufferSize];
+    std::vector<uint8_t>       sendOversize;   // encrypted copy of payloads too big for sendBuffer
     std::vector<uint8_t>       recvBuffer;
 
     NetCli()
@@ -172,10 +173,7 @@ namespace pnNetCli {
 ***/
 
 //============================================================================
-static void PutBufferOnWire (NetCli * cli, void * data, unsigned bytes) {
-
-    uint8_t * temp = nullptr;
-
+static void LogBufferOnWire (NetCli * cli, const void * data, unsigned bytes) {
 #if !defined(PLASMA_EXTERNAL_RELEASE) && defined(HS_BUILD_FOR_WIN32)
     // Write to the netlog
     if (s_netlog) {
@@ -191,19 +189,22 @@ static void PutBufferOnWire (NetCli * cli, void * data, unsigned bytes) {
         WriteFile(s_netlog, data, bytes, &bytesWritten, nullptr);
     }
 #endif // PLASMA_EXTERNAL_RELEASE
+}
+
+//============================================================================
+static inline bool IsSendEncrypted (const NetCli * cli) {
+    return cli->mode == kNetCliModeEncrypted && cli->cryptOut;
+}
 
-    if (cli->mode == kNetCliModeEncrypted && cli->cryptOut) {
-        temp = (uint8_t *)malloc(bytes);
+//============================================================================
+// Encrypts the data in place, so it must be scratch space owned by the cli
+static void PutBufferOnWire (NetCli * cli, uint8_t * data, unsigned bytes) {
+    LogBufferOnWire(cli, data, bytes);
 
-        memcpy(temp, data, bytes);
-        CryptEncrypt(cli->cryptOut, bytes, temp);
-        data = temp;
-    }
+    if (IsSendEncrypted(cli))
+        CryptEncrypt(cli->cryptOut, bytes, data);
     if (cli->sock)
         AsyncSocketSend(cli->sock, data, bytes);
-        
-    // free heap buffer (if any)
-    free(temp);
 }
 
 //============================================================================
@@ -214,6 +215,38 @@ static void FlushSendBuffer (NetCli * cli) {
     cli->sendCurr = cli->sendBuffer;
 }
 
+//============================================================================
+// Sends whatever is in the send buffer along with an oversize payload in
+// one gathered write.  Unencrypted payloads go straight from the caller's
+// memory; encrypted ones are copied once into the cli's scratch buffer.
+static void FlushSendBufferWith (NetCli * cli, unsigned bytes, const void * data) {
+    const unsigned buffered = (unsigned)(cli->sendCurr - cli->sendBuffer);
+    LogBufferOnWire(cli, cli->sendBuffer, buffered);
+    LogBufferOnWire(cli, data, bytes);
+
+    if (IsSendEncrypted(cli)) {
+        CryptEncrypt(cli->cryptOut, buffered, cli->sendBuffer);
+
+        const uint8_t * src = (const uint8_t *)data;
+        cli->sendOversize.assign(src, src + bytes);
+        CryptEncrypt(cli->cryptOut, bytes, cli->sendOversize.data());
+        data = cli->sendOversize.data();
+    }
+
+    if (cli->sock) {
+        const AsyncSocketBuffer buffers[] = {
+            { cli->sendBuffer, buffered },
+            { data, bytes },
+        };
+        if (buffered)
+            AsyncSocketSend(cli->sock, buffers, std::size(buffers));
+        else
+            AsyncSocketSend(cli->sock, &buffers[1], 1);
+    }
+
+    cli->sendCurr = cli->sendBuffer;
+}
+
 //===========================================================================
 static void AddToSendBuffer (
     NetCli *            cli,
@@ -224,11 +257,7 @@ static void AddToSendBuffer (
 
     if (bytes > std::size(cli->sendBuffer)) {
         // Let the OS fragment oversize buffers
-        FlushSendBuffer(cli);
-        void * heap = malloc(bytes);
-        memcpy(heap, data, bytes);
-        PutBufferOnWire(cli, heap, bytes);
-        free(heap);
+        FlushSendBufferWith(cli, bytes, data);
     }
     else {
         for (;;) {
@@ -238,8 +267,7 @@ static void AddToSendBuffer (
             unsigned const copy = std::min(bytes, left);
 
             // copy the data into the buffer
-            for (unsigned i = 0; i < copy; ++i)
-                cli->sendCurr[i] = src[i];
+            memcpy(cli->sendCurr, src, copy);
             cli->sendCurr += copy;
             ASSERT(cli->sendCurr - cli->sendBuffer <= sizeof(cli->sendBuffer));
 
@@ -852,6 +880,21 @@ NetCli * NetCliConnectAccept (
     return cli;
 }
 
+//============================================================================
+NetCli * NetCliCreateReplay (
+    NetMsgChannel*      channel
+) {
+    // Skip ConnCreate, we don't want to be hooked up to the netlog pipe
+    NetMsgChannelLock(channel);
+
+    NetCli * const cli  = new NetCli;
+    cli->channel        = channel;
+    cli->mode           = kNetCliModeEncrypted;
+    ResetSendRecv(cli);
+
+    return cli;
+}
+
 //============================================================================
 void NetCliClearSocket (NetCli * cli) {
     cli->sock = nullptr;
@@ -309,6 +309,13 @@ NetCli * NetCliConnectAccept (
     const uint8_t       seedData[]      // optional
 );
 
+// Creates a NetCli with no socket that starts out past the connect and
+// encryption handshake, for feeding captured plaintext traffic straight to
+// NetCliDispatch.  Anything sent on it is dropped.
+NetCli * NetCliCreateReplay (
+    NetMsgChannel*      channel
+);
+
 void NetCliClearSocket (
     NetCli *        cli
 );
@@ -51,6 +51,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "plAudioSystem.h"
 
 #include "plAudioCore/plAudioFileReader.h"
+#include "plAudioCore/plReadAheadFileReader.h"
 #include "plAudioCore/plSoundBuffer.h"
 #include "plAudioCore/plSoundDeswizzler.h"
 #include "pnMessage/plSoundMsg.h"
@@ -185,6 +186,11 @@ plSoundBuffer::ELoadReturnVal plWin32StreamingSound::IPreLoadBuffer( bool playWh
             return plSoundBuffer::kError;
         }
 
+        // Compressed streams get decoded ahead of playback by the decoder pool, rather
+        // than on the main thread whenever OpenAL runs out of buffers
+        if (fStreamType == kStreamCompressed)
+            fDataStream = new plReadAheadFileReader(fDataStream, STREAM_BUFFER_SIZE * 4);
+
         IPrintDbgMessage(ST::format("   Readied file {} for streaming", fSrcFilename));
 
         // dont free sound data until we have a chance to use it in load sound
@@ -391,6 +397,8 @@ void plWin32StreamingSound::IStreamUpdate()
 void plWin32StreamingSound::Update()
 {
     plWin32Sound::Update();
+    if (fDataStream)
+        fDataStream->SetPriority(GetVolumeRank());
     IStreamUpdate();
 }
 
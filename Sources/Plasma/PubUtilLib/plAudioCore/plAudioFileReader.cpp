@@ -69,18 +69,18 @@ plAudioFileReader* plAudioFileReader::CreateReader(const plFileName& path, plAud
     {
         bool isWav = (ext.compare_i("wav") == 0);
         // We want to stream a wav off disk, but this is a compressed file.
-        // Get the uncompressed path. Ignore the requested channel, since it 
-        // will have already been split into two files if that is necessary.
+        // Get the uncompressed path. There's only one cache per sound, so
+        // the reader picks out the requested channel itself.
         if (!isWav)
         {
-            plFileName cachedPath = IGetCachedPath(path, whichChan);
-            plAudioFileReader *r =  new plCachedFileReader(cachedPath, plAudioCore::kAll);
+            plFileName cachedPath = IGetCachedPath(path, plAudioCore::kAll);
+            plAudioFileReader *r =  new plCachedFileReader(cachedPath, whichChan);
             if (!r->IsValid()) {
                 // So we tried to play a cached file and it didn't exist
                 // Oops... we should cache it now
                 delete r;
-                ICacheFile(path, true, whichChan);
-                r = new plCachedFileReader(cachedPath, plAudioCore::kAll);
+                ICacheFile(path, true, plAudioCore::kAll);
+                r = new plCachedFileReader(cachedPath, whichChan);
             }
             return r;
         }
@@ -159,13 +159,7 @@ void plAudioFileReader::ICacheFile(const plFileName& path, bool noOverwrite, plA
 
 void plAudioFileReader::CacheFile(const plFileName& path, bool splitChannels, bool noOverwrite)
 {
-    if (splitChannels)
-    {
-        ICacheFile(path, noOverwrite, plAudioCore::kLeft);
-        ICacheFile(path, noOverwrite, plAudioCore::kRight);
-    }
-    else
-    {
-        ICacheFile(path, noOverwrite, plAudioCore::kAll);
-    }
+    // Split channels are read out of the one cache, so we don't need a file
+    // per channel any more
+    ICacheFile(path, noOverwrite, plAudioCore::kAll);
 }
@@ -85,6 +85,9 @@ public:
 
     virtual bool    IsValid() = 0;
 
+    // How audible the sound reading from us is, for readers that decode ahead
+    virtual void    SetPriority(float priority) {}
+
     static plAudioFileReader* CreateReader(const plFileName& path, plAudioCore::ChannelSelect whichChan = plAudioCore::kAll, StreamType type = kStreamWAV);
     static plAudioFileReader* CreateWriter(const plFileName& path, plWAVHeader& header);
 
@@ -47,26 +47,271 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 //// NOTES ///////////////////////////////////////////////////////////////////
 //                                                                          //
 //  2011.04.24 - Created by dpogue.                                         //
+//  Caches are now stored as independently compressed blocks of PCM with an //
+//  offset table, so they can be mapped and seeked into directly. Old raw   //
+//  WAV caches are still readable.                                          //
 //                                                                          //
 //////////////////////////////////////////////////////////////////////////////
 
 #include "HeadSpin.h"
 #include "plCachedFileReader.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+//// Cache File Format ///////////////////////////////////////////////////////
+//  header:  magic, version, plWAVHeader, data length, block size, block
+//           count, offset of the block table
+//  blocks:  each one is kBlockBytes of PCM (less for the last one), stored
+//           either raw or as fixed-predictor residuals packed as Rice codes
+//           (think FLAC, minus everything we don't need)
+//  table:   file offset of each block, plus one for the end of the last one
+//
+//  Blocks don't depend on each other, so seeking only ever decodes one.
+
+static const char       kCacheMagic[4] = { 'P', 'L', 'S', 'C' };
+static const uint32_t   kCacheVersion = 1;
+static const uint32_t   kBlockBytes = 64 * 1024;
+
+struct plCacheFileHeader
+{
+    char        fMagic[4];
+    uint32_t    fVersion;
+    plWAVHeader fWAVHeader;
+    uint32_t    fDataLength;
+    uint32_t    fBlockBytes;
+    uint32_t    fNumBlocks;
+    uint32_t    fTableOffset;
+};
+
+// Max predictor order, and how many unary bits we write before giving up and
+// storing a residual raw
+static const int        kMaxOrder = 2;
+static const uint32_t   kMaxRiceParam = 20;
+static const uint32_t   kRiceEscape = 24;
+static const uint32_t   kEscapeBits = 20;
+
+//// Rice Coding /////////////////////////////////////////////////////////////
+
+class plBitWriter
+{
+    std::vector<uint8_t>& fOut;
+    uint64_t fBits;
+    uint32_t fCount;
+
+public:
+    plBitWriter(std::vector<uint8_t>& out) : fOut(out), fBits(), fCount() { }
+
+    void Write(uint32_t value, uint32_t numBits)
+    {
+        fBits = (fBits << numBits) | (value & ((uint64_t(1) << numBits) - 1));
+        fCount += numBits;
+        while (fCount >= 8) {
+            fCount -= 8;
+            fOut.push_back(uint8_t(fBits >> fCount));
+        }
+    }
+
+    void Flush()
+    {
+        if (fCount)
+            fOut.push_back(uint8_t(fBits << (8 - fCount)));
+        fCount = 0;
+    }
+};
+
+class plBitReader
+{
+    const uint8_t* fData;
+    const uint8_t* fEnd;
+    uint64_t fBits;
+    uint32_t fCount;
+
+    void IRefill()
+    {
+        while (fCount <= 56) {
+            fBits = (fBits << 8) | (fData < fEnd ? *fData++ : 0);
+            fCount += 8;
+        }
+    }
+
+public:
+    plBitReader(const uint8_t* data, const uint8_t* end) : fData(data), fEnd(end), fBits(), fCount() { }
+
+    uint32_t Read(uint32_t numBits)
+    {
+        if (fCount < numBits)
+            IRefill();
+        fCount -= numBits;
+        return uint32_t(fBits >> fCount) & uint32_t((uint64_t(1) << numBits) - 1);
+    }
+
+    bool ReadBit()
+    {
+        return Read(1) != 0;
+    }
+};
+
+static inline uint32_t IZigZag(int32_t value) { return (uint32_t(value) << 1) ^ uint32_t(value >> 31); }
+static inline int32_t IUnZigZag(uint32_t value) { return int32_t(value >> 1) ^ -int32_t(value & 1); }
+
+static inline int32_t IPredict(const int32_t* samples, size_t i, int order)
+{
+    switch (order) {
+    case 1:  return samples[i - 1];
+    case 2:  return 2 * samples[i - 1] - samples[i - 2];
+    default: return 0;
+    }
+}
+
+void plCachedFileReader::EncodeBlock(const uint8_t* pcm, uint32_t bytes, const plWAVHeader& header, std::vector<uint8_t>& out)
+{
+    out.clear();
+
+    uint32_t numChannels = header.fNumChannels;
+    bool canCompress = header.fBitsPerSample == 16 && numChannels > 0 && numChannels <= 8 &&
+                       bytes % (2 * numChannels) == 0;
+    if (canCompress) {
+        size_t numFrames = bytes / (2 * numChannels);
+        std::vector<int32_t> samples(numFrames);
+        std::vector<uint32_t> residuals(numFrames);
+
+        out.push_back(kBlockRice);
+        size_t paramsAt = out.size();
+        out.resize(out.size() + 2 * numChannels);
+
+        plBitWriter bits(out);
+        for (uint32_t ch = 0; ch < numChannels; ++ch) {
+            for (size_t i = 0; i < numFrames; ++i) {
+                int16_t sample;
+                memcpy(&sample, pcm + (i * numChannels + ch) * 2, sizeof(sample));
+                samples[i] = sample;
+            }
+
+            // Pick whichever predictor leaves the smallest residuals...
+            int order = 0;
+            uint64_t bestSum = UINT64_MAX;
+            for (int o = 0; o <= kMaxOrder && size_t(o) < numFrames; ++o) {
+                uint64_t sum = 0;
+                for (size_t i = o; i < numFrames; ++i)
+                    sum += std::abs(samples[i] - IPredict(samples.data(), i, o));
+                if (sum < bestSum) {
+                    bestSum = sum;
+                    order = o;
+                }
+            }
+
+            // ...and the Rice parameter that packs them tightest
+            uint32_t param = 0;
+            uint64_t bestCost = UINT64_MAX;
+            for (size_t i = order; i < numFrames; ++i)
+                residuals[i] = IZigZag(samples[i] - IPredict(samples.data(), i, order));
+            for (uint32_t k = 0; k <= kMaxRiceParam; ++k) {
+                uint64_t cost = 0;
+                for (size_t i = order; i < numFrames; ++i) {
+                    uint32_t q = residuals[i] >> k;
+                    cost += (q < kRiceEscape) ? q + 1 + k : kRiceEscape + kEscapeBits;
+                }
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    param = k;
+                }
+            }
+
+            out[paramsAt + 2 * ch] = uint8_t(order);
+            out[paramsAt + 2 * ch + 1] = uint8_t(param);
+
+            for (int i = 0; i < order && size_t(i) < numFrames; ++i)
+                bits.Write(uint16_t(samples[i]), 16);
+            for (size_t i = order; i < numFrames; ++i) {
+                uint32_t q = residuals[i] >> param;
+                if (q < kRiceEscape) {
+                    for (uint32_t j = 0; j < q; ++j)
+                        bits.Write(1, 1);
+                    bits.Write(0, 1);
+                    bits.Write(residuals[i], param);
+                } else {
+                    bits.Write((1 << kRiceEscape) - 1, kRiceEscape);
+                    bits.Write(residuals[i], kEscapeBits);
+                }
+            }
+        }
+        bits.Flush();
+
+        // Noise doesn't compress, so don't bother
+        if (out.size() < bytes + 1)
+            return;
+        out.clear();
+    }
+
+    out.push_back(kBlockRaw);
+    out.insert(out.end(), pcm, pcm + bytes);
+}
+
+bool plCachedFileReader::DecodeBlock(const uint8_t* src, uint32_t srcBytes, const plWAVHeader& header, uint8_t* pcm, uint32_t bytes)
+{
+    if (srcBytes < 1)
+        return false;
+
+    if (src[0] == kBlockRaw) {
+        if (srcBytes - 1 < bytes)
+            return false;
+        memcpy(pcm, src + 1, bytes);
+        return true;
+    }
+
+    uint32_t numChannels = header.fNumChannels;
+    if (src[0] != kBlockRice || header.fBitsPerSample != 16 || srcBytes < 1 + 2 * numChannels)
+        return false;
+
+    size_t numFrames = bytes / (2 * numChannels);
+    std::vector<int32_t> samples(numFrames);
+    const uint8_t* params = src + 1;
+    plBitReader bits(params + 2 * numChannels, src + srcBytes);
+
+    for (uint32_t ch = 0; ch < numChannels; ++ch) {
+        int order = params[2 * ch];
+        uint32_t param = params[2 * ch + 1];
+        if (order > kMaxOrder || param > kMaxRiceParam)
+            return false;
+
+        for (int i = 0; i < order && size_t(i) < numFrames; ++i)
+            samples[i] = int16_t(bits.Read(16));
+        for (size_t i = order; i < numFrames; ++i) {
+            uint32_t q = 0;
+            while (q < kRiceEscape && bits.ReadBit())
+                ++q;
+            uint32_t residual = (q < kRiceEscape) ? (q << param) | bits.Read(param) : bits.Read(kEscapeBits);
+            samples[i] = IPredict(samples.data(), i, order) + IUnZigZag(residual);
+        }
+
+        for (size_t i = 0; i < numFrames; ++i) {
+            int16_t sample = int16_t(samples[i]);
+            memcpy(pcm + (i * numChannels + ch) * 2, &sample, sizeof(sample));
+        }
+    }
+    return true;
+}
+
 //// Constructor/Destructor //////////////////////////////////////////////////
 
 plCachedFileReader::plCachedFileReader(const plFileName &path,
                                        plAudioCore::ChannelSelect whichChan)
-    : fFilename(path), fFileHandle(), fCurPosition(), fHeader(),
-      fDataLength()       
+    : fFilename(path), fFileHandle(), fHeader(), fFileHeader(),
+      fWhichChan(whichChan), fDataLength(), fCurPosition(), fWriting(),
+      fBlockBytes(), fBlockOffsets(), fCurBlock(UINT32_MAX)
 {
     hsAssert(path.IsValid(), "Invalid path specified in plCachedFileReader");
 
-    /// Open the file as a plain binary stream
+    if (IOpenCompressed())
+        return;
+
+    /// Not one of ours, so try it as an old raw WAV cache
     fFileHandle = plFileSystem::Open(path, "rb");
     if (fFileHandle != nullptr)
     {
-        if (fread(&fHeader, 1, sizeof(plWAVHeader), fFileHandle)
+        if (fread(&fFileHeader, 1, sizeof(plWAVHeader), fFileHandle)
                 != sizeof(plWAVHeader))
         {
             IError("Invalid WAV file header in plCachedFileReader");
@@ -74,7 +319,7 @@ plCachedFileReader::plCachedFileReader(const plFileName &path,
         }
 
         // Check format
-        if (fHeader.fFormatTag != kPCMFormatTag)
+        if (fFileHeader.fFormatTag != kPCMFormatTag)
         {
             IError("Invalid format in plCachedFileReader");
             return;
@@ -84,14 +329,50 @@ plCachedFileReader::plCachedFileReader(const plFileName &path,
         fDataLength = ftell(fFileHandle) - sizeof(plWAVHeader);
 
         fseek(fFileHandle, sizeof(plWAVHeader), SEEK_SET);
+        fHeader = fFileHeader;
     }
 }
 
 plCachedFileReader::~plCachedFileReader()
 {
-    if (fFileHandle != nullptr) {
-        fclose(fFileHandle);
+    Close();
+}
+
+bool plCachedFileReader::IOpenCompressed()
+{
+    if (!fMapped.Open(fFilename))
+        return false;
+
+    const uint8_t* data = fMapped.GetData();
+    uint32_t size = fMapped.GetEOF();
+
+    plCacheFileHeader header;
+    if (size < sizeof(header))
+    {
+        fMapped.Close();
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+
+    if (memcmp(header.fMagic, kCacheMagic, sizeof(kCacheMagic)) != 0 ||
+        header.fVersion != kCacheVersion ||
+        header.fWAVHeader.fFormatTag != kPCMFormatTag ||
+        header.fBlockBytes == 0 ||
+        header.fNumBlocks != (header.fDataLength + header.fBlockBytes - 1) / header.fBlockBytes ||
+        header.fTableOffset % sizeof(uint32_t) != 0 ||
+        header.fTableOffset > size ||
+        (size - header.fTableOffset) / sizeof(uint32_t) < header.fNumBlocks + 1)
+    {
+        fMapped.Close();
+        return false;
     }
+
+    fFileHeader = header.fWAVHeader;
+    fHeader = fFileHeader;
+    fDataLength = header.fDataLength;
+    fBlockBytes = header.fBlockBytes;
+    fBlockOffsets = reinterpret_cast<const uint32_t*>(data + header.fTableOffset);
+    return true;
 }
 
 void plCachedFileReader::IError(const char *msg)
@@ -104,53 +385,146 @@ plWAVHeader &plCachedFileReader::GetHeader()
 {
     hsAssert(IsValid(), "GetHeader() called on an invalid cache file");
 
+    // We store every channel, and split out the one we want on the fly
+    if (IChannelScale() > 1)
+    {
+        fHeader = fFileHeader;
+        fHeader.fNumChannels = 1;
+        fHeader.fBlockAlign /= fFileHeader.fNumChannels;
+        fHeader.fAvgBytesPerSec /= fFileHeader.fNumChannels;
+    }
     return fHeader;
 }
 
 void plCachedFileReader::Close()
 {
+    if (fWriting)
+        IFinishWriting();
+
     if (fFileHandle != nullptr)
     {
         fclose(fFileHandle);
         fFileHandle = nullptr;
     }
+
+    fMapped.Close();
+    fBlockOffsets = nullptr;
+    fCurBlock = UINT32_MAX;
+}
+
+uint32_t plCachedFileReader::IChannelScale() const
+{
+    if (fWhichChan == plAudioCore::kAll || fFileHeader.fNumChannels < 2)
+        return 1;
+    return fFileHeader.fNumChannels;
 }
 
 uint32_t plCachedFileReader::GetDataSize()
 {
     hsAssert(IsValid(), "GetDataSize() called on an invalid cache file");
 
-    return fDataLength;
+    return fDataLength / IChannelScale();
 }
 
 float plCachedFileReader::GetLengthInSecs()
 {
     hsAssert(IsValid(), "GetLengthInSecs() called on an invalid cache file");
 
-    return (float)fDataLength / (float)fHeader.fAvgBytesPerSec;
+    return (float)fDataLength / (float)fFileHeader.fAvgBytesPerSec;
 }
 
 bool plCachedFileReader::SetPosition(uint32_t numBytes)
 {
     hsAssert(IsValid(), "SetPosition() called on an invalid cache file");
 
-    fCurPosition = numBytes;
+    fCurPosition = numBytes * IChannelScale();
 
     hsAssert(fCurPosition <= fDataLength, "Invalid position while seeking");
 
-    return !fseek(fFileHandle, sizeof(plWAVHeader) + fCurPosition, SEEK_SET);
+    if (fFileHandle != nullptr)
+        return !fseek(fFileHandle, sizeof(plWAVHeader) + fCurPosition, SEEK_SET);
+    return fCurPosition <= fDataLength;
+}
+
+bool plCachedFileReader::IReadFileData(uint32_t numBytes, uint8_t *buffer)
+{
+    if (fFileHandle != nullptr)
+    {
+        size_t numRead = fread(buffer, 1, numBytes, fFileHandle);
+
+        fCurPosition += numRead;
+        hsAssert(fCurPosition <= fDataLength, "Invalid position while reading");
+
+        return numRead >= numBytes;
+    }
+
+    const uint8_t* data = fMapped.GetData();
+    while (numBytes > 0 && fCurPosition < fDataLength)
+    {
+        uint32_t block = fCurPosition / fBlockBytes;
+        uint32_t blockStart = block * fBlockBytes;
+        uint32_t blockSize = std::min(fBlockBytes, fDataLength - blockStart);
+
+        if (block != fCurBlock)
+        {
+            uint32_t start = fBlockOffsets[block];
+            uint32_t end = fBlockOffsets[block + 1];
+            fBlock.resize(blockSize);
+            if (start > end || end > fMapped.GetEOF() ||
+                !DecodeBlock(data + start, end - start, fFileHeader, fBlock.data(), blockSize))
+            {
+                fCurBlock = UINT32_MAX;
+                hsAssert(false, "Corrupt block in sound cache");
+                return false;
+            }
+            fCurBlock = block;
+        }
+
+        uint32_t offset = fCurPosition - blockStart;
+        uint32_t count = std::min(numBytes, blockSize - offset);
+        memcpy(buffer, fBlock.data() + offset, count);
+
+        buffer += count;
+        numBytes -= count;
+        fCurPosition += count;
+    }
+
+    return numBytes == 0;
 }
 
 bool plCachedFileReader::Read(uint32_t numBytes, void *buffer)
 {
     hsAssert(IsValid(), "Read() called on an invalid cache file");
 
-    size_t numRead = fread(buffer, 1, numBytes, fFileHandle);
+    uint8_t* out = reinterpret_cast<uint8_t*>(buffer);
+    uint32_t scale = IChannelScale();
+    if (scale == 1)
+        return IReadFileData(numBytes, out);
 
-    fCurPosition += numRead;
-    hsAssert(fCurPosition <= fDataLength, "Invalid position while reading");
+    // Pull out just the channel we want
+    uint32_t sampleBytes = fFileHeader.fBitsPerSample / 8;
+    uint32_t frameBytes = fFileHeader.fBlockAlign;
+    uint32_t channel = (fWhichChan == plAudioCore::kLeft) ? 0 : 1;
+
+    hsAssert(numBytes % sampleBytes == 0, "Split channel reads must be whole samples");
+    if (numBytes % sampleBytes != 0)
+        return false;
 
-    return numRead >= numBytes;
+    uint8_t frames[4096];
+    uint32_t framesPerRead = sizeof(frames) / frameBytes;
+    while (numBytes > 0)
+    {
+        uint32_t numFrames = std::min(numBytes / sampleBytes, framesPerRead);
+        if (!IReadFileData(numFrames * frameBytes, frames))
+            return false;
+
+        for (uint32_t i = 0; i < numFrames; ++i)
+            memcpy(out + i * sampleBytes, frames + i * frameBytes + channel * sampleBytes, sampleBytes);
+        out += numFrames * sampleBytes;
+        numBytes -= numFrames * sampleBytes;
+    }
+
+    return true;
 }
 
 uint32_t plCachedFileReader::NumBytesLeft()
@@ -158,42 +532,113 @@ uint32_t plCachedFileReader::NumBytesLeft()
     hsAssert(IsValid(), "NumBytesLeft() called on an invalid cache file");
     hsAssert(fCurPosition <= fDataLength, "Invalid position while reading");
 
-    return fDataLength - fCurPosition;
+    return (fDataLength - fCurPosition) / IChannelScale();
 }
 
+//// Writing /////////////////////////////////////////////////////////////////
+
 bool plCachedFileReader::OpenForWriting(const plFileName &path, plWAVHeader &header)
 {
     hsAssert(path.IsValid(), "Invalid path specified in plCachedFileReader");
 
+    // We may have opened an old copy for reading, and it can't stay mapped
+    // while we replace it
+    Close();
+
     fHeader = header;
+    fFileHeader = header;
+    fWhichChan = plAudioCore::kAll;
     fCurPosition = 0;
     fDataLength = 0;
     fFilename = path;
+    fBlockBytes = kBlockBytes;
+    fBlock.clear();
+    fWrittenOffsets.clear();
 
     /// Open the file as a plain binary stream
     fFileHandle = plFileSystem::Open(path, "wb");
 
     if (fFileHandle != nullptr)
     {
-        if (fwrite(&fHeader, 1, sizeof(plWAVHeader), fFileHandle)
-                != sizeof(plWAVHeader))
+        // Placeholder, until we know how many blocks there are
+        plCacheFileHeader fileHeader{};
+        if (fwrite(&fileHeader, 1, sizeof(fileHeader), fFileHandle)
+                != sizeof(fileHeader))
         {
-            IError("Could not write WAV file header in plCachedFileReader");
+            IError("Could not write cache file header in plCachedFileReader");
             return false;
         }
+        fWrittenOffsets.push_back(sizeof(fileHeader));
+        fWriting = true;
     }
 
     return fFileHandle != nullptr;
 }
 
+bool plCachedFileReader::IWriteBlock(const uint8_t *pcm, uint32_t bytes)
+{
+    std::vector<uint8_t> encoded;
+    EncodeBlock(pcm, bytes, fFileHeader, encoded);
+    if (fwrite(encoded.data(), 1, encoded.size(), fFileHandle) != encoded.size())
+        return false;
+
+    fWrittenOffsets.push_back(fWrittenOffsets.back() + (uint32_t)encoded.size());
+    return true;
+}
+
 uint32_t plCachedFileReader::Write(uint32_t bytes, void* buffer)
 {
-    hsAssert(IsValid(), "Write() called on an invalid cache file");
+    hsAssert(IsValid() && fWriting, "Write() called on an invalid cache file");
+
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(buffer);
+    uint32_t written = 0;
+    while (written < bytes)
+    {
+        uint32_t count = std::min(bytes - written, fBlockBytes - (uint32_t)fBlock.size());
+        fBlock.insert(fBlock.end(), data + written, data + written + count);
+        written += count;
 
-    size_t written = fwrite(buffer, 1, bytes, fFileHandle);
+        if (fBlock.size() == fBlockBytes)
+        {
+            if (!IWriteBlock(fBlock.data(), fBlockBytes))
+                break;
+            fBlock.clear();
+        }
+    }
 
     fCurPosition += written;
     fDataLength += written;
 
-    return (uint32_t)written;
+    return written;
+}
+
+void plCachedFileReader::IFinishWriting()
+{
+    fWriting = false;
+
+    if (!fBlock.empty())
+        IWriteBlock(fBlock.data(), (uint32_t)fBlock.size());
+    fBlock.clear();
+
+    // Keep the table aligned so it can be used straight out of a mapping
+    uint32_t tableOffset = fWrittenOffsets.back();
+    static const uint8_t padding[sizeof(uint32_t)] = {};
+    uint32_t padBytes = (sizeof(uint32_t) - tableOffset % sizeof(uint32_t)) % sizeof(uint32_t);
+    fwrite(padding, 1, padBytes, fFileHandle);
+    tableOffset += padBytes;
+
+    fwrite(fWrittenOffsets.data(), sizeof(uint32_t), fWrittenOffsets.size(), fFileHandle);
+
+    plCacheFileHeader fileHeader;
+    memcpy(fileHeader.fMagic, kCacheMagic, sizeof(kCacheMagic));
+    fileHeader.fVersion = kCacheVersion;
+    fileHeader.fWAVHeader = fFileHeader;
+    fileHeader.fDataLength = fDataLength;
+    fileHeader.fBlockBytes = fBlockBytes;
+    fileHeader.fNumBlocks = (uint32_t)fWrittenOffsets.size() - 1;
+    fileHeader.fTableOffset = tableOffset;
+
+    fseek(fFileHandle, 0, SEEK_SET);
+    fwrite(&fileHeader, 1, sizeof(fileHeader), fFileHandle);
+    fWrittenOffsets.clear();
 }
@@ -47,6 +47,9 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 //// NOTES ///////////////////////////////////////////////////////////////////
 //                                                                          //
 //  2011.04.24 - Created by dpogue.                                         //
+//  Caches are now stored as independently compressed blocks of PCM with an //
+//  offset table, so they can be mapped and seeked into directly. Old raw   //
+//  WAV caches are still readable.                                          //
 //                                                                          //
 //////////////////////////////////////////////////////////////////////////////
 
@@ -55,6 +58,9 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 #include "plAudioFileReader.h"
 #include "plFileSystem.h"
+#include "hsStream.h"
+
+#include <vector>
 
 //// Class Definition ////////////////////////////////////////////////////////
 
@@ -79,7 +85,19 @@ public:
     bool    OpenForWriting(const plFileName &path, plWAVHeader &header) override;
     uint32_t  Write(uint32_t bytes, void *buffer) override;
 
-    bool    IsValid() override { return fFileHandle != nullptr; }
+    bool    IsValid() override { return fFileHandle != nullptr || fMapped.GetData() != nullptr; }
+
+    // How each block of a compressed cache is stored
+    enum BlockType : uint8_t
+    {
+        kBlockRaw,
+        kBlockRice,
+    };
+
+    // Packs one block of PCM into out, falling back to raw when it doesn't
+    // shrink, and unpacks it again. Public so the codec can be tested alone.
+    static void EncodeBlock(const uint8_t* pcm, uint32_t bytes, const plWAVHeader& header, std::vector<uint8_t>& out);
+    static bool DecodeBlock(const uint8_t* src, uint32_t srcBytes, const plWAVHeader& header, uint8_t* pcm, uint32_t bytes);
 
 protected:
     enum
@@ -88,12 +106,28 @@ protected:
     };
 
     plFileName      fFilename;
-    FILE *          fFileHandle;
-    plWAVHeader     fHeader;
-    uint32_t        fDataLength;
-    uint32_t        fCurPosition;
+    FILE *          fFileHandle;    // Writing, or reading an old raw cache
+    hsMappedStream  fMapped;        // Reading a block compressed cache
+    plWAVHeader     fHeader;        // What we hand out (one channel, if we're splitting)
+    plWAVHeader     fFileHeader;    // What's actually in the file
+    plAudioCore::ChannelSelect fWhichChan;
+    uint32_t        fDataLength;    // In the file's layout
+    uint32_t        fCurPosition;   // In the file's layout
+
+    // Block compressed caches
+    bool            fWriting;
+    uint32_t        fBlockBytes;
+    const uint32_t* fBlockOffsets;  // Into the mapping, one past the end for the last block
+    std::vector<uint32_t> fWrittenOffsets;
+    std::vector<uint8_t>  fBlock;   // Decoded block when reading, pending PCM when writing
+    uint32_t        fCurBlock;
 
     void IError(const char *msg);
+    bool IOpenCompressed();
+    bool IReadFileData(uint32_t numBytes, uint8_t *buffer);
+    bool IWriteBlock(const uint8_t *pcm, uint32_t bytes);
+    void IFinishWriting();
+    uint32_t IChannelScale() const;
 };
 
 #endif //_plcachedfilereader_h
@@ -0,0 +1,303 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+//////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+//  plReadAheadFileReader - Wraps another reader (usually an Ogg) and       //
+//                          keeps a ring buffer of its output filled ahead  //
+//                          of playback from a small pool of decoder        //
+//                          threads, so streaming sounds don't decode on    //
+//                          the main thread.                                //
+//                                                                          //
+//////////////////////////////////////////////////////////////////////////////
+
+#include "HeadSpin.h"
+#include "plReadAheadFileReader.h"
+#include "hsThread.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// Decode in chunks about the size of one streaming buffer
+static constexpr uint32_t kDecodeChunk = 16 * 1024;
+
+// Total ring memory shared by every read-ahead stream
+static constexpr size_t kMaxReadAheadBytes = 8 * 1024 * 1024;
+
+struct plReadAheadDecoderPool
+{
+    std::mutex fMutex;
+    std::condition_variable fWake;
+    std::vector<plReadAheadFileReader*> fReaders;
+    std::vector<std::thread> fThreads;
+    size_t fRingBytes = 0;
+    bool fRunning = false;
+};
+
+static plReadAheadDecoderPool gDecoderPool;
+
+//// Constructor/Destructor //////////////////////////////////////////////////
+
+plReadAheadFileReader::plReadAheadFileReader(plAudioFileReader* source, uint32_t aheadBytes)
+    : fSource(source), fRingSize(), fWritten(), fConsumed(), fSourceDone(), fPriority()
+{
+    fDataSize = fSource->GetDataSize();
+    fPosition = fDataSize - fSource->NumBytesLeft();
+
+    uint32_t ringSize = kDecodeChunk;
+    while (ringSize < aheadBytes)
+        ringSize <<= 1;
+
+    hsLockGuard(gDecoderPool.fMutex);
+    if (gDecoderPool.fRingBytes + ringSize <= kMaxReadAheadBytes)
+    {
+        fRing = std::make_unique<uint8_t[]>(ringSize);
+        fRingSize = ringSize;
+        gDecoderPool.fRingBytes += ringSize;
+        gDecoderPool.fReaders.emplace_back(this);
+        // Idle decoders sleep without a timeout, so get all of them going again
+        gDecoderPool.fWake.notify_all();
+    }
+}
+
+plReadAheadFileReader::~plReadAheadFileReader()
+{
+    {
+        hsLockGuard(gDecoderPool.fMutex);
+        auto it = std::find(gDecoderPool.fReaders.begin(), gDecoderPool.fReaders.end(), this);
+        if (it != gDecoderPool.fReaders.end())
+        {
+            gDecoderPool.fReaders.erase(it);
+            gDecoderPool.fRingBytes -= fRingSize;
+        }
+    }
+
+    // Decoders only pick us up under the pool lock, so once we're off the
+    // list, this just waits out anyone who's still mid-decode
+    hsLockGuard(fDecodeMutex);
+}
+
+//// Reading /////////////////////////////////////////////////////////////////
+
+void plReadAheadFileReader::Close()
+{
+    hsLockGuard(fDecodeMutex);
+    fSource->Close();
+}
+
+bool plReadAheadFileReader::SetPosition(uint32_t numBytes)
+{
+    hsLockGuard(fDecodeMutex);
+
+    // Throw away whatever we decoded ahead
+    fConsumed.store(fWritten.load(std::memory_order_relaxed), std::memory_order_release);
+    fSourceDone.store(false, std::memory_order_relaxed);
+
+    bool result = fSource->SetPosition(numBytes);
+    fPosition = fDataSize - fSource->NumBytesLeft();
+    gDecoderPool.fWake.notify_one();
+    return result;
+}
+
+uint32_t plReadAheadFileReader::IPop(uint8_t* buffer, uint32_t numBytes)
+{
+    if (!fRingSize)
+        return 0;
+
+    uint32_t consumed = fConsumed.load(std::memory_order_relaxed);
+    uint32_t available = fWritten.load(std::memory_order_acquire) - consumed;
+    uint32_t count = std::min(numBytes, available);
+
+    uint32_t offset = consumed & (fRingSize - 1);
+    uint32_t first = std::min(count, fRingSize - offset);
+    memcpy(buffer, fRing.get() + offset, first);
+    memcpy(buffer + first, fRing.get(), count - first);
+
+    fConsumed.store(consumed + count, std::memory_order_release);
+    fPosition += count;
+    return count;
+}
+
+bool plReadAheadFileReader::Read(uint32_t numBytes, void *buffer)
+{
+    uint8_t* out = reinterpret_cast<uint8_t*>(buffer);
+    uint32_t count = IPop(out, numBytes);
+
+    if (count < numBytes)
+    {
+        // Underrun (or no ring at all). Anything the decoders finished while we
+        // waited for the lock comes first, then we decode the rest ourselves.
+        hsLockGuard(fDecodeMutex);
+        count += IPop(out + count, numBytes - count);
+        if (count < numBytes)
+        {
+            bool result = fSource->Read(numBytes - count, out + count);
+            fPosition = fDataSize - fSource->NumBytesLeft();
+            if (!result)
+                return false;
+        }
+    }
+
+    if (fRingSize && IFreeSpace() >= fRingSize / 2)
+        gDecoderPool.fWake.notify_one();
+    return true;
+}
+
+//// Decoding ////////////////////////////////////////////////////////////////
+
+// fDecodeMutex must be held
+void plReadAheadFileReader::IDecodeAhead()
+{
+    uint32_t written = fWritten.load(std::memory_order_relaxed);
+    uint32_t count = std::min({ IFreeSpace(), fSource->NumBytesLeft(), kDecodeChunk });
+    if (count == 0)
+    {
+        fSourceDone.store(fSource->NumBytesLeft() == 0, std::memory_order_relaxed);
+        return;
+    }
+
+    uint32_t offset = written & (fRingSize - 1);
+    uint32_t first = std::min(count, fRingSize - offset);
+    bool result = fSource->Read(first, fRing.get() + offset);
+    if (result && count > first)
+        result = fSource->Read(count - first, fRing.get());
+
+    if (!result)
+    {
+        // Leave it to the consumer to hit the error for itself
+        fSourceDone.store(true, std::memory_order_relaxed);
+        return;
+    }
+
+    fWritten.store(written + count, std::memory_order_release);
+    fSourceDone.store(fSource->NumBytesLeft() == 0, std::memory_order_relaxed);
+}
+
+void plReadAheadFileReader::IDecoderThread()
+{
+    hsThread::SetThisThreadName(ST_LITERAL("SoundDecoder"));
+
+    // Priority and free space keep changing under us, so sort on a snapshot
+    // of them, or the ordering isn't consistent while std::sort is running.
+    struct Candidate
+    {
+        float                   fPriority;
+        uint32_t                fFreeSpace;
+        plReadAheadFileReader*  fReader;
+    };
+    std::vector<Candidate> wanted;
+    std::unique_lock<std::mutex> lock(gDecoderPool.fMutex);
+    while (gDecoderPool.fRunning)
+    {
+        // Most audible first, then whoever is closest to running dry
+        wanted.clear();
+        for (plReadAheadFileReader* reader : gDecoderPool.fReaders)
+        {
+            if (reader->fSourceDone.load(std::memory_order_relaxed))
+                continue;
+            uint32_t freeSpace = reader->IFreeSpace();
+            if (freeSpace >= kDecodeChunk)
+                wanted.push_back({ reader->fPriority.load(std::memory_order_relaxed), freeSpace, reader });
+        }
+        std::sort(wanted.begin(), wanted.end(),
+            [](const Candidate& a, const Candidate& b) {
+                if (a.fPriority != b.fPriority)
+                    return a.fPriority > b.fPriority;
+                return a.fFreeSpace > b.fFreeSpace;
+            });
+
+        // Skip anyone who is busy with another decoder or underrunning on the
+        // main thread; we'll get back to them
+        plReadAheadFileReader* reader = nullptr;
+        for (const Candidate& candidate : wanted)
+        {
+            if (candidate.fReader->fDecodeMutex.try_lock())
+            {
+                reader = candidate.fReader;
+                break;
+            }
+        }
+
+        if (!reader)
+        {
+            // Nobody to decode for at all, so sleep until a reader shows up
+            if (gDecoderPool.fReaders.empty())
+                gDecoderPool.fWake.wait(lock);
+            else
+                gDecoderPool.fWake.wait_for(lock, std::chrono::milliseconds(20));
+            continue;
+        }
+
+        lock.unlock();
+        reader->IDecodeAhead();
+        reader->fDecodeMutex.unlock();
+        lock.lock();
+    }
+}
+
+void plReadAheadFileReader::StartDecoders(size_t numThreads)
+{
+    hsLockGuard(gDecoderPool.fMutex);
+    if (gDecoderPool.fRunning)
+        return;
+
+    gDecoderPool.fRunning = true;
+    for (size_t i = 0; i < numThreads; ++i)
+        gDecoderPool.fThreads.emplace_back(hsThread::StartSimpleThread(IDecoderThread));
+}
+
+void plReadAheadFileReader::StopDecoders()
+{
+    {
+        hsLockGuard(gDecoderPool.fMutex);
+        gDecoderPool.fRunning = false;
+    }
+    gDecoderPool.fWake.notify_all();
+
+    // Any readers still around will decode for themselves from here on out
+    for (std::thread& thread : gDecoderPool.fThreads)
+        thread.join();
+    gDecoderPool.fThreads.clear();
+}
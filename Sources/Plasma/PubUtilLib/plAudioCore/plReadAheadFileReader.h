@@ -0,0 +1,109 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+//////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+//  plReadAheadFileReader - Wraps another reader (usually an Ogg) and       //
+//                          keeps a ring buffer of its output filled ahead  //
+//                          of playback from a small pool of decoder        //
+//                          threads, so streaming sounds don't decode on    //
+//                          the main thread.                                //
+//                                                                          //
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _plReadAheadFileReader_h
+#define _plReadAheadFileReader_h
+
+#include "plAudioFileReader.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+
+//// Class Definition ////////////////////////////////////////////////////////
+
+class plReadAheadFileReader : public plAudioFileReader
+{
+public:
+    // Takes ownership of source. aheadBytes is rounded up to a power of two;
+    // if the global read-ahead budget is used up, we just pass reads through.
+    plReadAheadFileReader(plAudioFileReader* source, uint32_t aheadBytes);
+    virtual ~plReadAheadFileReader();
+
+    plWAVHeader &GetHeader() override { return fSource->GetHeader(); }
+    void    Close() override;
+    uint32_t  GetDataSize() override { return fDataSize; }
+    float   GetLengthInSecs() override { return fSource->GetLengthInSecs(); }
+    bool    SetPosition(uint32_t numBytes) override;
+    bool    Read(uint32_t numBytes, void *buffer) override;
+    uint32_t  NumBytesLeft() override { return fDataSize - fPosition; }
+    bool    IsValid() override { return fSource->IsValid(); }
+    void    SetPriority(float priority) override { fPriority.store(priority, std::memory_order_relaxed); }
+
+    // Decoder pool control, called by plSoundBuffer::Init()/Shutdown()
+    static void StartDecoders(size_t numThreads = 2);
+    static void StopDecoders();
+
+protected:
+    std::unique_ptr<plAudioFileReader> fSource;
+    std::mutex  fDecodeMutex;   // Held by whoever is touching fSource
+
+    // Single producer (decoder or underrunning reader, under fDecodeMutex),
+    // single consumer (Read()). Both counters only ever increase.
+    std::unique_ptr<uint8_t[]> fRing;
+    uint32_t    fRingSize;
+    std::atomic<uint32_t> fWritten;
+    std::atomic<uint32_t> fConsumed;
+    std::atomic<bool>     fSourceDone;
+    std::atomic<float>    fPriority;
+
+    uint32_t    fDataSize;
+    uint32_t    fPosition;      // Where the consumer thinks it is in the stream
+
+    uint32_t    IFreeSpace() const { return fRingSize - (fWritten.load(std::memory_order_relaxed) - fConsumed.load(std::memory_order_acquire)); }
+    uint32_t    IPop(uint8_t* buffer, uint32_t numBytes);
+    void        IDecodeAhead();
+
+    static void IDecoderThread();
+};
+
+#endif //_plReadAheadFileReader_h
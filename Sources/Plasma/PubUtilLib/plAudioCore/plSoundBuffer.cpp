@@ -44,6 +44,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "plFileSystem.h"
 #include "hsStream.h"
 
+#include "plReadAheadFileReader.h"
 #include "plSoundBuffer.h"
 #include "plSrtFileReader.h"
 
@@ -159,10 +160,12 @@ static plSoundPreloader gLoaderThread;
 void plSoundBuffer::Init()
 {
     gLoaderThread.Init();
+    plReadAheadFileReader::StartDecoders();
 }
 
 void plSoundBuffer::Shutdown()
 {
+    plReadAheadFileReader::StopDecoders();
     gLoaderThread.Shutdown();
 }
 
@@ -276,7 +276,8 @@ inline void plCutter::ICutoutVtxMidW(const plCutoutVtx& inVtx, const plCutoutVtx
 // IPolyClip
 bool plCutter::IPolyClip(std::vector<plCutoutVtx>& poly, const hsPoint3 vPos[]) const
 {
-    static std::vector<plCutoutVtx> accum;
+    // Scratch space is per thread, since decal managers cut spans in parallel.
+    static thread_local std::vector<plCutoutVtx> accum;
     accum.clear();
 
     poly[0].fUVW.fX = vPos[0].InnerProduct(fDirU) - fDistU;
@@ -741,7 +742,7 @@ void plCutter::ICutoutTransformedConstHeight(const plAccessSpan& src, std::vecto
     for( tri.Begin(); tri.More(); tri.Advance() )
     {
         // Do a polygon clip of tri to box
-        static std::vector<plCutoutVtx> poly;
+        static thread_local std::vector<plCutoutVtx> poly;
         poly.resize(3);
 
         // Not sure about this, whether the constant water height should be world space or local.
@@ -781,7 +782,7 @@ void plCutter::ICutoutTransformed(const plAccessSpan& src, std::vector<plCutoutP
     for( tri.Begin(); tri.More(); tri.Advance() )
     {
         // Do a polygon clip of tri to box
-        static std::vector<plCutoutVtx> poly;
+        static thread_local std::vector<plCutoutVtx> poly;
         poly.resize(3);
 
         hsPoint3 vPos[3];
@@ -817,7 +818,7 @@ void plCutter::ICutoutConstHeight(const plAccessSpan& src, std::vector<plCutoutP
     for( tri.Begin(); tri.More(); tri.Advance() )
     {
         // Do a polygon clip of tri to box
-        static std::vector<plCutoutVtx> poly;
+        static thread_local std::vector<plCutoutVtx> poly;
         poly.resize(3);
 
         const hsVector3 up(0.f, 0.f, 1.f);
@@ -865,7 +866,7 @@ void plCutter::Cutout(const plAccessSpan& src, std::vector<plCutoutPoly>& dst) c
     for( tri.Begin(); tri.More(); tri.Advance() )
     {
         // Do a polygon clip of tri to box
-        static std::vector<plCutoutVtx> poly;
+        static thread_local std::vector<plCutoutVtx> poly;
         poly.resize(3);
 
         hsPoint3 vPos[3];
@@ -154,6 +154,7 @@ public:
 
     void        Set(const hsPoint3& pos, const hsVector3& dir, const hsVector3& out, bool flip=false);
 
+    // Safe to call on several spans at once from different threads.
     void        Cutout(const plAccessSpan& src, std::vector<plCutoutPoly>& dst) const;
     bool        CutoutGrid(int nWid, int nLen, plFlatGridMesh& dst) const;
 
@@ -248,10 +248,7 @@ void    plDrawableSpans::PrepForRender( plPipeline *p )
             }
         }
 #else
-        for (plParticleSpan& span : fParticleSpans)
-        {
-            plParticleFiller::FillParticles(p, this, &span);
-        }
+        plParticleFiller::FillParticleSpans(p, this, fParticleSpans);
 #endif
     }
 }
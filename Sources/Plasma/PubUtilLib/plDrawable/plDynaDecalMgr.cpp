@@ -41,6 +41,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 *==LICENSE==*/
 
 #include "HeadSpin.h"
+#include "hsParallel.h"
 #include "plDynaDecalMgr.h"
 #include "plDynaDecal.h"
 
@@ -106,6 +107,8 @@ plProfile_CreateTimerNoReset("Total", "DynaDecal", Total);
 plProfile_CreateTimerNoReset("Cutter", "DynaDecal", Cutter);
 plProfile_CreateTimerNoReset("Process", "DynaDecal", Process);
 plProfile_CreateTimerNoReset("Callback", "DynaDecal", Callback);
+plProfile_CreateCounter("Spans", "DynaDecal", DecalSpans);
+plProfile_CreateCounter("Polys", "DynaDecal", DecalPolys);
 
 static const int    kBinBlockSize = 20;
 static const uint16_t kDefMaxNumVerts = 1000;
@@ -133,6 +136,30 @@ static const float kInitAuxSpans = 5;
 
 using namespace std;
 
+// A target span the cutter's box touches, and whatever got cut out of it.
+struct plDecalCutSpan
+{
+    plDrawableSpans*            fDrawable;
+    uint32_t                    fSpanIdx;
+    plAccessSpan                fSrc;
+    std::vector<plCutoutPoly>   fPolys;
+};
+
+// The cutter only reads the source spans, so they can each be cut on their
+// own thread. Turning the cutouts into decals stays on the caller, since that
+// carves up the manager's shared aux spans.
+static void CutSpans(const plCutter* cutter, std::vector<plDecalCutSpan>& spans)
+{
+    hsParallelFor(spans.size(), 1, [cutter, &spans](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            cutter->Cutout(spans[i].fSrc, spans[i].fPolys);
+    });
+
+    for (const plDecalCutSpan& cut : spans)
+        plProfile_IncCount(DecalPolys, cut.fPolys.size());
+    plProfile_IncCount(DecalSpans, spans.size());
+}
+
 bool plDynaDecalMgr::fDisableAccumulate = false;
 bool plDynaDecalMgr::fDisableUpdate = false;
 
@@ -1418,6 +1445,9 @@ bool plDynaDecalMgr::ICutoutObject(plSceneObject* so, double secs)
         return retVal;
 
     plProfile_BeginTiming(Total);
+
+    // Gather up every span we touch first, so they can all be cut at once.
+    std::vector<std::pair<plDrawableSpans*, uint32_t>> hits;
     for (size_t j = 0; j < di->GetNumDrawables(); j++)
     {
         plDrawableSpans* dr = plDrawableSpans::ConvertNoRef(di->GetDrawable(j));
@@ -1431,37 +1461,43 @@ bool plDynaDecalMgr::ICutoutObject(plSceneObject* so, double secs)
                 {
                     const plSpan* span = dr->GetSpan(diIndex[k]);
                     if( kVolumeCulled != fCutter->GetIsect().Test(span->fWorldBounds) )
-                    {
-                        plAccessSpan src;
-                        plAccessGeometry::Instance()->OpenRO(dr, diIndex[k], src);
-
-                        static std::vector<plCutoutPoly> dst;
-                        dst.clear();
-
-                        plProfile_BeginTiming(Cutter);
-                        fCutter->Cutout(src, dst);
-                        plProfile_EndTiming(Cutter);
-
-                        plProfile_BeginTiming(Process);
-                        if( IProcessPolys(dr, diIndex[k], secs, dst) )
-                        {
-                            plProfile_BeginTiming(Callback);
-                            if( src.HasWaterHeight() )
-                                ICutoutCallback(dst, true, src.GetWaterHeight());
-                            else
-                                ICutoutCallback(dst);
-                            plProfile_EndTiming(Callback);
-
-                            retVal = true;
-                        }
-                        plProfile_EndTiming(Process);
-
-                        plAccessGeometry::Instance()->Close(src);
-                    }
+                        hits.emplace_back(dr, diIndex[k]);
                 }
             }
         }
     }
+
+    // Sized up front, the access spans mustn't move once they're open.
+    std::vector<plDecalCutSpan> spans(hits.size());
+    for (size_t i = 0; i < spans.size(); i++)
+    {
+        spans[i].fDrawable = hits[i].first;
+        spans[i].fSpanIdx = hits[i].second;
+        plAccessGeometry::Instance()->OpenRO(spans[i].fDrawable, spans[i].fSpanIdx, spans[i].fSrc);
+    }
+
+    plProfile_BeginTiming(Cutter);
+    CutSpans(fCutter, spans);
+    plProfile_EndTiming(Cutter);
+
+    for (plDecalCutSpan& cut : spans)
+    {
+        plProfile_BeginTiming(Process);
+        if( IProcessPolys(cut.fDrawable, cut.fSpanIdx, secs, cut.fPolys) )
+        {
+            plProfile_BeginTiming(Callback);
+            if( cut.fSrc.HasWaterHeight() )
+                ICutoutCallback(cut.fPolys, true, cut.fSrc.GetWaterHeight());
+            else
+                ICutoutCallback(cut.fPolys);
+            plProfile_EndTiming(Callback);
+
+            retVal = true;
+        }
+        plProfile_EndTiming(Process);
+
+        plAccessGeometry::Instance()->Close(cut.fSrc);
+    }
     plProfile_EndTiming(Total);
     return retVal;
 }
@@ -1476,29 +1512,21 @@ bool plDynaDecalMgr::ICutoutList(std::vector<plDrawVisList>& drawVis, double sec
     if (drawVis.empty())
         return retVal;
 
-    std::vector<plAccessSpan> src;
+    std::vector<plDecalCutSpan> spans;
 
     size_t numSpan = 0;
     for (const plDrawVisList& dv : drawVis)
         numSpan += dv.fVisList.size();
 
-    src.resize(numSpan);
+    spans.resize(numSpan);
 
     size_t iDraw = 0;
     size_t iSpan = 0;
     for (size_t i = 0; i < numSpan; i++)
     {
-        static std::vector<plCutoutPoly> dst;
-        dst.clear();
-
-        plAccessGeometry::Instance()->OpenRO(drawVis[iDraw].fDrawable, drawVis[iDraw].fVisList[iSpan], src[i]);
-
-        fCutter->Cutout(src[i], dst);
-
-        if( IProcessPolys((plDrawableSpans*)drawVis[iDraw].fDrawable, drawVis[iDraw].fVisList[iSpan], secs, dst) )
-            retVal = true;
-
-        plAccessGeometry::Instance()->Close(src[i]);
+        spans[i].fDrawable = (plDrawableSpans*)drawVis[iDraw].fDrawable;
+        spans[i].fSpanIdx = drawVis[iDraw].fVisList[iSpan];
+        plAccessGeometry::Instance()->OpenRO(spans[i].fDrawable, spans[i].fSpanIdx, spans[i].fSrc);
 
         if (++iSpan >= drawVis[iDraw].fVisList.size())
         {
@@ -1506,6 +1534,16 @@ bool plDynaDecalMgr::ICutoutList(std::vector<plDrawVisList>& drawVis, double sec
             iSpan = 0;
         }
     }
+
+    CutSpans(fCutter, spans);
+
+    for (plDecalCutSpan& cut : spans)
+    {
+        if( IProcessPolys(cut.fDrawable, cut.fSpanIdx, secs, cut.fPolys) )
+            retVal = true;
+
+        plAccessGeometry::Instance()->Close(cut.fSrc);
+    }
     return retVal;
 }
 
@@ -46,6 +46,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 // Core background
 #include "hsFastMath.h"
+#include "hsParallel.h"
 #include "plPipeline.h"
 #include "plViewTransform.h"
 
@@ -65,6 +66,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "hsTimer.h"
 #include "plProfile.h"
 plProfile_CreateTimer("Fill Polys", "Particles", ParticleFillPoly);
+plProfile_CreateCounter("Filled", "Particles", ParticlesFilled);
 
 static float sInvDelSecs;
 
@@ -91,6 +93,9 @@ static float sInvDelSecs;
 
 static float sCurrMinWidth = 0;
 
+// Fewer particles than this aren't worth handing to another thread
+static const size_t kMinParticlesPerJob = 128;
+
 ///////////////////////////////////////////////////////////////////////////////
 //// Particles ////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -633,80 +638,48 @@ void inline IIPL_0UV_OExp_NExp( const uint32_t &numParticles, const plParticleCo
     }
 }
 
-//// IFillParticlePolys ///////////////////////////////////////////////////////
-//  Takes a list of particles and makes the polys for them.
-void plParticleFiller::FillParticles(plPipeline* pipe, plDrawableSpans* drawable, plParticleSpan* span)
-{
-    if (!span->fSource || span->fNumParticles <= 0)
-        return;
-
-    plProfile_BeginTiming(ParticleFillPoly);
-
-    sInvDelSecs = hsTimer::GetDelSysSeconds();
-    if( sInvDelSecs > 0 )
-        sInvDelSecs = 1.f / sInvDelSecs;
-
-    const plParticleCore* particles = span->fSource->GetParticleArray();
-    const uint32_t numParticles = span->fNumParticles;
-
-    plGBufferGroup* group = drawable->GetBufferGroup(span->fGroupIdx);
-
-    uint8_t* destPtr = group->GetVertBufferData(span->fVBufferIdx);
-
-    destPtr += span->fVStartIdx * group->GetVertexSize();
-
-    /// Get the z vector (pointing away from the camera) in worldspace
-    hsMatrix44 viewToWorld = pipe->GetCameraToWorld();
-
-    plOmniLightInfo* omniLight = nullptr;
-    plDirectionalLightInfo* directionLight = nullptr;
-
-    /// Get strongest light, if there is one, for normal generation
-    if( span->GetNumLights( false ) > 0 )
-    {
-        omniLight = plOmniLightInfo::ConvertNoRef( span->GetLight( 0, false ) );
-        directionLight = plDirectionalLightInfo::ConvertNoRef( span->GetLight( 0, false ) );
-    }
+//// IFillParticleRange ///////////////////////////////////////////////////////
+//  Makes the polys for a run of particles, all from the same span.
 
+static void IFillParticleRange(const plParticleCore* particles, uint32_t numParticles, uint32_t miscFlags, uint32_t numUVs,
+                               const hsMatrix44& viewToWorld, uint8_t* destPtr,
+                               const plOmniLightInfo* omniLight, const plDirectionalLightInfo* directionLight)
+{
     /// Fill with 1 UV channel
-    if( group->GetNumUVs() == 1 )
+    if( numUVs == 1 )
     {
         /// Switch on orientation
-        if( span->fSource->fMiscFlags & plParticleEmitter::kOrientationVelocityBased )
+        if( miscFlags & plParticleEmitter::kOrientationVelocityBased )
         {
             /// Switch on normal generation
-            if( span->fSource->fMiscFlags & plParticleEmitter::kNormalViewFacing )
+            if( miscFlags & plParticleEmitter::kNormalViewFacing )
                 IIPL_1UV_OVel_NViewFace( numParticles, particles, viewToWorld, destPtr );
 
-            else if( span->fSource->fMiscFlags & plParticleEmitter::kNormalNearestLight )
+            else if( miscFlags & plParticleEmitter::kNormalNearestLight )
                 IIPL_1UV_OVel_NLite( numParticles, particles, viewToWorld, destPtr, omniLight, directionLight );
 
             else
                 IIPL_1UV_OVel_NExp( numParticles, particles, viewToWorld, destPtr );
         }
-        else if( span->fSource->fMiscFlags & plParticleEmitter::kOrientationVelocityStretch )
+        else if( miscFlags & plParticleEmitter::kOrientationVelocityStretch )
         {
-            sCurrMinWidth = pipe->GetViewTransform().GetOrthoWidth() / pipe->GetViewTransform().GetScreenWidth() * 0.75f;
-
             /// Switch on normal generation
-            if( span->fSource->fMiscFlags & plParticleEmitter::kNormalViewFacing )
+            if( miscFlags & plParticleEmitter::kNormalViewFacing )
                 IIPL_1UV_OStr_NViewFace( numParticles, particles, viewToWorld, destPtr );
 
-            else if( span->fSource->fMiscFlags & plParticleEmitter::kNormalNearestLight )
+            else if( miscFlags & plParticleEmitter::kNormalNearestLight )
                 IIPL_1UV_OStr_NLite( numParticles, particles, viewToWorld, destPtr, omniLight, directionLight );
 
             else
                 IIPL_1UV_OStr_NExp( numParticles, particles, viewToWorld, destPtr );
         }
-        else if( span->fSource->fMiscFlags & plParticleEmitter::kOrientationVelocityFlow )
+        else if( miscFlags & plParticleEmitter::kOrientationVelocityFlow )
         {
-            sCurrMinWidth = pipe->GetViewTransform().GetOrthoWidth() / pipe->GetViewTransform().GetScreenWidth() * 0.75f;
-
             /// Switch on normal generation
-            if( span->fSource->fMiscFlags & plParticleEmitter::kNormalViewFacing )
+            if( miscFlags & plParticleEmitter::kNormalViewFacing )
                 IIPL_1UV_OFlo_NViewFace( numParticles, particles, viewToWorld, destPtr );
 
-            else if( span->fSource->fMiscFlags & plParticleEmitter::kNormalNearestLight )
+            else if( miscFlags & plParticleEmitter::kNormalNearestLight )
                 IIPL_1UV_OFlo_NLite( numParticles, particles, viewToWorld, destPtr, omniLight, directionLight );
 
             else
@@ -715,10 +688,10 @@ void plParticleFiller::FillParticles(plPipeline* pipe, plDrawableSpans* drawable
         else    // Orientation explicit
         {
             /// Switch on normal generation
-            if( span->fSource->fMiscFlags & plParticleEmitter::kNormalViewFacing )
+            if( miscFlags & plParticleEmitter::kNormalViewFacing )
                 IIPL_1UV_OExp_NViewFace( numParticles, particles, viewToWorld, destPtr );
 
-            else if( span->fSource->fMiscFlags & plParticleEmitter::kNormalNearestLight )
+            else if( miscFlags & plParticleEmitter::kNormalNearestLight )
                 IIPL_1UV_OExp_NLite( numParticles, particles, viewToWorld, destPtr, omniLight, directionLight );
 
             else
@@ -729,41 +702,37 @@ void plParticleFiller::FillParticles(plPipeline* pipe, plDrawableSpans* drawable
     /// Fill with no UV channels
     {
         /// Switch on orientation
-        if( span->fSource->fMiscFlags & plParticleEmitter::kOrientationVelocityBased )
+        if( miscFlags & plParticleEmitter::kOrientationVelocityBased )
         {
             /// Switch on normal generation
-            if( span->fSource->fMiscFlags & plParticleEmitter::kNormalViewFacing )
+            if( miscFlags & plParticleEmitter::kNormalViewFacing )
                 IIPL_0UV_OVel_NViewFace( numParticles, particles, viewToWorld, destPtr );
 
-            else if( span->fSource->fMiscFlags & plParticleEmitter::kNormalNearestLight )
+            else if( miscFlags & plParticleEmitter::kNormalNearestLight )
                 IIPL_0UV_OVel_NLite( numParticles, particles, viewToWorld, destPtr, omniLight, directionLight );
 
             else
                 IIPL_0UV_OVel_NExp( numParticles, particles, viewToWorld, destPtr );
         }
-        else if( span->fSource->fMiscFlags & plParticleEmitter::kOrientationVelocityStretch )
+        else if( miscFlags & plParticleEmitter::kOrientationVelocityStretch )
         {
-            sCurrMinWidth = pipe->GetViewTransform().GetOrthoWidth() / pipe->GetViewTransform().GetScreenWidth() * 0.75f;
-
             /// Switch on normal generation
-            if( span->fSource->fMiscFlags & plParticleEmitter::kNormalViewFacing )
+            if( miscFlags & plParticleEmitter::kNormalViewFacing )
                 IIPL_0UV_OStr_NViewFace( numParticles, particles, viewToWorld, destPtr );
 
-            else if( span->fSource->fMiscFlags & plParticleEmitter::kNormalNearestLight )
+            else if( miscFlags & plParticleEmitter::kNormalNearestLight )
                 IIPL_0UV_OStr_NLite( numParticles, particles, viewToWorld, destPtr, omniLight, directionLight );
 
             else
                 IIPL_0UV_OStr_NExp( numParticles, particles, viewToWorld, destPtr );
         }
-        else if( span->fSource->fMiscFlags & plParticleEmitter::kOrientationVelocityFlow )
+        else if( miscFlags & plParticleEmitter::kOrientationVelocityFlow )
         {
-            sCurrMinWidth = pipe->GetViewTransform().GetOrthoWidth() / pipe->GetViewTransform().GetScreenWidth() * 0.75f;
-
             /// Switch on normal generation
-            if( span->fSource->fMiscFlags & plParticleEmitter::kNormalViewFacing )
+            if( miscFlags & plParticleEmitter::kNormalViewFacing )
                 IIPL_0UV_OFlo_NViewFace( numParticles, particles, viewToWorld, destPtr );
 
-            else if( span->fSource->fMiscFlags & plParticleEmitter::kNormalNearestLight )
+            else if( miscFlags & plParticleEmitter::kNormalNearestLight )
                 IIPL_0UV_OFlo_NLite( numParticles, particles, viewToWorld, destPtr, omniLight, directionLight );
 
             else
@@ -772,10 +741,10 @@ void plParticleFiller::FillParticles(plPipeline* pipe, plDrawableSpans* drawable
         else    // Orientation explicit
         {
             /// Switch on normal generation
-            if( span->fSource->fMiscFlags & plParticleEmitter::kNormalViewFacing )
+            if( miscFlags & plParticleEmitter::kNormalViewFacing )
                 IIPL_0UV_OExp_NViewFace( numParticles, particles, viewToWorld, destPtr );
 
-            else if( span->fSource->fMiscFlags & plParticleEmitter::kNormalNearestLight )
+            else if( miscFlags & plParticleEmitter::kNormalNearestLight )
                 IIPL_0UV_OExp_NLite( numParticles, particles, viewToWorld, destPtr, omniLight, directionLight );
 
             else
@@ -783,10 +752,108 @@ void plParticleFiller::FillParticles(plPipeline* pipe, plDrawableSpans* drawable
         }
     }
 
+}
+
+//// ISetupFill ///////////////////////////////////////////////////////////////
+//  Everything the particle loops need that's the same for every span this
+//  frame. Has to happen before any filling starts, since the fills only read
+//  these.
+
+static void ISetupFill(plPipeline* pipe)
+{
+    sInvDelSecs = hsTimer::GetDelSysSeconds();
+    if( sInvDelSecs > 0 )
+        sInvDelSecs = 1.f / sInvDelSecs;
+
+    sCurrMinWidth = pipe->GetViewTransform().GetOrthoWidth() / pipe->GetViewTransform().GetScreenWidth() * 0.75f;
+}
+
+//// IFillParticles ///////////////////////////////////////////////////////////
+//  Takes a list of particles and makes the polys for them. Every particle
+//  gets its own 4 verts, so big spans get split up across the worker threads.
+
+static void IFillParticles(const hsMatrix44& viewToWorld, plDrawableSpans* drawable, plParticleSpan* span)
+{
+    if (!span->fSource || span->fNumParticles <= 0)
+        return;
+
+    const plParticleCore* particles = span->fSource->GetParticleArray();
+    const uint32_t numParticles = span->fNumParticles;
+    const uint32_t miscFlags = span->fSource->fMiscFlags;
+
+    plGBufferGroup* group = drawable->GetBufferGroup(span->fGroupIdx);
+    const uint32_t numUVs = group->GetNumUVs();
+    const uint32_t particleSize = 4 * group->GetVertexSize();
+
+    uint8_t* destPtr = group->GetVertBufferData(span->fVBufferIdx);
+
+    destPtr += span->fVStartIdx * group->GetVertexSize();
+
+    const plOmniLightInfo* omniLight = nullptr;
+    const plDirectionalLightInfo* directionLight = nullptr;
+
+    /// Get strongest light, if there is one, for normal generation
+    if( span->GetNumLights( false ) > 0 )
+    {
+        omniLight = plOmniLightInfo::ConvertNoRef( span->GetLight( 0, false ) );
+        directionLight = plDirectionalLightInfo::ConvertNoRef( span->GetLight( 0, false ) );
+    }
+
+    hsParallelFor(numParticles, kMinParticlesPerJob, [=, &viewToWorld](size_t begin, size_t end) {
+        IFillParticleRange(particles + begin, uint32_t(end - begin), miscFlags, numUVs, viewToWorld,
+                           destPtr + begin * particleSize, omniLight, directionLight);
+    });
+}
+
+//// FillParticles ////////////////////////////////////////////////////////////
+
+void plParticleFiller::FillParticles(plPipeline* pipe, plDrawableSpans* drawable, plParticleSpan* span)
+{
+    if (!span->fSource || span->fNumParticles <= 0)
+        return;
+
+    plProfile_BeginTiming(ParticleFillPoly);
+
+    ISetupFill(pipe);
+
+    /// Get the z vector (pointing away from the camera) in worldspace
+    hsMatrix44 viewToWorld = pipe->GetCameraToWorld();
+
+    IFillParticles(viewToWorld, drawable, span);
+
     /// All done!
     plProfile_EndTiming(ParticleFillPoly);
 }
 
+//// FillParticleSpans ////////////////////////////////////////////////////////
+//  Same as calling FillParticles on each span, except the spans all get
+//  filled at once.
+
+void plParticleFiller::FillParticleSpans(plPipeline* pipe, plDrawableSpans* drawable, std::vector<plParticleSpan>& spans)
+{
+    if (spans.empty())
+        return;
+
+    plProfile_BeginTiming(ParticleFillPoly);
+
+    ISetupFill(pipe);
+
+    hsMatrix44 viewToWorld = pipe->GetCameraToWorld();
+
+    hsParallelFor(spans.size(), 1, [&viewToWorld, drawable, &spans](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            IFillParticles(viewToWorld, drawable, &spans[i]);
+    });
+
+    for (const plParticleSpan& span : spans)
+    {
+        if (span.fSource)
+            plProfile_IncCount(ParticlesFilled, span.fNumParticles);
+    }
+
+    plProfile_EndTiming(ParticleFillPoly);
+}
+
 void plParticleFiller::FillParticlePolys(plPipeline* pipe, plDrawInterface* di)
 {
     if( !di )
@@ -43,6 +43,8 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #ifndef plParticleFiller_inc
 #define plParticleFiller_inc
 
+#include <vector>
+
 class plDrawInterface;
 class plPipeline;
 class plParticleSpan;
@@ -51,6 +53,7 @@ class plDrawableSpans;
 namespace plParticleFiller
 {
     void FillParticles(plPipeline* pipe, plDrawableSpans* drawable, plParticleSpan* span);
+    void FillParticleSpans(plPipeline* pipe, plDrawableSpans* drawable, std::vector<plParticleSpan>& spans);
     void FillParticlePolys(plPipeline* pipe, plDrawInterface* di);
 };
 
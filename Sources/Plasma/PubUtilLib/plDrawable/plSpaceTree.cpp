@@ -54,6 +54,25 @@ static hsBitVector scratchBitVec;
 
 plProfile_CreateCounter("Harvest Leaves", "Draw", HarvestLeaves);
 
+void plSpaceTreeCompact::Resize(size_t n)
+{
+    fMinX.resize(n);
+    fMinY.resize(n);
+    fMinZ.resize(n);
+    fMaxX.resize(n);
+    fMaxY.resize(n);
+    fMaxZ.resize(n);
+    fCenterX.resize(n);
+    fCenterY.resize(n);
+    fCenterZ.resize(n);
+    fRadius.resize(n);
+    fFlags.resize(n);
+    fBoundsFlags.resize(n);
+    fSecondChild.resize(n);
+    fNode.resize(n);
+    fCompactIdx.resize(n);
+}
+
 void plSpaceTreeNode::Read(hsStream* s)
 {
     fWorldBounds.Read(s);
@@ -112,6 +131,7 @@ void plSpaceTree::IRefreshRecur(int16_t which)
             sub.fWorldBounds.Union(&fTree[sub.fChildren[1]].fWorldBounds);
 
         sub.fFlags &= ~plSpaceTreeNode::kDirty;
+        IUpdateCompactBounds(which);
     }
 }
 
@@ -121,6 +141,80 @@ void plSpaceTree::Refresh()
         IRefreshRecur(fRoot);
 }
 
+void plSpaceTree::IBuildCompact()
+{
+    fCompact.Resize(fTree.size());
+    if( fTree.empty() )
+        return;
+
+    int16_t end = IBuildCompactRecur(fRoot, 0);
+    hsAssert(size_t(end) == fTree.size(), "Space tree nodes unreachable from the root");
+    for (int16_t c = 0; c < end; c++)
+        fCompact.fCompactIdx[fCompact.fNode[c]] = c;
+
+    for (size_t i = 0; i < fTree.size(); i++)
+    {
+        IUpdateCompactBounds(int16_t(i));
+        IUpdateCompactFlags(int16_t(i));
+    }
+}
+
+// Lays out the subtree under which depth first, starting at compact slot c,
+// and returns the first slot after the subtree.
+int16_t plSpaceTree::IBuildCompactRecur(int16_t which, int16_t c)
+{
+    fCompact.fNode[c] = which;
+    fCompact.fSecondChild[c] = -1;
+
+    const plSpaceTreeNode& sub = fTree[which];
+    if( sub.fFlags & plSpaceTreeNode::kIsLeaf )
+        return c + 1;
+
+    fCompact.fSecondChild[c] = IBuildCompactRecur(sub.fChildren[0], c + 1);
+    return IBuildCompactRecur(sub.fChildren[1], fCompact.fSecondChild[c]);
+}
+
+void plSpaceTree::IUpdateCompactBounds(int16_t which)
+{
+    // The tree maker fills in the nodes before the compact copy exists
+    if( fCompact.fCompactIdx.size() != fTree.size() )
+        return;
+
+    int16_t c = fCompact.fCompactIdx[which];
+    const hsBounds3Ext& bnd = fTree[which].fWorldBounds;
+    if( bnd.GetType() != kBoundsNormal )
+    {
+        fCompact.fBoundsFlags[c] = 0;
+        return;
+    }
+
+    const hsPoint3& mins = bnd.GetMins();
+    const hsPoint3& maxs = bnd.GetMaxs();
+    const hsPoint3& center = bnd.GetCenter();
+    fCompact.fMinX[c] = mins.fX;
+    fCompact.fMinY[c] = mins.fY;
+    fCompact.fMinZ[c] = mins.fZ;
+    fCompact.fMaxX[c] = maxs.fX;
+    fCompact.fMaxY[c] = maxs.fY;
+    fCompact.fMaxZ[c] = maxs.fZ;
+    fCompact.fCenterX[c] = center.fX;
+    fCompact.fCenterY[c] = center.fY;
+    fCompact.fCenterZ[c] = center.fZ;
+    fCompact.fRadius[c] = bnd.GetRadius();
+
+    fCompact.fBoundsFlags[c] = plSpaceTreeCompact::kBoundsNormal;
+    if( bnd.IsAxisAligned() )
+        fCompact.fBoundsFlags[c] |= plSpaceTreeCompact::kBoundsAxisAligned;
+}
+
+void plSpaceTree::IUpdateCompactFlags(int16_t which)
+{
+    if( fCompact.fCompactIdx.size() != fTree.size() )
+        return;
+
+    fCompact.fFlags[fCompact.fCompactIdx[which]] = fTree[which].fFlags;
+}
+
 void plSpaceTree::SetTreeFlag(uint16_t f, bool on)
 {
     if( IsEmpty() )
@@ -134,6 +228,8 @@ void plSpaceTree::SetTreeFlag(uint16_t f, bool on)
 
     for (plSpaceTreeNode& node : fTree)
         node.fFlags |= f;
+    for (size_t i = 0; i < fTree.size(); i++)
+        IUpdateCompactFlags(int16_t(i));
 }
 
 void plSpaceTree::ClearTreeFlag(uint16_t f)
@@ -143,6 +239,8 @@ void plSpaceTree::ClearTreeFlag(uint16_t f)
 
     for (plSpaceTreeNode& node : fTree)
         node.fFlags &= ~f;
+    for (size_t i = 0; i < fTree.size(); i++)
+        IUpdateCompactFlags(int16_t(i));
 }
 
 void plSpaceTree::SetLeafFlag(int16_t idx, uint16_t f, bool on)
@@ -159,6 +257,7 @@ void plSpaceTree::SetLeafFlag(int16_t idx, uint16_t f, bool on)
     }
 
     fTree[idx].fFlags |= f;
+    IUpdateCompactFlags(idx);
 
     idx = fTree[idx].fParent;
 
@@ -172,6 +271,7 @@ void plSpaceTree::SetLeafFlag(int16_t idx, uint16_t f, bool on)
         else
         {
             fTree[idx].fFlags |= f;
+            IUpdateCompactFlags(idx);
             idx = fTree[idx].fParent;
         }
     }
@@ -190,6 +290,7 @@ void plSpaceTree::ClearLeafFlag(int16_t idx, uint16_t f)
         else
         {
             fTree[idx].fFlags &= ~f;
+            IUpdateCompactFlags(idx);
             idx = fTree[idx].fParent;
         }
     }
@@ -321,6 +422,7 @@ void plSpaceTree::MoveLeaf(int16_t idx, const hsBounds3Ext& bnd)
     hsAssert(idx == fTree[idx].fLeafIndex, "Some scrambling of indices");
 
     fTree[idx].fWorldBounds = bnd;
+    IUpdateCompactBounds(idx);
 
     while( idx != kRootParent )
     {
@@ -346,7 +448,7 @@ void plSpaceTree::HarvestLeaves(int16_t subRoot, hsBitVector& totList, hsBitVect
         }
         else
         {
-            IHarvestLeaves(fTree[subRoot], totList, list);
+            IHarvestLeaves(GetCompactIndex(subRoot), totList, list);
         }
     }
 }
@@ -354,13 +456,13 @@ void plSpaceTree::HarvestLeaves(int16_t subRoot, hsBitVector& totList, hsBitVect
 void plSpaceTree::HarvestLeaves(hsBitVector& totList, hsBitVector& list) const
 {
     if( !IsEmpty() )
-        IHarvestLeaves(fTree[fRoot], totList, list);
+        IHarvestLeaves(GetCompactIndex(fRoot), totList, list);
 }
 
 void plSpaceTree::HarvestLeaves(hsBitVector& list) const
 {
     if( !IsEmpty() )
-        IHarvestLeaves(fTree[fRoot], scratchTotVec, list);
+        IHarvestLeaves(GetCompactIndex(fRoot), scratchTotVec, list);
     scratchTotVec.Clear();
 }
 
@@ -370,16 +472,16 @@ void plSpaceTree::HarvestLeaves(plVolumeIsect* cull, hsBitVector& list) const
     {
         fCullFunc = cull;
         if (fCullFunc)
-            IHarvestAndCullLeaves(fTree[fRoot], scratchTotVec, list);
+            IHarvestAndCullLeaves(GetCompactIndex(fRoot), scratchTotVec, list);
         else
-            IHarvestLeaves(fTree[fRoot], scratchTotVec, list);
+            IHarvestLeaves(GetCompactIndex(fRoot), scratchTotVec, list);
     }
     scratchTotVec.Clear();
 }
 
 void plSpaceTree::HarvestLeaves(int16_t subRoot, hsBitVector& list) const 
 { 
-    IHarvestLeaves(GetNode(subRoot), scratchTotVec, list);
+    IHarvestLeaves(GetCompactIndex(subRoot), scratchTotVec, list);
     scratchTotVec.Clear();
 }
 
@@ -417,26 +519,36 @@ void plSpaceTree::HarvestLeaves(int16_t subRoot, std::vector<int16_t>& list) con
     }
 }
 
-void plSpaceTree::IHarvestAndCullLeaves(const plSpaceTreeNode& subRoot, hsBitVector& totList, hsBitVector& list) const
+// Only axis aligned bounds are fully described by the compact mins and maxs,
+// anything else gets the cull function's test on the real bounds.
+static inline plVolumeCullResult ICullTestCompact(const plVolumeIsect* cull, const plSpaceTreeCompact& compact,
+                                                  const plSpaceTreeNode& node, int16_t c)
 {
-    if( subRoot.fFlags & plSpaceTreeNode::kDisabled )
+    if( compact.IsAxisAligned(c) )
+        return cull->TestBox(compact.GetMins(c), compact.GetMaxs(c));
+    return cull->Test(node.fWorldBounds);
+}
+
+void plSpaceTree::IHarvestAndCullLeaves(int16_t c, hsBitVector& totList, hsBitVector& list) const
+{
+    if( fCompact.fFlags[c] & plSpaceTreeNode::kDisabled )
         return;
 
-    auto idx = (uint32_t)(&subRoot - &fTree[0]);
+    int16_t idx = fCompact.fNode[c];
     if( totList.IsBitSet(idx) )
         return;
 
     hsAssert(fCullFunc, "Oops");
-    plVolumeCullResult res = fCullFunc->Test(subRoot.fWorldBounds);
+    plVolumeCullResult res = ICullTestCompact(fCullFunc, fCompact, fTree[idx], c);
     if( res == kVolumeCulled )
         return;
 
-    if( subRoot.fFlags & plSpaceTreeNode::kIsLeaf )
+    if( fCompact.IsLeaf(c) )
     {
         totList.SetBit(idx);
 
         plProfile_Inc(HarvestLeaves);
-        list.SetBit(subRoot.fLeafIndex);
+        list.SetBit(idx);
     }
     else
     {
@@ -444,83 +556,83 @@ void plSpaceTree::IHarvestAndCullLeaves(const plSpaceTreeNode& subRoot, hsBitVec
         {
             totList.SetBit(idx);
 
-            IHarvestLeaves(fTree[subRoot.fChildren[0]], totList, list);
-            IHarvestLeaves(fTree[subRoot.fChildren[1]], totList, list);
+            IHarvestLeaves(c + 1, totList, list);
+            IHarvestLeaves(fCompact.fSecondChild[c], totList, list);
         }
         else
         {
-            IHarvestAndCullLeaves(fTree[subRoot.fChildren[0]], totList, list);
-            IHarvestAndCullLeaves(fTree[subRoot.fChildren[1]], totList, list);
+            IHarvestAndCullLeaves(c + 1, totList, list);
+            IHarvestAndCullLeaves(fCompact.fSecondChild[c], totList, list);
         }
     }
 }
 
-void plSpaceTree::IHarvestAndCullLeaves(const plSpaceTreeNode& subRoot, std::vector<int16_t>& list) const
+void plSpaceTree::IHarvestAndCullLeaves(int16_t c, std::vector<int16_t>& list) const
 {
-    if( subRoot.fFlags & plSpaceTreeNode::kDisabled )
+    if( fCompact.fFlags[c] & plSpaceTreeNode::kDisabled )
         return;
 
     hsAssert(fCullFunc, "Oops");
-    plVolumeCullResult res = fCullFunc->Test(subRoot.fWorldBounds);
+    plVolumeCullResult res = ICullTestCompact(fCullFunc, fCompact, fTree[fCompact.fNode[c]], c);
     if( res == kVolumeCulled )
         return;
 
-    if( subRoot.fFlags & plSpaceTreeNode::kIsLeaf )
+    if( fCompact.IsLeaf(c) )
     {
         plProfile_Inc(HarvestLeaves);
-        list.emplace_back(subRoot.fLeafIndex);
+        list.emplace_back(fCompact.fNode[c]);
     }
     else
     {
         if( res == kVolumeClear )
         {
-            IHarvestLeaves(fTree[subRoot.fChildren[0]], list);
-            IHarvestLeaves(fTree[subRoot.fChildren[1]], list);
+            IHarvestLeaves(c + 1, list);
+            IHarvestLeaves(fCompact.fSecondChild[c], list);
         }
         else
         {
-            IHarvestAndCullLeaves(fTree[subRoot.fChildren[0]], list);
-            IHarvestAndCullLeaves(fTree[subRoot.fChildren[1]], list);
+            IHarvestAndCullLeaves(c + 1, list);
+            IHarvestAndCullLeaves(fCompact.fSecondChild[c], list);
         }
     }
 }
 
-void plSpaceTree::IHarvestLeaves(const plSpaceTreeNode& subRoot, hsBitVector& totList, hsBitVector& list) const
+void plSpaceTree::IHarvestLeaves(int16_t c, hsBitVector& totList, hsBitVector& list) const
 {
-    if( subRoot.fFlags & plSpaceTreeNode::kDisabled )
+    if( fCompact.fFlags[c] & plSpaceTreeNode::kDisabled )
         return;
 
-    auto idx = (uint32_t)(&subRoot - &fTree[0]);
+    int16_t idx = fCompact.fNode[c];
     if( totList.IsBitSet(idx) )
         return;
 
     totList.SetBit(idx);
 
-    if( subRoot.fFlags & plSpaceTreeNode::kIsLeaf )
+    if( fCompact.IsLeaf(c) )
     {
         plProfile_Inc(HarvestLeaves);
-        list.SetBit(subRoot.fLeafIndex);
+        list.SetBit(idx);
     }
     else
     {
-        IHarvestLeaves(fTree[subRoot.fChildren[0]], totList, list);
-        IHarvestLeaves(fTree[subRoot.fChildren[1]], totList, list);
+        IHarvestLeaves(c + 1, totList, list);
+        IHarvestLeaves(fCompact.fSecondChild[c], totList, list);
     }
 }
 
-void plSpaceTree::IHarvestLeaves(const plSpaceTreeNode& subRoot, std::vector<int16_t>& list) const
+void plSpaceTree::IHarvestLeaves(int16_t c, std::vector<int16_t>& list) const
 {
-    if( subRoot.fFlags & plSpaceTreeNode::kDisabled )
+    if( fCompact.fFlags[c] & plSpaceTreeNode::kDisabled )
         return;
-    if( subRoot.fFlags & plSpaceTreeNode::kIsLeaf )
+    if( fCompact.IsLeaf(c) )
     {
         plProfile_Inc(HarvestLeaves);
-        list.emplace_back(subRoot.fLeafIndex);
+        list.emplace_back(fCompact.fNode[c]);
     }
     else
     {
-        IHarvestLeaves(fTree[subRoot.fChildren[0]], list);
-        IHarvestLeaves(fTree[subRoot.fChildren[1]], list);
+        IHarvestLeaves(c + 1, list);
+        IHarvestLeaves(fCompact.fSecondChild[c], list);
     }
 }
 
@@ -536,6 +648,8 @@ void plSpaceTree::Read(hsStream* s, hsResMgr* mgr)
     fTree.resize(n);
     for (uint32_t i = 0; i < n; i++)
         fTree[i].Read(s);
+
+    IBuildCompact();
 }
 
 void plSpaceTree::Write(hsStream* s, hsResMgr* mgr)
@@ -87,6 +87,41 @@ public:
 };
 
 
+// Traversal copy of a plSpaceTree's nodes, rebuilt whenever the tree is read or
+// made and kept in step as leaves move and flags change. The file format doesn't
+// know about it.
+// Nodes are laid out depth first, so an interior node's first child is always the
+// entry right after it, and each field gets its own array so a walk only pulls in
+// the parts it actually tests.
+class plSpaceTreeCompact
+{
+public:
+    enum {
+        kBoundsNormal       = 0x1,
+        kBoundsAxisAligned  = 0x2
+    };
+
+    std::vector<float>      fMinX, fMinY, fMinZ;
+    std::vector<float>      fMaxX, fMaxY, fMaxZ;
+    std::vector<float>      fCenterX, fCenterY, fCenterZ;
+    std::vector<float>      fRadius;
+    std::vector<uint16_t>   fFlags;         // plSpaceTreeNode flags, except kDirty isn't kept up
+    std::vector<uint8_t>    fBoundsFlags;
+    std::vector<int16_t>    fSecondChild;   // Compact index of the second child, -1 for leaves
+    std::vector<int16_t>    fNode;          // Index of the node in the plSpaceTree
+    std::vector<int16_t>    fCompactIdx;    // plSpaceTree node index to compact index
+
+    size_t      GetCount() const { return fNode.size(); }
+    bool        IsLeaf(int16_t c) const { return 0 != (fFlags[c] & plSpaceTreeNode::kIsLeaf); }
+    bool        IsAxisAligned(int16_t c) const { return 0 != (fBoundsFlags[c] & kBoundsAxisAligned); }
+    bool        IsNormal(int16_t c) const { return 0 != (fBoundsFlags[c] & kBoundsNormal); }
+    hsPoint3    GetMins(int16_t c) const { return hsPoint3(fMinX[c], fMinY[c], fMinZ[c]); }
+    hsPoint3    GetMaxs(int16_t c) const { return hsPoint3(fMaxX[c], fMaxY[c], fMaxZ[c]); }
+    hsPoint3    GetCenter(int16_t c) const { return hsPoint3(fCenterX[c], fCenterY[c], fCenterZ[c]); }
+
+    void        Resize(size_t n);
+};
+
 class plSpaceTree : public plCreatable
 {
 public:
@@ -101,6 +136,7 @@ public:
 private:
     std::vector<plSpaceTreeNode>    fTree;
     const hsBitVector*              fCache;
+    plSpaceTreeCompact              fCompact;
 
     int32_t                           fNumLeaves;
     int16_t                           fRoot;
@@ -112,12 +148,17 @@ private:
     hsPoint3                        fViewPos;
 
     void        IRefreshRecur(int16_t which);
+
+    void        IBuildCompact();
+    int16_t     IBuildCompactRecur(int16_t which, int16_t c);
+    void        IUpdateCompactBounds(int16_t which);
+    void        IUpdateCompactFlags(int16_t which);
     
-    void        IHarvestAndCullLeaves(const plSpaceTreeNode& subRoot, std::vector<int16_t>& list) const;
-    void        IHarvestLeaves(const plSpaceTreeNode& subRoot, std::vector<int16_t>& list) const;
+    void        IHarvestAndCullLeaves(int16_t subRoot, std::vector<int16_t>& list) const;
+    void        IHarvestLeaves(int16_t subRoot, std::vector<int16_t>& list) const;
     
-    void        IHarvestAndCullLeaves(const plSpaceTreeNode& subRoot, hsBitVector& totList, hsBitVector& list) const;
-    void        IHarvestLeaves(const plSpaceTreeNode& subRoot, hsBitVector& totList, hsBitVector& list) const;
+    void        IHarvestAndCullLeaves(int16_t subRoot, hsBitVector& totList, hsBitVector& list) const;
+    void        IHarvestLeaves(int16_t subRoot, hsBitVector& totList, hsBitVector& list) const;
 
     void        IHarvestLevel(int16_t subRoot, int level, int currLevel, std::vector<int16_t>& list) const;
 
@@ -168,6 +209,12 @@ public:
 
     bool IsDisabled(uint16_t w) const { return (GetNode(w).fFlags & plSpaceTreeNode::kDisabled) || (fCache && !fCache->IsBitSet(w)); }
 
+    // Compact copy of the nodes for fast traversal. Index it with GetCompactIndex(),
+    // and map back with GetCompact().fNode.
+    const plSpaceTreeCompact& GetCompact() const { return fCompact; }
+    int16_t GetCompactIndex(int16_t w) const { return fCompact.fCompactIdx[w]; }
+    bool IsCompactDisabled(int16_t c) const { return (fCompact.fFlags[c] & plSpaceTreeNode::kDisabled) || (fCache && !fCache->IsBitSet(fCompact.fNode[c])); }
+
     // Should GetWorldBounds check and refresh if needed?
     const hsBounds3Ext& GetWorldBounds() const { return GetNode(GetRoot()).fWorldBounds; }
 
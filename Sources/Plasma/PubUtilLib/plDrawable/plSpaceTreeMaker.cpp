@@ -550,6 +550,7 @@ plSpaceTree* plSpaceTreeMaker::IMakeEmptyTree()
     tree->fTree[0].fFlags = plSpaceTreeNode::kEmpty;
     tree->fRoot = 0;
     tree->fNumLeaves = 0;
+    tree->IBuildCompact();
 
     Cleanup();
 
@@ -571,6 +572,7 @@ plSpaceTree* plSpaceTreeMaker::IMakeDegenerateTree()
 
     if( fDisabled.IsBitSet(0) )
         tree->SetLeafFlag(0, plSpaceTreeNode::kDisabled, true);
+    tree->IBuildCompact();
 
     Cleanup();
 
@@ -615,6 +617,7 @@ plSpaceTree* plSpaceTreeMaker::IMakeSpaceTree()
         if( fDisabled.IsBitSet(i) )
             tree->SetLeafFlag(i, plSpaceTreeNode::kDisabled, true);
     }
+    tree->IBuildCompact();
 
     StopTimer(kMakeSpaceTree);
 
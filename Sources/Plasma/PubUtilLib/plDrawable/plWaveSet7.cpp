@@ -270,7 +270,12 @@ plWaveSet7::plWaveSet7()
     fTexTransDel(),
 
     fStatusLog(),
-    fStatusGraph()
+    fStatusGraph(),
+
+    fWaveShapeSerial(1),
+    fLastChop(),
+    fLastAmpOverLen(),
+    fRipVShaderSerial()
 {
     IInitState();
     IInitWaveConsts();
@@ -280,6 +285,7 @@ plWaveSet7::plWaveSet7()
     {
         fFreqMod[i] = 1.f;
         IInitWave(i);
+        fLastWaveShape[i] = fWorldWaves[i];
     }
     for( i = 0; i < 4; i++ )
     {
@@ -309,7 +315,10 @@ plWaveSet7::plWaveSet7()
         fGraphReqMsg[i] = nullptr;
     }
     for( i = 0; i < kNumDecalVShaders; i++ )
+    {
         fDecalVShaders[i] = nullptr;
+        fDecalVShaderSerial[i] = 0;
+    }
     for( i = 0; i < kNumDecalPShaders; i++ )
         fDecalPShaders[i] = nullptr;
 }
@@ -530,6 +539,7 @@ bool plWaveSet7::IOnReceive(plGenRefMsg* refMsg)
         return true;
     case kRefDecVShader:
         fDecalVShaders[refMsg->fWhich] = plShader::ConvertNoRef(refMsg->GetRef());
+        fDecalVShaderSerial[refMsg->fWhich] = 0;
         return true;
     case kRefDecPShader:
         fDecalPShaders[refMsg->fWhich] = plShader::ConvertNoRef(refMsg->GetRef());
@@ -572,6 +582,7 @@ bool plWaveSet7::IOnReceive(plGenRefMsg* refMsg)
         return true;
     case kRefRipVShader:
         fRipVShader = plShader::ConvertNoRef(refMsg->GetRef());
+        fRipVShaderSerial = 0;
         return true;
     case kRefRipPShader:
         fRipPShader = plShader::ConvertNoRef(refMsg->GetRef());
@@ -761,6 +772,38 @@ void plWaveSet7::IUpdateWaves(float dt)
     {
         IUpdateWave(dt, i);
     }
+
+    ICheckWaveShape();
+}
+
+void plWaveSet7::ICheckWaveShape()
+{
+    float chop = GeoState().fChop;
+    float ampOverLen = GeoState().fAmpOverLen;
+    bool changed = (chop != fLastChop) || (ampOverLen != fLastAmpOverLen);
+
+    int i;
+    for( i = 0; !changed && (i < kNumWaves); i++ )
+    {
+        const plWorldWaveData7& wave = fWorldWaves[i];
+        const plWorldWaveData7& last = fLastWaveShape[i];
+        changed = (wave.fDir.fX != last.fDir.fX)
+            || (wave.fDir.fY != last.fDir.fY)
+            || (wave.fLength != last.fLength)
+            || (wave.fFreq != last.fFreq)
+            || (wave.fAmplitude != last.fAmplitude);
+    }
+    if( !changed )
+        return;
+
+    for( i = 0; i < kNumWaves; i++ )
+        fLastWaveShape[i] = fWorldWaves[i];
+    fLastChop = chop;
+    fLastAmpOverLen = ampOverLen;
+
+    // Zero is reserved for shaders that have never been set up.
+    if( !++fWaveShapeSerial )
+        fWaveShapeSerial = 1;
 }
 
 // return true if we've finished this transition.
@@ -965,31 +1008,77 @@ inline void plWaveSet7::IScrunch(hsPoint3& pos, hsVector3& norm) const
 
 float plWaveSet7::EvalPoint(hsPoint3& pos, hsVector3& norm)
 {
-    hsPoint3 accumPos;
-    hsVector3 accumNorm;
-    accumPos.Set(pos.fX, pos.fY, State().fWaterHeight);
+    EvalPoints(&pos, &norm, 1);
 
-    int i;
-    for( i = 0; i < kNumWaves; i++ )
-        fWorldWaves[i].Accumulate(accumPos, accumNorm);
+    return pos.fZ;
+}
+
+void plWaveSet7::EvalPoints(hsPoint3* pos, hsVector3* norm, size_t count)
+{
+    constexpr size_t kPointsPerChunk = 64;
+    float height[kPointsPerChunk];
+    float slopeX[kPointsPerChunk];
+    float slopeY[kPointsPerChunk];
+
+    const float waterHeight = State().fWaterHeight;
 
-    accumNorm.fZ = 1.f;
+    while( count )
+    {
+        size_t num = std::min(count, kPointsPerChunk);
+
+        accum_waves.call(fWorldWaves, pos, height, slopeX, slopeY, num);
 
-    hsFastMath::NormalizeAppr(accumNorm);
+        size_t i;
+        for( i = 0; i < num; i++ )
+        {
+            hsPoint3 accumPos(pos[i].fX, pos[i].fY, waterHeight + height[i]);
+            hsVector3 accumNorm(slopeX[i], slopeY[i], 1.f);
 
-    IScrunch(accumPos, accumNorm);
+            hsFastMath::NormalizeAppr(accumNorm);
 
-    // Project original pos along Z onto the plane tangent at accumPos with norm accumNorm
-    float t = hsVector3(&accumPos, &pos).InnerProduct(accumNorm);
-    t /= accumNorm.fZ;
+            IScrunch(accumPos, accumNorm);
 
-    pos.fZ += t;
+            // Project original pos along Z onto the plane tangent at accumPos with norm accumNorm
+            float t = hsVector3(&accumPos, &pos[i]).InnerProduct(accumNorm);
+            t /= accumNorm.fZ;
 
-    norm = accumNorm;
+            pos[i].fZ += t;
 
-    return pos.fZ;
+            norm[i] = accumNorm;
+        }
+
+        pos += num;
+        norm += num;
+        count -= num;
+    }
 }
 
+void plWaveSet7::accum_waves_fpu(const plWorldWave7* waves, const hsPoint3* pos,
+                                 float* height, float* slopeX, float* slopeY, size_t count)
+{
+    size_t i;
+    for( i = 0; i < count; i++ )
+    {
+        hsPoint3 accumPos(pos[i].fX, pos[i].fY, 0.f);
+        hsVector3 accumNorm(0.f, 0.f, 0.f);
+
+        int j;
+        for( j = 0; j < kNumWaves; j++ )
+            waves[j].Accumulate(accumPos, accumNorm);
+
+        height[i] = accumPos.fZ;
+        slopeX[i] = accumNorm.fX;
+        slopeY[i] = accumNorm.fY;
+    }
+}
+
+// CPU-optimized functions requiring dispatch
+hsCpuFunctionDispatcher<plWaveSet7::accum_waves_ptr> plWaveSet7::accum_waves {
+    &plWaveSet7::accum_waves_fpu,
+    nullptr,                                    // SSE1
+    &plWaveSet7::accum_waves_sse2
+};
+
 void plWaveSet7::IUpdateWindDir(float dt)
 {
     fWindDir = -State().fWindDir;
@@ -1013,17 +1102,11 @@ void plWaveSet7::IUpdateRefObject()
     }
 }
 
-void plWaveSet7::IFloatBuoy(float dt, plSceneObject* so)
+void plWaveSet7::IFloatBuoy(float dt, plSceneObject* so, const hsPoint3& surfPos, const hsVector3& surfNorm)
 {
     // Compute force based on world bounds
     hsBounds3Ext wBnd = so->GetDrawInterface()->GetWorldBounds();
 
-    hsPoint3 pos(wBnd.GetCenter());
-    hsPoint3 surfPos(pos);
-    hsVector3 surfNorm;
-
-    EvalPoint(surfPos, surfNorm);
-
     // Direction of impulse is surfNorm. Magnitude is proportional to depth
     // (in an approximation lazy hackish way).
     hsPoint2 boxDepth;
@@ -1080,13 +1163,27 @@ void plWaveSet7::IFloatBuoy(float dt, plSceneObject* so)
 
 void plWaveSet7::IFloatBuoys(float dt)
 {
+    // Evaluate the surface under every buoy in one go, then push them around.
+    std::vector<plSceneObject*> buoys;
+    std::vector<hsPoint3> surfPos;
+    buoys.reserve(fBuoys.size());
+    surfPos.reserve(fBuoys.size());
     for (plSceneObject* buoy : fBuoys)
     {
         if (buoy && buoy->GetSimulationInterface() && buoy->GetSimulationInterface()->GetPhysical() && buoy->GetDrawInterface())
         {
-            IFloatBuoy(dt, buoy);
+            buoys.emplace_back(buoy);
+            surfPos.emplace_back(buoy->GetDrawInterface()->GetWorldBounds().GetCenter());
         }
     }
+    if (buoys.empty())
+        return;
+
+    std::vector<hsVector3> surfNorm(buoys.size());
+    EvalPoints(surfPos.data(), surfNorm.data(), buoys.size());
+
+    for (size_t i = 0; i < buoys.size(); i++)
+        IFloatBuoy(dt, buoys[i], surfPos[i], surfNorm[i]);
 }
 
 void plWaveSet7::IShiftCenter(plSceneObject* so) const
@@ -2912,18 +3009,31 @@ void plWaveSet7::IUpdateRipVShader(plPipeline* pipe, const hsMatrix44& l2w, cons
 {
     if( fRipVShader )
     {
-        fRipVShader->SetVector(plRipVS::kFrequency,
-            fWorldWaves[0].fFreq,
-            fWorldWaves[1].fFreq,
-            fWorldWaves[2].fFreq,
-            fWorldWaves[3].fFreq);
-
         fRipVShader->SetVector(plRipVS::kPhase,
             fWorldWaves[0].fPhase,
             fWorldWaves[1].fPhase,
             fWorldWaves[2].fPhase,
             fWorldWaves[3].fPhase);
 
+        fRipVShader->SetVector(plRipVS::kWindRot,
+            fWindDir.fY,
+            -fWindDir.fX,
+            fWindDir.fX,
+            0);
+
+        fRipVShader->SetFloat(plRipVS::kLifeConsts, 1, float(hsTimer::GetSysSeconds()));
+
+        // The rest only depends on the shape of the waves.
+        if( fRipVShaderSerial == fWaveShapeSerial )
+            return;
+        fRipVShaderSerial = fWaveShapeSerial;
+
+        fRipVShader->SetVector(plRipVS::kFrequency,
+            fWorldWaves[0].fFreq,
+            fWorldWaves[1].fFreq,
+            fWorldWaves[2].fFreq,
+            fWorldWaves[3].fFreq);
+
         fRipVShader->SetVector(plRipVS::kAmplitude,
             fWorldWaves[0].fAmplitude,
             fWorldWaves[1].fAmplitude,
@@ -2942,21 +3052,14 @@ void plWaveSet7::IUpdateRipVShader(plPipeline* pipe, const hsMatrix44& l2w, cons
             fWorldWaves[2].fDir.fY,
             fWorldWaves[3].fDir.fY);
 
-        fRipVShader->SetVector(plRipVS::kWindRot,
-            fWindDir.fY,
-            -fWindDir.fX,
-            fWindDir.fX,
-            0);
-
         fRipVShader->SetVector(plRipVS::kLengths,
             fWorldWaves[0].fLength,
             fWorldWaves[1].fLength,
             fWorldWaves[2].fLength,
             fWorldWaves[3].fLength);
 
-        fRipVShader->SetFloat(plRipVS::kLifeConsts, 1, float(hsTimer::GetSysSeconds()));
         float normQ[kNumWaves];
-        int i; 
+        int i;
         for( i = 0; i < kNumWaves; i++ )
         {
             normQ[i] = GeoState().fChop / (hsConstants::two_pi<float> * GeoState().fAmpOverLen * kNumWaves);
@@ -2989,18 +3092,37 @@ void plWaveSet7::IUpdateDecVShader(int t, plPipeline* pipe)
     plShader* shader = fDecalVShaders[t];
     if( shader )
     {
-        shader->SetVector(plWaveDecVS::kFrequency,
-            fWorldWaves[0].fFreq,
-            fWorldWaves[1].fFreq,
-            fWorldWaves[2].fFreq,
-            fWorldWaves[3].fFreq);
-
         shader->SetVector(plWaveDecVS::kPhase,
             fWorldWaves[0].fPhase,
             fWorldWaves[1].fPhase,
             fWorldWaves[2].fPhase,
             fWorldWaves[3].fPhase);
 
+        if( t == kDecalVEnv )
+        {
+            hsPoint3 worldCam = pipe->GetViewTransform().GetCameraToWorld().GetTranslate();
+
+            hsPoint3 envCenter(State().fEnvCenter);
+
+            float envRadius = State().fEnvRadius;
+
+            hsVector3 camToCen(&envCenter, &worldCam);
+            float G = camToCen.MagnitudeSquared() - envRadius * envRadius;
+            shader->SetVectorW(plWaveDecVS::kEnvAdjust, camToCen, G);
+
+        }
+
+        // The rest only depends on the shape of the waves.
+        if( fDecalVShaderSerial[t] == fWaveShapeSerial )
+            return;
+        fDecalVShaderSerial[t] = fWaveShapeSerial;
+
+        shader->SetVector(plWaveDecVS::kFrequency,
+            fWorldWaves[0].fFreq,
+            fWorldWaves[1].fFreq,
+            fWorldWaves[2].fFreq,
+            fWorldWaves[3].fFreq);
+
         shader->SetVector(plWaveDecVS::kAmplitude,
             fWorldWaves[0].fAmplitude,
             fWorldWaves[1].fAmplitude,
@@ -3025,20 +3147,6 @@ void plWaveSet7::IUpdateDecVShader(int t, plPipeline* pipe)
             fWorldWaves[2].fLength,
             fWorldWaves[3].fLength);
 
-        if( t == kDecalVEnv )
-        {
-            hsPoint3 worldCam = pipe->GetViewTransform().GetCameraToWorld().GetTranslate();
-
-            hsPoint3 envCenter(State().fEnvCenter);
-
-            float envRadius = State().fEnvRadius;
-
-            hsVector3 camToCen(&envCenter, &worldCam);
-            float G = camToCen.MagnitudeSquared() - envRadius * envRadius;
-            shader->SetVectorW(plWaveDecVS::kEnvAdjust, camToCen, G);
-
-        }
-
         float normQ[kNumWaves];
         int i;
         for( i = 0; i < kNumWaves; i++ )
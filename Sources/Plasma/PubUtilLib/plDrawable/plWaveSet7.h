@@ -45,6 +45,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 #include <vector>
 
+#include "hsCpuID.h"
 #include "hsGeometry3.h"
 #include "pnEncryption/plRandom.h"
 #include "hsBounds.h"
@@ -275,6 +276,17 @@ protected:
     plShader*                       fDecalVShaders[kNumDecalVShaders];
     plShader*                       fDecalPShaders[kNumDecalPShaders];
 
+    // Everything about the geometric waves except their phase only changes
+    // on transitions, so the vertex shaders remember which version of the
+    // wave shape they last saw and skip rebuilding those constants until
+    // it moves on.
+    uint32_t                        fWaveShapeSerial;
+    plWorldWaveData7                fLastWaveShape[kNumWaves];
+    float                           fLastChop;
+    float                           fLastAmpOverLen;
+    uint32_t                        fRipVShaderSerial;
+    uint32_t                        fDecalVShaderSerial[kNumDecalVShaders];
+
     // Graph shore stuff
     plMipmap*                       fGraphShoreTex;
     plMipmap*                       fBubbleShoreTex;
@@ -338,6 +350,7 @@ protected:
     void            ICalcScale();
     void            IUpdateWaves(float dt);
     void            IUpdateWave(float dt, int i);
+    void            ICheckWaveShape();
     bool            IAnyBoundsVisible(plPipeline* pipe) const;
 
     void            IInitWave(int i);
@@ -348,7 +361,7 @@ protected:
 
     void            IShiftCenter(plSceneObject* so) const;
     void            IFloatBuoys(float dt);
-    void            IFloatBuoy(float dt, plSceneObject* so);
+    void            IFloatBuoy(float dt, plSceneObject* so, const hsPoint3& surfPos, const hsVector3& surfNorm);
 
     // Bookkeeping
     void    IAddTarget(const plKey& key);
@@ -506,6 +519,8 @@ public:
     void Write(hsStream* stream, hsResMgr* mgr) override;
 
     float            EvalPoint(hsPoint3& pos, hsVector3& norm);
+    // Same as EvalPoint, for a whole array of points at once.
+    void            EvalPoints(hsPoint3* pos, hsVector3* norm, size_t count);
 
     // Getters and Setters for Python twiddling
     //
@@ -655,6 +670,20 @@ public:
     void StartGraph();
     void StopGraph();
     bool Graphing() const { return fStatusGraph != nullptr; }
+
+protected:
+    // CPU-optimized sum of the geometric waves at each point. Writes out the
+    // height offset from the water plane and the X and Y slopes of the surface.
+    typedef void(*accum_waves_ptr)(const plWorldWave7* waves, const hsPoint3* pos,
+                                   float* height, float* slopeX, float* slopeY, size_t count);
+
+    static void accum_waves_fpu(const plWorldWave7* waves, const hsPoint3* pos,
+                                float* height, float* slopeX, float* slopeY, size_t count);
+    static void accum_waves_sse2(const plWorldWave7* waves, const hsPoint3* pos,
+                                 float* height, float* slopeX, float* slopeY, size_t count);
+
+private:
+    static hsCpuFunctionDispatcher<accum_waves_ptr> accum_waves;
 };
 
 #endif // plWaveSet7_inc
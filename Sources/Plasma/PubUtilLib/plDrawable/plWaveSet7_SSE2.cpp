@@ -0,0 +1,110 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include "plWaveSet7.h"
+#include "hsFastMath.h"
+
+#include "hsSIMD.h"
+
+void plWaveSet7::accum_waves_sse2(const plWorldWave7* waves, const hsPoint3* pos,
+                                  float* height, float* slopeX, float* slopeY, size_t count)
+{
+#ifdef HAVE_SSE2
+    static_assert(kNumWaves == 4, "One wave per lane");
+
+    // Spread the waves across the lanes, so each point is a single pass.
+    const __m128 dirX = _mm_setr_ps(waves[0].fDir.fX, waves[1].fDir.fX, waves[2].fDir.fX, waves[3].fDir.fX);
+    const __m128 dirY = _mm_setr_ps(waves[0].fDir.fY, waves[1].fDir.fY, waves[2].fDir.fY, waves[3].fDir.fY);
+    const __m128 freq = _mm_setr_ps(waves[0].fFreq, waves[1].fFreq, waves[2].fFreq, waves[3].fFreq);
+    const __m128 phase = _mm_setr_ps(waves[0].fPhase, waves[1].fPhase, waves[2].fPhase, waves[3].fPhase);
+    const __m128 amp = _mm_setr_ps(waves[0].fAmplitude, waves[1].fAmplitude, waves[2].fAmplitude, waves[3].fAmplitude);
+
+    // Slope contribution of each wave is dir * cos * -freq * amp.
+    const __m128 negFreqAmp = _mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(freq, amp));
+    const __m128 slopeXScale = _mm_mul_ps(dirX, negFreqAmp);
+    const __m128 slopeYScale = _mm_mul_ps(dirY, negFreqAmp);
+
+    const __m128 twoPi = _mm_set1_ps(hsConstants::two_pi<float>);
+    const __m128 invTwoPi = _mm_set1_ps(1.f / hsConstants::two_pi<float>);
+    const __m128 one = _mm_set1_ps(1.f);
+    // Largest float below 2pi, so rounding can't walk us off the end of the table.
+    const __m128 maxRads = _mm_set1_ps(6.2831850f);
+
+    alignas(16) float rads[4];
+    alignas(16) float sins[4];
+    alignas(16) float coss[4];
+
+    for (size_t i = 0; i < count; i++) {
+        __m128 px = _mm_set1_ps(pos[i].fX);
+        __m128 py = _mm_set1_ps(pos[i].fY);
+
+        __m128 dist = _mm_add_ps(_mm_mul_ps(px, dirX), _mm_mul_ps(py, dirY));
+        dist = _mm_add_ps(_mm_mul_ps(dist, freq), phase);
+
+        // Wrap into [0..2pi), same as SinCosAppr does with fmodf.
+        __m128 q = _mm_mul_ps(dist, invTwoPi);
+        __m128 fl = _mm_cvtepi32_ps(_mm_cvttps_epi32(q));
+        fl = _mm_sub_ps(fl, _mm_and_ps(_mm_cmpgt_ps(fl, q), one));
+        dist = _mm_sub_ps(dist, _mm_mul_ps(fl, twoPi));
+        dist = _mm_min_ps(_mm_max_ps(dist, _mm_setzero_ps()), maxRads);
+
+        _mm_store_ps(rads, dist);
+        for (int j = 0; j < kNumWaves; j++)
+            hsFastMath::SinCosInRangeAppr(rads[j], sins[j], coss[j]);
+
+        __m128 s = _mm_mul_ps(_mm_load_ps(sins), amp);
+        __m128 c = _mm_load_ps(coss);
+        __m128 sx = _mm_mul_ps(c, slopeXScale);
+        __m128 sy = _mm_mul_ps(c, slopeYScale);
+
+        // Horizontal sums. Transpose so one add chain finishes all three.
+        __m128 zero = _mm_setzero_ps();
+        _MM_TRANSPOSE4_PS(s, sx, sy, zero);
+        __m128 sum = _mm_add_ps(_mm_add_ps(s, sx), _mm_add_ps(sy, zero));
+
+        _mm_store_ps(rads, sum);
+        height[i] = rads[0];
+        slopeX[i] = rads[1];
+        slopeY[i] = rads[2];
+    }
+#endif // HAVE_SSE2
+}
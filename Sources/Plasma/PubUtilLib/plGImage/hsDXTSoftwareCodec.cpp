@@ -44,14 +44,25 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "hsColorRGBA.h"
 #include "hsDXTSoftwareCodec.h"
 #include "hsEndian.h"
+#include "hsParallel.h"
 #include "plMipmap.h"
 #include "hsCodecManager.h"
 
+#include <algorithm>
+
 #define SWAPVARS( x, y, t ) { t = x; x = y; y = t; }
 
 // This is the color depth that we decompress to by default if we're not told otherwise
 #define kDefaultDepth   32
 
+// Smallest share of a mip level worth handing to another thread, in 4x4 blocks
+static constexpr size_t kMinBlocksPerTask = 64;
+
+static size_t IRowGrain(uint32_t blocksWide)
+{
+    return std::max<size_t>(1, kMinBlocksPerTask / std::max<uint32_t>(1, blocksWide));
+}
+
 
 bool hsDXTSoftwareCodec::fRegistered = false;
 
@@ -874,6 +885,22 @@ void    hsDXTSoftwareCodec::IUncompressMipmapDXT5To16Weird( plMipmap *destBMap,
     }
 }
 
+//// UncompressLevelSerial32 //////////////////////////////////////////////////
+//  Same decode as UncompressMipmap for 32-bit ARGB, but all block rows in one
+//  pass on the calling thread.
+
+void    hsDXTSoftwareCodec::UncompressLevelSerial32( plMipmap *destBMap, plMipmap *srcBMap )
+{
+    hsAssert( destBMap->fUncompressedInfo.fType == plMipmap::UncompressedInfo::kRGB8888,
+              "Serial decode only writes ARGB8888 mipmaps" );
+
+    uint32_t blocksHigh = srcBMap->GetCurrHeight() >> 2;
+    if( srcBMap->fDirectXInfo.fCompressionType == plMipmap::DirectXInfo::kDXT5 )
+        IUncompressRowsDXT5To32( destBMap, srcBMap, 0, blocksHigh );
+    else if( srcBMap->fDirectXInfo.fCompressionType == plMipmap::DirectXInfo::kDXT1 )
+        IUncompressRowsDXT1To32( destBMap, srcBMap, 0, blocksHigh );
+}
+
 //// IUncompressMipmapDXT5To32 ////////////////////////////////////////////////
 //
 //  UncompressBitmap internal call for DXT5 compression. DXT5 is 3-bit linear
@@ -886,6 +913,17 @@ void    hsDXTSoftwareCodec::IUncompressMipmapDXT5To16Weird( plMipmap *destBMap,
 //                          us only about 10% :(
 
 void    hsDXTSoftwareCodec::IUncompressMipmapDXT5To32( plMipmap *destBMap, plMipmap *srcBMap )
+{
+    /// Block rows decode independently, so split them across workers
+    uint32_t blocksWide = srcBMap->GetCurrWidth() >> 2;
+    uint32_t blocksHigh = srcBMap->GetCurrHeight() >> 2;
+    hsParallelFor(blocksHigh, IRowGrain(blocksWide), [this, destBMap, srcBMap](size_t begin, size_t end) {
+        IUncompressRowsDXT5To32(destBMap, srcBMap, (uint32_t)begin, (uint32_t)end);
+    });
+}
+
+void    hsDXTSoftwareCodec::IUncompressRowsDXT5To32( plMipmap *destBMap, plMipmap *srcBMap,
+                                           uint32_t rowBegin, uint32_t rowEnd )
 {
     uint16_t      *srcData;
     uint32_t      *destData, destBlock[ 16 ];
@@ -903,14 +941,15 @@ void    hsDXTSoftwareCodec::IUncompressMipmapDXT5To32( plMipmap *destBMap, plMip
     /// Setup some nifty stuff
     hsAssert( ( srcBMap->GetCurrWidth() & 3 ) == 0, "Bitmap width must be multiple of 4" );
     hsAssert( ( srcBMap->GetCurrHeight() & 3 ) == 0, "Bitmap height must be multiple of 4" );
-    numBlocks = ( srcBMap->GetCurrWidth() * srcBMap->GetCurrHeight() ) >> 4;
+    numBlocks = ( rowEnd - rowBegin ) * ( srcBMap->GetCurrWidth() >> 2 );
 
     blockSize = srcBMap->fDirectXInfo.fBlockSize >> 1; // In 16-bit words
-    srcData = (uint16_t *)srcBMap->GetCurrLevelPtr();
+    srcData = (uint16_t *)srcBMap->GetCurrLevelPtr() + rowBegin * ( srcBMap->GetCurrWidth() >> 2 ) * blockSize;
     // Note our trick here to make sure nothing breaks if GetAddr32's 
     // formula changes
     bMapStride = (uint32_t)( destBMap->GetAddr32( 0, 1 ) - destBMap->GetAddr32( 0, 0 ) );
-    x = y = 0;
+    x = 0;
+    y = rowBegin << 2;
 
 
     /// Loop through the # of blocks (width*height / 16-pixel-blocks)
@@ -1397,8 +1436,18 @@ void    hsDXTSoftwareCodec::IUncompressMipmapDXT1To16Weird( plMipmap *destBMap,
 //
 //  7.31.2000 - M.Burrack - Created, based on old code (uncredited)
 
-void    hsDXTSoftwareCodec::IUncompressMipmapDXT1To32( plMipmap *destBMap, 
-                                                   plMipmap *srcBMap )
+void    hsDXTSoftwareCodec::IUncompressMipmapDXT1To32( plMipmap *destBMap, plMipmap *srcBMap )
+{
+    /// Block rows decode independently, so split them across workers
+    uint32_t blocksWide = srcBMap->GetCurrWidth() >> 2;
+    uint32_t blocksHigh = srcBMap->GetCurrHeight() >> 2;
+    hsParallelFor(blocksHigh, IRowGrain(blocksWide), [this, destBMap, srcBMap](size_t begin, size_t end) {
+        IUncompressRowsDXT1To32(destBMap, srcBMap, (uint32_t)begin, (uint32_t)end);
+    });
+}
+
+void    hsDXTSoftwareCodec::IUncompressRowsDXT1To32( plMipmap *destBMap, plMipmap *srcBMap,
+                                           uint32_t rowBegin, uint32_t rowEnd )
 {
     uint16_t      *srcData, tempW1, tempW2;
     uint32_t      *destData, destBlock[ 16 ];
@@ -1411,14 +1460,15 @@ void    hsDXTSoftwareCodec::IUncompressMipmapDXT1To32( plMipmap *destBMap,
     /// Setup some nifty stuff
     hsAssert( ( srcBMap->GetCurrWidth() & 3 ) == 0, "Bitmap width must be multiple of 4" );
     hsAssert( ( srcBMap->GetCurrHeight() & 3 ) == 0, "Bitmap height must be multiple of 4" );
-    numBlocks = ( srcBMap->GetCurrWidth() * srcBMap->GetCurrHeight() ) >> 4;
+    numBlocks = ( rowEnd - rowBegin ) * ( srcBMap->GetCurrWidth() >> 2 );
 
     blockSize = srcBMap->fDirectXInfo.fBlockSize >> 1; // In 16-bit words
-    srcData = (uint16_t *)srcBMap->GetCurrLevelPtr();
+    srcData = (uint16_t *)srcBMap->GetCurrLevelPtr() + rowBegin * ( srcBMap->GetCurrWidth() >> 2 ) * blockSize;
     // Note our trick here to make sure nothing breaks if GetAddr32's 
     // formula changes
     bMapStride = (uint32_t)( destBMap->GetAddr32( 0, 1 ) - destBMap->GetAddr32( 0, 0 ) );
-    x = y = 0;
+    x = 0;
+    y = rowBegin << 2;
 
 
     /// Loop through the # of blocks (width*height / 16-pixel-blocks)
@@ -1928,292 +1978,312 @@ uint8_t   hsDXTSoftwareCodec::IMixEqualInten( uint8_t color1, uint8_t color2 )
 
 void hsDXTSoftwareCodec::CompressMipmapLevel( plMipmap *uncompressed, plMipmap *compressed )
 {
-    uint32_t *compressedImage = (uint32_t *)compressed->GetCurrLevelPtr();
-    int32_t x, y;
+    // Every block is independent, so split the level up by rows of blocks
     int32_t xMax = uncompressed->GetCurrWidth() >> 2;
     int32_t yMax = uncompressed->GetCurrHeight() >> 2;
-    for (x = 0; x < xMax; ++x)
-    {
-        for (y = 0; y < yMax; ++y)
+    hsParallelFor(yMax, IRowGrain(xMax), [this, uncompressed, compressed, xMax](size_t begin, size_t end) {
+        for (int32_t y = int32_t(begin); y < int32_t(end); ++y)
         {
-            uint8_t maxAlpha = 0;
-            uint8_t minAlpha = 255;
-            uint8_t oldMaxAlpha = 0;
-            uint8_t oldMinAlpha = 255;
-            uint8_t alpha[8];
-            int32_t maxDistance = 0;
-            hsRGBAColor32 color[4];
-            bool hasTransparency = false;
-
-            int32_t xx, yy;
-            for (xx = 0; xx < 4; ++xx)
-            {
-                for (yy = 0; yy < 4; ++yy)
-                {
-                    hsRGBAColor32* pixel = (hsRGBAColor32*)uncompressed->GetAddr32(4 * x + xx, 4 * y + yy);
-                    uint8_t pixelAlpha = pixel->a;
-                    if (pixelAlpha != 255)
-                    {
-                        hasTransparency = true;
-                    }
-
-                    if (compressed->fDirectXInfo.fCompressionType == plMipmap::DirectXInfo::kDXT5)
-                    {
-                        if (pixelAlpha > maxAlpha)
-                        {
-                            maxAlpha = pixelAlpha;
-                        }
-                        
-                        if ((pixelAlpha > oldMaxAlpha) && (pixelAlpha < 255))
-                        {
-                            oldMaxAlpha = pixelAlpha;
-                        }
+            for (int32_t x = 0; x < xMax; ++x)
+                ICompressBlock(uncompressed, compressed, x, y, xMax);
+        }
+    });
+}
 
-                        if (pixelAlpha < minAlpha)
-                        {
-                            minAlpha = pixelAlpha;
-                        }
+void hsDXTSoftwareCodec::ICompressBlock( plMipmap *uncompressed, plMipmap *compressed, int32_t x, int32_t y, int32_t xMax )
+{
+    uint8_t maxAlpha = 0;
+    uint8_t minAlpha = 255;
+    uint8_t oldMaxAlpha = 0;
+    uint8_t oldMinAlpha = 255;
+    uint8_t alpha[8];
+    hsRGBAColor32 color[4];
+    bool hasTransparency = false;
+
+    // Pull the block in once, in the same column-major order we walk it in below
+    hsRGBAColor32 pixels[16];
+    int32_t xx, yy;
+    for (xx = 0; xx < 4; ++xx)
+    {
+        for (yy = 0; yy < 4; ++yy)
+        {
+            pixels[4 * xx + yy] = *(hsRGBAColor32*)uncompressed->GetAddr32(4 * x + xx, 4 * y + yy);
+        }
+    }
 
-                        if ((pixelAlpha < oldMinAlpha) && (pixelAlpha > 0))
-                        {
-                            oldMinAlpha = minAlpha;
-                        }
-                    }
-                    
-                    int32_t xx2, yy2;
-                    for (xx2 = 0; xx2 < 4; ++xx2)
-                    {
-                        for (yy2 = 0; yy2 < 4; ++yy2)
-                        {
-                            hsRGBAColor32* pixel1 = (hsRGBAColor32*)uncompressed->GetAddr32(4 * x + xx, 4 * y + yy);
-                            hsRGBAColor32* pixel2 = (hsRGBAColor32*)uncompressed->GetAddr32(4 * x + xx2, 4 * y + yy2);
-                            
-                            int32_t distance = ColorDistanceARGBSquared(*pixel1, *pixel2);
-                            if (distance >= maxDistance)
-                            {
-                                maxDistance = distance;
-                                color[0] = *pixel1;
-                                color[1] = *pixel2;
-                            }
-                        } // for yy2
-                    } // for xx2
-                } // for yy
-            } // for xx
-            
-            if (oldMinAlpha == 255)
+    for (xx = 0; xx < 4; ++xx)
+    {
+        for (yy = 0; yy < 4; ++yy)
+        {
+            const hsRGBAColor32* pixel = &pixels[4 * xx + yy];
+            uint8_t pixelAlpha = pixel->a;
+            if (pixelAlpha != 255)
             {
-                hsAssert(oldMaxAlpha == 0, "Weirdness in oldMaxAlpha hsDXTSoftwareCodec::CompressBitmap.");
-                oldMinAlpha = 0;
-                oldMaxAlpha = 255;
+                hasTransparency = true;
             }
 
             if (compressed->fDirectXInfo.fCompressionType == plMipmap::DirectXInfo::kDXT5)
             {
-                if ((maxAlpha == 255) && (minAlpha == 0))
+                if (pixelAlpha > maxAlpha)
                 {
-                    hsAssert(oldMinAlpha <= oldMaxAlpha, "Min > Max in hsDXTSoftwareCodec::CompressBitmap 1.");
-                    alpha[0] = oldMinAlpha;
-                    alpha[1] = oldMaxAlpha;
-                    alpha[2] = (4 * alpha[0] + alpha[1]) / 5;      // Bit code 010
-                    alpha[3] = (3 * alpha[0] + 2 * alpha[1]) / 5;  // Bit code 011    
-                    alpha[4] = (2 * alpha[0] + 3 * alpha[1]) / 5;  // Bit code 100    
-                    alpha[5] = (alpha[0] + 4 * alpha[1]) / 5;      // Bit code 101
-                    alpha[6] = 0;                                // Bit code 110
-                    alpha[7] = 255;                              // Bit code 111
+                    maxAlpha = pixelAlpha;
                 }
-                else if (maxAlpha == minAlpha)
+                
+                if ((pixelAlpha > oldMaxAlpha) && (pixelAlpha < 255))
                 {
-                    alpha[0] = minAlpha;
-                    alpha[1] = maxAlpha;
-                    alpha[2] = (4 * alpha[0] + alpha[1]) / 5;      // Bit code 010
-                    alpha[3] = (3 * alpha[0] + 2 * alpha[1]) / 5;  // Bit code 011    
-                    alpha[4] = (2 * alpha[0] + 3 * alpha[1]) / 5;  // Bit code 100    
-                    alpha[5] = (alpha[0] + 4 * alpha[1]) / 5;      // Bit code 101
-                    alpha[6] = 0;                                // Bit code 110
-                    alpha[7] = 255;                              // Bit code 111
+                    oldMaxAlpha = pixelAlpha;
                 }
-                else
+
+                if (pixelAlpha < minAlpha)
                 {
-                    hsAssert(minAlpha < maxAlpha, "Min => Max in hsDXTSoftwareCodec::CompressBitmap 3.");
-                    alpha[0] = maxAlpha;
-                    alpha[1] = minAlpha;
-                    alpha[2] = (6 * alpha[0] + alpha[1]) / 7;      // bit code 010
-                    alpha[3] = (5 * alpha[0] + 2 * alpha[1]) / 7;  // Bit code 011    
-                    alpha[4] = (4 * alpha[0] + 3 * alpha[1]) / 7;  // Bit code 100    
-                    alpha[5] = (3 * alpha[0] + 4 * alpha[1]) / 7;  // Bit code 101
-                    alpha[6] = (2 * alpha[0] + 5 * alpha[1]) / 7;  // Bit code 110    
-                    alpha[7] = (alpha[0] + 6 * alpha[1]) / 7;      // Bit code 111
+                    minAlpha = pixelAlpha;
                 }
-            }
-            
-            uint32_t encoding;
-            uint16_t shortColor[2];
-            shortColor[0] = Color32To16(color[0]);
-            shortColor[1] = Color32To16(color[1]);
-            if ((shortColor[0] == shortColor[1]) ||
-                ((compressed->fDirectXInfo.fCompressionType == plMipmap::DirectXInfo::kDXT1) &&
-                hasTransparency))
-            {
-                encoding = kThreeColorEncoding;
 
-                if (shortColor[0] > shortColor[1])
+                if ((pixelAlpha < oldMinAlpha) && (pixelAlpha > 0))
                 {
-                    uint16_t temp = shortColor[1];
-                    shortColor[1] = shortColor[0];
-                    shortColor[0] = temp;
-                    
-                    hsRGBAColor32 temp32 = color[1];
-                    color[1] = color[0];
-                    color[0] = temp32;
+                    oldMinAlpha = minAlpha;
                 }
+            }
+        } // for yy
+    } // for xx
+
+    // The two colors furthest apart become the endpoints
+    uint32_t first, second;
+    find_endpoints.call(pixels, first, second);
+    color[0] = pixels[first];
+    color[1] = pixels[second];
+    
+    if (oldMinAlpha == 255)
+    {
+        hsAssert(oldMaxAlpha == 0, "Weirdness in oldMaxAlpha hsDXTSoftwareCodec::CompressBitmap.");
+        oldMinAlpha = 0;
+        oldMaxAlpha = 255;
+    }
 
-                color[2] = BlendColors32(1, color[0], 1, color[1]);
+    if (compressed->fDirectXInfo.fCompressionType == plMipmap::DirectXInfo::kDXT5)
+    {
+        if ((maxAlpha == 255) && (minAlpha == 0))
+        {
+            hsAssert(oldMinAlpha <= oldMaxAlpha, "Min > Max in hsDXTSoftwareCodec::CompressBitmap 1.");
+            alpha[0] = oldMinAlpha;
+            alpha[1] = oldMaxAlpha;
+            alpha[2] = (4 * alpha[0] + alpha[1]) / 5;      // Bit code 010
+            alpha[3] = (3 * alpha[0] + 2 * alpha[1]) / 5;  // Bit code 011    
+            alpha[4] = (2 * alpha[0] + 3 * alpha[1]) / 5;  // Bit code 100    
+            alpha[5] = (alpha[0] + 4 * alpha[1]) / 5;      // Bit code 101
+            alpha[6] = 0;                                // Bit code 110
+            alpha[7] = 255;                              // Bit code 111
+        }
+        else if (maxAlpha == minAlpha)
+        {
+            alpha[0] = minAlpha;
+            alpha[1] = maxAlpha;
+            alpha[2] = (4 * alpha[0] + alpha[1]) / 5;      // Bit code 010
+            alpha[3] = (3 * alpha[0] + 2 * alpha[1]) / 5;  // Bit code 011    
+            alpha[4] = (2 * alpha[0] + 3 * alpha[1]) / 5;  // Bit code 100    
+            alpha[5] = (alpha[0] + 4 * alpha[1]) / 5;      // Bit code 101
+            alpha[6] = 0;                                // Bit code 110
+            alpha[7] = 255;                              // Bit code 111
+        }
+        else
+        {
+            hsAssert(minAlpha < maxAlpha, "Min => Max in hsDXTSoftwareCodec::CompressBitmap 3.");
+            alpha[0] = maxAlpha;
+            alpha[1] = minAlpha;
+            alpha[2] = (6 * alpha[0] + alpha[1]) / 7;      // bit code 010
+            alpha[3] = (5 * alpha[0] + 2 * alpha[1]) / 7;  // Bit code 011    
+            alpha[4] = (4 * alpha[0] + 3 * alpha[1]) / 7;  // Bit code 100    
+            alpha[5] = (3 * alpha[0] + 4 * alpha[1]) / 7;  // Bit code 101
+            alpha[6] = (2 * alpha[0] + 5 * alpha[1]) / 7;  // Bit code 110    
+            alpha[7] = (alpha[0] + 6 * alpha[1]) / 7;      // Bit code 111
+        }
+    }
+    
+    uint32_t encoding;
+    uint16_t shortColor[2];
+    shortColor[0] = Color32To16(color[0]);
+    shortColor[1] = Color32To16(color[1]);
+    if ((shortColor[0] == shortColor[1]) ||
+        ((compressed->fDirectXInfo.fCompressionType == plMipmap::DirectXInfo::kDXT1) &&
+        hasTransparency))
+    {
+        encoding = kThreeColorEncoding;
 
-                hsRGBAColor32 black;
-                black.Set(0, 0, 0, 0);
+        if (shortColor[0] > shortColor[1])
+        {
+            uint16_t temp = shortColor[1];
+            shortColor[1] = shortColor[0];
+            shortColor[0] = temp;
+            
+            hsRGBAColor32 temp32 = color[1];
+            color[1] = color[0];
+            color[0] = temp32;
+        }
 
-                color[3] = black;
-            }
-            else
-            {
-                encoding = kFourColorEncoding;
+        color[2] = BlendColors32(1, color[0], 1, color[1]);
 
-                if (shortColor[0] < shortColor[1])
-                {
-                    uint16_t temp = shortColor[1];
-                    shortColor[1] = shortColor[0];
-                    shortColor[0] = temp;
-                    
-                    hsRGBAColor32 temp32 = color[1];
-                    color[1] = color[0];
-                    color[0] = temp32;
-                }
+        hsRGBAColor32 black;
+        black.Set(0, 0, 0, 0);
 
-                color[2] = BlendColors32(2, color[0], 1, color[1]);
-                color[3] = BlendColors32(1, color[0], 2, color[1]);
-            }
+        color[3] = black;
+    }
+    else
+    {
+        encoding = kFourColorEncoding;
+
+        if (shortColor[0] < shortColor[1])
+        {
+            uint16_t temp = shortColor[1];
+            shortColor[1] = shortColor[0];
+            shortColor[0] = temp;
             
-            // Process each pixel in block
-            uint32_t blockSize = compressed->fDirectXInfo.fBlockSize;
-            uint32_t *block = &compressedImage[(x + xMax * y) * (blockSize >> 2)];
-            uint8_t *byteBlock = (uint8_t *)block;
-            uint8_t *alphaBlock = nullptr;
-            uint16_t *colorBlock = nullptr;
-            if (compressed->fDirectXInfo.fCompressionType == plMipmap::DirectXInfo::kDXT5)
+            hsRGBAColor32 temp32 = color[1];
+            color[1] = color[0];
+            color[0] = temp32;
+        }
+
+        color[2] = BlendColors32(2, color[0], 1, color[1]);
+        color[3] = BlendColors32(1, color[0], 2, color[1]);
+    }
+    
+    // Process each pixel in block
+    uint32_t blockSize = compressed->fDirectXInfo.fBlockSize;
+    uint32_t *compressedImage = (uint32_t *)compressed->GetCurrLevelPtr();
+    uint32_t *block = &compressedImage[(x + xMax * y) * (blockSize >> 2)];
+    uint8_t *byteBlock = (uint8_t *)block;
+    uint8_t *alphaBlock = nullptr;
+    uint16_t *colorBlock = nullptr;
+    if (compressed->fDirectXInfo.fCompressionType == plMipmap::DirectXInfo::kDXT5)
+    {
+        alphaBlock = byteBlock;
+        colorBlock = (uint16_t *)(byteBlock + 8);
+        alphaBlock[0] = 0;
+        alphaBlock[1] = 0;
+        alphaBlock[2] = 0;
+        alphaBlock[3] = 0;
+        alphaBlock[4] = 0;
+        alphaBlock[5] = 0;
+        alphaBlock[6] = 0;
+        alphaBlock[7] = 0;
+    }
+    else if (compressed->fDirectXInfo.fCompressionType == plMipmap::DirectXInfo::kDXT1)
+    {
+        alphaBlock = nullptr;
+        colorBlock = (uint16_t *)(byteBlock);
+    }
+    else
+    {
+        hsAssert(false, "Unrecognized compression scheme.");
+    }
+    
+    colorBlock[0] = 0;
+    colorBlock[1] = 0;
+    colorBlock[2] = 0;
+    colorBlock[3] = 0;
+    for (xx = 0; xx < 4; ++xx)
+    {
+        for (yy = 0; yy < 4; ++yy)
+        {
+            const hsRGBAColor32* pixel = &pixels[4 * xx + yy];
+            uint8_t pixelAlpha = pixel->a;
+            if (alphaBlock)
             {
-                alphaBlock = byteBlock;
-                colorBlock = (uint16_t *)(byteBlock + 8);
-                alphaBlock[0] = 0;
-                alphaBlock[1] = 0;
-                alphaBlock[2] = 0;
-                alphaBlock[3] = 0;
-                alphaBlock[4] = 0;
-                alphaBlock[5] = 0;
-                alphaBlock[6] = 0;
-                alphaBlock[7] = 0;
+                uint32_t alphaIndex = 0;
+                uint32_t alphaDistance = abs(pixelAlpha - alpha[0]);
+                
+                int32_t i;
+                for (i = 1; i < 8; i++)
+                {
+                    uint32_t distance = abs(pixelAlpha - alpha[i]);
+                    if (distance < alphaDistance)
+                    {
+                        alphaIndex = i;
+                        alphaDistance = distance;
+                    }
+                }
+                
+                if (yy < 2)
+                {
+                    uint32_t alphaShift = 3 * (4 * yy + xx);
+                    uint32_t threeAlphaBytes = alphaIndex << alphaShift;
+                    alphaBlock[2] |= (threeAlphaBytes & 0xff);
+                    alphaBlock[3] |= ((threeAlphaBytes >> 8) & 0xff);
+                    alphaBlock[4] |= ((threeAlphaBytes >> 16) & 0xff);
+                }
+                else
+                {
+                    uint32_t alphaShift = 3 * (4 * (yy - 2) + xx);
+                    uint32_t threeAlphaBytes = alphaIndex << alphaShift;
+                    alphaBlock[5] |= (threeAlphaBytes & 0xff);
+                    alphaBlock[6] |= ((threeAlphaBytes >> 8) & 0xff);
+                    alphaBlock[7] |= ((threeAlphaBytes >> 16) & 0xff);
+                }
             }
-            else if (compressed->fDirectXInfo.fCompressionType == plMipmap::DirectXInfo::kDXT1)
+            
+            uint32_t colorIndex = 0;
+            uint32_t colorDistance = ColorDistanceARGBSquared(*pixel, color[0]);
+            
+            if ((encoding == kThreeColorEncoding) &&
+                (pixelAlpha == 0))
             {
-                alphaBlock = nullptr;
-                colorBlock = (uint16_t *)(byteBlock);
+                colorIndex = 3;
             }
             else
             {
-                hsAssert(false, "Unrecognized compression scheme.");
-            }
-            
-            colorBlock[0] = 0;
-            colorBlock[1] = 0;
-            colorBlock[2] = 0;
-            colorBlock[3] = 0;
-            for (xx = 0; xx < 4; ++xx)
-            {
-                for (yy = 0; yy < 4; ++yy)
+                int32_t i;
+                int32_t colorMax = (encoding == kThreeColorEncoding) ? 3 : 4;
+                for (i = 1; i < colorMax; i++)
                 {
-                    hsRGBAColor32* pixel = (hsRGBAColor32*)uncompressed->GetAddr32(4 * x + xx, 4 * y + yy);
-                    uint8_t pixelAlpha = pixel->a;
-                    if (alphaBlock)
+                    uint32_t distance = ColorDistanceARGBSquared(*pixel, color[i]);
+                    if (distance < colorDistance)
                     {
-                        uint32_t alphaIndex = 0;
-                        uint32_t alphaDistance = abs(pixelAlpha - alpha[0]);
-                        
-                        int32_t i;
-                        for (i = 1; i < 8; i++)
-                        {
-                            uint32_t distance = abs(pixelAlpha - alpha[i]);
-                            if (distance < alphaDistance)
-                            {
-                                alphaIndex = i;
-                                alphaDistance = distance;
-                            }
-                        }
-                        
-                        if (yy < 2)
-                        {
-                            uint32_t alphaShift = 3 * (4 * yy + xx);
-                            uint32_t threeAlphaBytes = alphaIndex << alphaShift;
-                            alphaBlock[2] |= (threeAlphaBytes & 0xff);
-                            alphaBlock[3] |= ((threeAlphaBytes >> 8) & 0xff);
-                            alphaBlock[4] |= ((threeAlphaBytes >> 16) & 0xff);
-                        }
-                        else
-                        {
-                            uint32_t alphaShift = 3 * (4 * (yy - 2) + xx);
-                            uint32_t threeAlphaBytes = alphaIndex << alphaShift;
-                            alphaBlock[5] |= (threeAlphaBytes & 0xff);
-                            alphaBlock[6] |= ((threeAlphaBytes >> 8) & 0xff);
-                            alphaBlock[7] |= ((threeAlphaBytes >> 16) & 0xff);
-                        }
-                    }
-                    
-                    uint32_t colorIndex = 0;
-                    uint32_t colorDistance = ColorDistanceARGBSquared(*pixel, color[0]);
-                    
-                    if ((encoding == kThreeColorEncoding) &&
-                        (pixelAlpha == 0))
-                    {
-                        colorIndex = 3;
-                    }
-                    else
-                    {
-                        int32_t i;
-                        int32_t colorMax = (encoding == kThreeColorEncoding) ? 3 : 4;
-                        for (i = 1; i < colorMax; i++)
-                        {
-                            uint32_t distance = ColorDistanceARGBSquared(*pixel, color[i]);
-                            if (distance < colorDistance)
-                            {
-                                colorIndex = i;
-                                colorDistance = distance;
-                            }
-                        }
+                        colorIndex = i;
+                        colorDistance = distance;
                     }
+                }
+            }
 
-                    if (yy < 2)
-                    {
-                        uint32_t colorShift = 2 * (4 * yy + xx);
-                        uint16_t colorWord = (uint16_t)(colorIndex << colorShift);
-                        colorBlock[2] |= colorWord;
-                    }
-                    else
-                    {
-                        uint32_t colorShift = 2 * (4 * (yy - 2) + xx);
-                        uint16_t colorWord = (uint16_t)(colorIndex << colorShift);
-                        colorBlock[3] |= colorWord;
-                    }
-                } // for yy
-            } // for xx
-            
-            if (alphaBlock)
+            if (yy < 2)
             {
-                alphaBlock[0] = alpha[0];
-                alphaBlock[1] = alpha[1];
+                uint32_t colorShift = 2 * (4 * yy + xx);
+                uint16_t colorWord = (uint16_t)(colorIndex << colorShift);
+                colorBlock[2] |= colorWord;
             }
-            
-            colorBlock[0] = shortColor[0];
-            colorBlock[1] = shortColor[1];
-        } // for y
-    } // for x
+            else
+            {
+                uint32_t colorShift = 2 * (4 * (yy - 2) + xx);
+                uint16_t colorWord = (uint16_t)(colorIndex << colorShift);
+                colorBlock[3] |= colorWord;
+            }
+        } // for yy
+    } // for xx
+    
+    if (alphaBlock)
+    {
+        alphaBlock[0] = alpha[0];
+        alphaBlock[1] = alpha[1];
+    }
+    
+    colorBlock[0] = shortColor[0];
+    colorBlock[1] = shortColor[1];
+}
+
+void hsDXTSoftwareCodec::find_endpoints_fpu(const hsRGBAColor32* pixels, uint32_t& first, uint32_t& second)
+{
+    int32_t maxDistance = 0;
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        for (uint32_t j = 0; j < 16; ++j)
+        {
+            int32_t distance = ColorDistanceARGBSquared(pixels[i], pixels[j]);
+            if (distance >= maxDistance)
+            {
+                maxDistance = distance;
+                first = i;
+                second = j;
+            }
+        }
+    }
 }
 
 uint16_t hsDXTSoftwareCodec::BlendColors16(uint16_t weight1, uint16_t color1, uint16_t weight2, uint16_t color2)
@@ -2274,6 +2344,13 @@ uint16_t hsDXTSoftwareCodec::Color32To16(hsRGBAColor32 color)
     return (r << 8) | (g << 3) | (b >> 3);
 }
 
+// CPU-optimized functions requiring dispatch
+hsCpuFunctionDispatcher<hsDXTSoftwareCodec::find_endpoints_ptr> hsDXTSoftwareCodec::find_endpoints {
+    &hsDXTSoftwareCodec::find_endpoints_fpu,
+    nullptr,                                    // SSE1
+    &hsDXTSoftwareCodec::find_endpoints_sse2
+};
+
 bool hsDXTSoftwareCodec::Register()
 {
     return hsCodecManager::Instance().Register(&(Instance()), plMipmap::kDirectXCompression, 100);
@@ -44,6 +44,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 #include "HeadSpin.h"
 #include "hsCodec.h"
+#include "hsCpuID.h"
 
 class plMipmap;
 typedef struct hsColor32 hsRGBAColor32;
@@ -66,6 +67,19 @@ public:
     // Colorize a compressed mipmap
     bool    ColorizeCompMipmap(plMipmap *bMap, const uint8_t *colorMask) override;
 
+    // CPU-optimized endpoint searches for the compressor, public so benchmarks can
+    // compare them directly. Given a 4x4 block in column-major order, finds the
+    // last pair of pixels (first, second) that are furthest apart in RGB.
+    typedef void(*find_endpoints_ptr)(const hsRGBAColor32* pixels, uint32_t& first, uint32_t& second);
+
+    static void find_endpoints_fpu(const hsRGBAColor32* pixels, uint32_t& first, uint32_t& second);
+    static void find_endpoints_sse2(const hsRGBAColor32* pixels, uint32_t& first, uint32_t& second);
+
+    // Decodes the current level of a DXT1 or DXT5 mipmap into a 32-bit ARGB
+    // mipmap on the calling thread only, so benchmarks can check the threaded
+    // decode against it.
+    void UncompressLevelSerial32(plMipmap* destBMap, plMipmap* srcBMap);
+
 private:
     enum {
         kFourColorEncoding,
@@ -73,10 +87,11 @@ private:
     };
 
     void    CompressMipmapLevel( plMipmap *uncompressed, plMipmap *compressed );
+    void    ICompressBlock( plMipmap *uncompressed, plMipmap *compressed, int32_t x, int32_t y, int32_t xMax );
 
     uint16_t BlendColors16(uint16_t weight1, uint16_t color1, uint16_t weight2, uint16_t color2);
     hsRGBAColor32 BlendColors32(uint32_t weight1, hsRGBAColor32 color1, uint32_t weight2, hsRGBAColor32 color2);
-    int32_t ColorDistanceARGBSquared(hsRGBAColor32 color1, hsRGBAColor32 color2);
+    static int32_t ColorDistanceARGBSquared(hsRGBAColor32 color1, hsRGBAColor32 color2);
     uint16_t Color32To16(hsRGBAColor32 color);
 
     // Calculates the DXT format based on a mipmap
@@ -98,6 +113,7 @@ private:
     void    IUncompressMipmapDXT5To16Weird( plMipmap *destBMap, plMipmap *srcBMap );
     // Decompresses a DXT5 compressed mipmap into a RGB8888 mipmap
     void    IUncompressMipmapDXT5To32( plMipmap *destBMap, plMipmap *srcBMap );
+    void    IUncompressRowsDXT5To32( plMipmap *destBMap, plMipmap *srcBMap, uint32_t rowBegin, uint32_t rowEnd );
 
     // Decompresses a DXT1 compressed mipmap into a RGB1555 mipmap
     void    IUncompressMipmapDXT1To16( plMipmap *destBMap, plMipmap *srcBMap );
@@ -105,6 +121,7 @@ private:
     void    IUncompressMipmapDXT1To16Weird( plMipmap *destBMap, plMipmap *srcBMap );
     // Decompresses a DXT1 compressed mipmap into a RGB8888 mipmap
     void    IUncompressMipmapDXT1To32( plMipmap *destBMap, plMipmap *srcBMap );
+    void    IUncompressRowsDXT1To32( plMipmap *destBMap, plMipmap *srcBMap, uint32_t rowBegin, uint32_t rowEnd );
 
     // Decompresses a DXT1 compressed mipmap into an intensity map
     void    IUncompressMipmapDXT1ToInten( plMipmap *destBMap, plMipmap *srcBMap );
@@ -149,6 +166,8 @@ private:
 
     static bool Register();
     static bool fRegistered;
+
+    static hsCpuFunctionDispatcher<find_endpoints_ptr> find_endpoints;
 };
 
 #endif // __HSDXTSOFTWARECODEC_H
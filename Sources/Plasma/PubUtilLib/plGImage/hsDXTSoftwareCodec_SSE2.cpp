@@ -0,0 +1,102 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include "hsDXTSoftwareCodec.h"
+
+#include "hsColorRGBA.h"
+#include "hsSIMD.h"
+
+#include <algorithm>
+
+void hsDXTSoftwareCodec::find_endpoints_sse2(const hsRGBAColor32* pixels, uint32_t& first, uint32_t& second)
+{
+#ifdef HAVE_SSE2
+    alignas(16) int16_t r[16], g[16], b[16];
+    for (uint32_t i = 0; i < 16; ++i) {
+        r[i] = pixels[i].r;
+        g[i] = pixels[i].g;
+        b[i] = pixels[i].b;
+    }
+
+    // Squared channel differences are at most 255^2, which still fits in an
+    // unsigned 16-bit lane; the sum of all three needs widening to 32 bits.
+    const __m128i zero = _mm_setzero_si128();
+    alignas(16) int32_t dists[256];
+    __m128i maxDist = zero;
+    for (uint32_t i = 0; i < 16; ++i) {
+        const __m128i ri = _mm_set1_epi16(r[i]);
+        const __m128i gi = _mm_set1_epi16(g[i]);
+        const __m128i bi = _mm_set1_epi16(b[i]);
+        for (uint32_t j = 0; j < 16; j += 8) {
+            __m128i dr = _mm_sub_epi16(_mm_load_si128((const __m128i*)&r[j]), ri);
+            __m128i dg = _mm_sub_epi16(_mm_load_si128((const __m128i*)&g[j]), gi);
+            __m128i db = _mm_sub_epi16(_mm_load_si128((const __m128i*)&b[j]), bi);
+            dr = _mm_mullo_epi16(dr, dr);
+            dg = _mm_mullo_epi16(dg, dg);
+            db = _mm_mullo_epi16(db, db);
+
+            __m128i lo = _mm_add_epi32(_mm_add_epi32(_mm_unpacklo_epi16(dr, zero), _mm_unpacklo_epi16(dg, zero)),
+                                       _mm_unpacklo_epi16(db, zero));
+            __m128i hi = _mm_add_epi32(_mm_add_epi32(_mm_unpackhi_epi16(dr, zero), _mm_unpackhi_epi16(dg, zero)),
+                                       _mm_unpackhi_epi16(db, zero));
+            _mm_store_si128((__m128i*)&dists[16 * i + j], lo);
+            _mm_store_si128((__m128i*)&dists[16 * i + j + 4], hi);
+
+            __m128i gt = _mm_cmpgt_epi32(lo, maxDist);
+            maxDist = _mm_or_si128(_mm_and_si128(gt, lo), _mm_andnot_si128(gt, maxDist));
+            gt = _mm_cmpgt_epi32(hi, maxDist);
+            maxDist = _mm_or_si128(_mm_and_si128(gt, hi), _mm_andnot_si128(gt, maxDist));
+        }
+    }
+
+    alignas(16) int32_t lanes[4];
+    _mm_store_si128((__m128i*)lanes, maxDist);
+    int32_t best = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+
+    // The scalar search keeps the last pair to reach the max, so do the same
+    uint32_t idx = 255;
+    while (dists[idx] != best)
+        --idx;
+    first = idx >> 4;
+    second = idx & 15;
+#endif // HAVE_SSE2
+}
@@ -70,6 +70,17 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "plMipmap.h"
 #include "hsResMgr.h"
 
+// Measuring is cheap enough that we don't need an LRU, just start over when full
+static constexpr size_t kMaxCachedExtents = 256;
+
+// Text shadow blur, indexed [y][x] around the pixel being shadowed
+static const uint32_t kShadowKernel[5][5] = {
+    {1,  2,  2,  2, 1},
+    {1, 13, 13, 13, 1},
+    {1, 10, 10, 10, 1},
+    {1,  7,  7,  7, 1},
+    {1,  1,  1,  1, 1}
+};
 
 //// plCharacter Stuff ////////////////////////////////////////////////////////
 
@@ -140,6 +151,14 @@ void    plFont::IClear( bool onConstruct )
     fRenderInfo.fVolatileStringPtr = nullptr;
     fRenderInfo.fFirstLineIndent = 0;
     fRenderInfo.fLineSpacing = 0;
+
+    IClearCaches();
+}
+
+void    plFont::IClearCaches()
+{
+    fExtentsCache.clear();
+    fShadowMasks.clear();
 }
 
 void    plFont::Read( hsStream *s, hsResMgr *mgr )
@@ -200,6 +219,9 @@ void    plFont::ICalcFontAscent()
         if( fMaxCharHeight < fCharacters[ i ].fHeight )
             fMaxCharHeight = fCharacters[ i ].fHeight;
     }
+
+    // Our characters just changed, so anything we cached about them is stale
+    IClearCaches();
 }
 
 //// IIsWordBreaker //////////////////////////////////////////////////////////
@@ -368,6 +390,11 @@ void    plFont::IRenderString( plMipmap *mip, uint16_t x, uint16_t y, const wcha
         return;
     }
 
+    if( fRenderInfo.fRenderFunc == &plFont::IRenderChar8To32Alpha ||
+        fRenderInfo.fRenderFunc == &plFont::IRenderChar8To32FullAlpha ||
+        fRenderInfo.fRenderFunc == &plFont::IRenderChar8To32AlphaPremultiplied )
+        IBuildPixelLUT();
+
     // Init our other render values
     if( !justCalc )
     {
@@ -925,9 +952,8 @@ void    plFont::IRenderChar8To32( const plFont::plCharacter &c )
 void    plFont::IRenderChar8To32FullAlpha( const plFont::plCharacter &c )
 {
     uint8_t   *src = fBMapData + c.fBitmapOff;
-    uint32_t  *destPtr, *destBasePtr = (uint32_t *)(fRenderInfo.fDestPtr - c.fBaseline * int32_t(fRenderInfo.fDestStride));
-    int16_t   x, y, thisHeight, xstart, thisWidth;
-    uint32_t  destColorOnly;
+    uint32_t  *destBasePtr = (uint32_t *)(fRenderInfo.fDestPtr - c.fBaseline * int32_t(fRenderInfo.fDestStride));
+    int16_t   y, thisHeight, xstart, thisWidth;
 
 
     // Unfortunately for some fonts, their right kern value actually is
@@ -945,8 +971,6 @@ void    plFont::IRenderChar8To32FullAlpha( const plFont::plCharacter &c )
     if( xstart < 0 )
         xstart = 0;
 
-    destColorOnly = fRenderInfo.fColor & 0x00ffffff;
-
     y = fRenderInfo.fClipRect.fY - fRenderInfo.fY + (int16_t)c.fBaseline;
     if( y < 0 )
         y = 0;
@@ -962,12 +986,7 @@ void    plFont::IRenderChar8To32FullAlpha( const plFont::plCharacter &c )
 
     for( ; y < thisHeight; y++ )
     {
-        destPtr = destBasePtr;
-        for( x = xstart; x < thisWidth; x++ )
-        {
-            if( src[ x ] != 0 )
-                destPtr[ x ] = ( src[ x ] << 24 ) | destColorOnly;
-        }
+        IBlitRowLUT( destBasePtr, src, xstart, thisWidth );
         destBasePtr = (uint32_t *)( (uint8_t *)destBasePtr + fRenderInfo.fDestStride );
         src += fWidth;
     }
@@ -975,10 +994,9 @@ void    plFont::IRenderChar8To32FullAlpha( const plFont::plCharacter &c )
 
 void    plFont::IRenderChar8To32Alpha( const plFont::plCharacter &c )
 {
-    uint8_t   val, *src = fBMapData + c.fBitmapOff;
-    uint32_t  *destPtr, *destBasePtr = (uint32_t *)(fRenderInfo.fDestPtr - c.fBaseline * int32_t(fRenderInfo.fDestStride));
-    int16_t   x, y, thisHeight, xstart, thisWidth;
-    uint32_t  destColorOnly, alphaMult, fullAlpha;
+    uint8_t   *src = fBMapData + c.fBitmapOff;
+    uint32_t  *destBasePtr = (uint32_t *)(fRenderInfo.fDestPtr - c.fBaseline * int32_t(fRenderInfo.fDestStride));
+    int16_t   y, thisHeight, xstart, thisWidth;
 
 
     // Unfortunately for some fonts, their right kern value actually is
@@ -996,12 +1014,6 @@ void    plFont::IRenderChar8To32Alpha( const plFont::plCharacter &c )
     if( xstart < 0 )
         xstart = 0;
 
-    destColorOnly = fRenderInfo.fColor & 0x00ffffff;
-    // alphaMult should come out to be a value to satisfy (fontAlpha * alphaMult >> 8) as the right alpha,
-    // but then we want it so (fontAlpha * alphaMult) will be in the upper 8 bits
-    fullAlpha = fRenderInfo.fColor & 0xff000000;
-    alphaMult = fullAlpha / 255;
-
     y = fRenderInfo.fClipRect.fY - fRenderInfo.fY + (int16_t)c.fBaseline;
     if( y < 0 )
         y = 0;
@@ -1017,17 +1029,7 @@ void    plFont::IRenderChar8To32Alpha( const plFont::plCharacter &c )
 
     for( ; y < thisHeight; y++ )
     {
-        destPtr = destBasePtr;
-        for( x = xstart; x < thisWidth; x++ )
-        {
-            val = src[ x ];
-            if( val == 0xff )
-                destPtr[ x ] = fullAlpha | destColorOnly;
-            else if( val != 0 )
-            {
-                destPtr[ x ] = ( ( alphaMult * val ) & 0xff000000 ) | destColorOnly;
-            }
-        }
+        IBlitRowLUT( destBasePtr, src, xstart, thisWidth );
         destBasePtr = (uint32_t *)( (uint8_t *)destBasePtr + fRenderInfo.fDestStride );
         src += fWidth;
     }
@@ -1036,9 +1038,8 @@ void    plFont::IRenderChar8To32Alpha( const plFont::plCharacter &c )
 void    plFont::IRenderChar8To32AlphaPremultiplied( const plFont::plCharacter &c )
 {
     uint8_t   *src = fBMapData + c.fBitmapOff;
-    uint32_t  *destPtr, *destBasePtr = (uint32_t *)(fRenderInfo.fDestPtr - c.fBaseline * int32_t(fRenderInfo.fDestStride));
-    int16_t   x, y, thisHeight, xstart, thisWidth;
-    uint8_t   srcA, srcR, srcG, srcB;
+    uint32_t  *destBasePtr = (uint32_t *)(fRenderInfo.fDestPtr - c.fBaseline * int32_t(fRenderInfo.fDestStride));
+    int16_t   y, thisHeight, xstart, thisWidth;
 
 
     // Unfortunately for some fonts, their right kern value actually is
@@ -1056,11 +1057,6 @@ void    plFont::IRenderChar8To32AlphaPremultiplied( const plFont::plCharacter &c
     if( xstart < 0 )
         xstart = 0;
 
-    srcA = (uint8_t)(( fRenderInfo.fColor >> 24 ) & 0x000000ff);
-    srcR = (uint8_t)(( fRenderInfo.fColor >> 16 ) & 0x000000ff);
-    srcG = (uint8_t)(( fRenderInfo.fColor >> 8  ) & 0x000000ff);
-    srcB = (uint8_t)(( fRenderInfo.fColor       ) & 0x000000ff);
-
     y = fRenderInfo.fClipRect.fY - fRenderInfo.fY + (int16_t)c.fBaseline;
     if( y < 0 )
         y = 0;
@@ -1076,17 +1072,7 @@ void    plFont::IRenderChar8To32AlphaPremultiplied( const plFont::plCharacter &c
 
     for( ; y < thisHeight; y++ )
     {
-        destPtr = destBasePtr;
-        for( x = xstart; x < thisWidth; x++ )
-        {
-            uint32_t a = src[ x ];
-            if (a != 0)
-            {
-                if (srcA != 0xff)
-                    a = (srcA*a + 127)/255;
-                destPtr[ x ] = ( a << 24 ) | (((srcR*a + 127)/255) << 16) | (((srcG*a + 127)/255) << 8) | ((srcB*a + 127)/255);
-            }
-        }
+        IBlitRowLUT( destBasePtr, src, xstart, thisWidth );
         destBasePtr = (uint32_t *)( (uint8_t *)destBasePtr + fRenderInfo.fDestStride );
         src += fWidth;
     }
@@ -1121,13 +1107,8 @@ void    plFont::IRenderChar8To32AlphaPremShadow( const plFont::plCharacter &c )
     srcG = (uint8_t)(( fRenderInfo.fColor >> 8  ) & 0x000000ff);
     srcB = (uint8_t)(( fRenderInfo.fColor       ) & 0x000000ff);
 
-    static const uint32_t kernel[5][5] = {
-        {1,  2,  2,  2, 1},
-        {1, 13, 13, 13, 1},
-        {1, 10, 10, 10, 1},
-        {1,  7,  7,  7, 1},
-        {1,  1,  1,  1, 1}
-    };
+    const uint16_t *mask = IGetShadowMask( c );
+    const uint32_t maskStride = fWidth + 4;
 
     uint32_t clamp = 220 - ((2 * srcR + 4 * srcG + srcB) >> 4);
 
@@ -1143,17 +1124,10 @@ void    plFont::IRenderChar8To32AlphaPremShadow( const plFont::plCharacter &c )
     for( ; y < thisHeight; y++ )
     {
         destPtr = destBasePtr;
+        const uint16_t *maskRow = mask + ( y + 2 ) * maskStride + 2;
         for( x = xstart; x < thisWidth; x++ )
         {
-            uint32_t sa = 0;
-            for (int32_t i = -2; i <= 2; i++) {
-                for (int32_t j = -2; j <= 2; j++) {
-                    uint32_t m = kernel[j+2][i+2];
-                    if (m != 0)
-                        sa += m * IGetCharPixel(c, x+i, y+j);
-                }
-            }
-            sa = (sa * clamp) >> 13;
+            uint32_t sa = ( maskRow[ x ] * clamp ) >> 13;
             if (sa > clamp)
                 sa = clamp;
             uint32_t a = IGetCharPixel(c, x, y);
@@ -1177,6 +1151,105 @@ void    plFont::IRenderCharNull( const plCharacter &c )
 {
 }
 
+//// IBuildPixelLUT ///////////////////////////////////////////////////////////
+//  Precalcs the dest pixel for every font pixel value for the render funcs
+//  that don't care what's already in the dest. Must match what the per-pixel
+//  math in those functions used to be exactly.
+
+void    plFont::IBuildPixelLUT()
+{
+    uint32_t *lut = fRenderInfo.fPixelLUT;
+    uint32_t destColorOnly = fRenderInfo.fColor & 0x00ffffff;
+
+    lut[ 0 ] = 0;   // Never written
+    if( fRenderInfo.fRenderFunc == &plFont::IRenderChar8To32FullAlpha )
+    {
+        for( uint32_t val = 1; val < 256; val++ )
+            lut[ val ] = ( val << 24 ) | destColorOnly;
+    }
+    else if( fRenderInfo.fRenderFunc == &plFont::IRenderChar8To32Alpha )
+    {
+        // alphaMult should come out to be a value to satisfy (fontAlpha * alphaMult >> 8) as the right alpha,
+        // but then we want it so (fontAlpha * alphaMult) will be in the upper 8 bits
+        uint32_t fullAlpha = fRenderInfo.fColor & 0xff000000;
+        uint32_t alphaMult = fullAlpha / 255;
+
+        for( uint32_t val = 1; val < 255; val++ )
+            lut[ val ] = ( ( alphaMult * val ) & 0xff000000 ) | destColorOnly;
+        lut[ 255 ] = fullAlpha | destColorOnly;
+    }
+    else if( fRenderInfo.fRenderFunc == &plFont::IRenderChar8To32AlphaPremultiplied )
+    {
+        uint32_t srcA = ( fRenderInfo.fColor >> 24 ) & 0x000000ff;
+        uint32_t srcR = ( fRenderInfo.fColor >> 16 ) & 0x000000ff;
+        uint32_t srcG = ( fRenderInfo.fColor >> 8  ) & 0x000000ff;
+        uint32_t srcB = ( fRenderInfo.fColor       ) & 0x000000ff;
+
+        for( uint32_t val = 1; val < 256; val++ )
+        {
+            uint32_t a = val;
+            if( srcA != 0xff )
+                a = ( srcA * a + 127 ) / 255;
+            lut[ val ] = ( a << 24 ) | ( ( ( srcR * a + 127 ) / 255 ) << 16 ) | ( ( ( srcG * a + 127 ) / 255 ) << 8 ) | ( ( srcB * a + 127 ) / 255 );
+        }
+    }
+}
+
+//// IGetShadowMask ///////////////////////////////////////////////////////////
+//  The shadow blur only depends on the character bitmap, so rather than run
+//  the 5x5 kernel for every pixel of every char we draw, run it once per char
+//  and keep the sums around.
+
+const uint16_t *plFont::IGetShadowMask( const plCharacter &c )
+{
+    if( fShadowMasks.size() != fCharacters.size() )
+        fShadowMasks.resize( fCharacters.size() );
+
+    std::vector<uint16_t> &mask = fShadowMasks[ &c - fCharacters.data() ];
+    if( mask.empty() )
+    {
+        // Largest sum is 79 * 255, so this fits in 16 bits
+        int32_t maskStride = fWidth + 4;
+        mask.resize( maskStride * ( c.fHeight + 4 ) );
+        for( int32_t y = -2; y < (int32_t)c.fHeight + 2; y++ )
+        {
+            for( int32_t x = -2; x < (int32_t)fWidth + 2; x++ )
+            {
+                uint32_t sum = 0;
+                for( int32_t j = -2; j <= 2; j++ )
+                {
+                    for( int32_t i = -2; i <= 2; i++ )
+                        sum += kShadowKernel[ j + 2 ][ i + 2 ] * IGetCharPixel( c, x + i, y + j );
+                }
+                mask[ ( y + 2 ) * maskStride + x + 2 ] = (uint16_t)sum;
+            }
+        }
+    }
+    return mask.data();
+}
+
+void    plFont::IBlitRowLUT( uint32_t *destPtr, const uint8_t *src, int16_t xstart, int16_t xend ) const
+{
+    if( xstart < xend )
+        blit_row_lut.call( destPtr + xstart, src + xstart, xend - xstart, fRenderInfo.fPixelLUT );
+}
+
+void    plFont::blit_row_lut_fpu( uint32_t *dest, const uint8_t *src, size_t count, const uint32_t *lut )
+{
+    for( size_t x = 0; x < count; x++ )
+    {
+        if( src[ x ] != 0 )
+            dest[ x ] = lut[ src[ x ] ];
+    }
+}
+
+// CPU-optimized functions requiring dispatch
+hsCpuFunctionDispatcher<plFont::blit_row_lut_ptr> plFont::blit_row_lut {
+    &plFont::blit_row_lut_fpu,
+    nullptr,                        // SSE1
+    &plFont::blit_row_lut_sse2
+};
+
 //// CalcString Variations ////////////////////////////////////////////////////
 
 uint16_t  plFont::CalcStringWidth( const ST::string &string )
@@ -1206,16 +1279,64 @@ void    plFont::CalcStringExtents( const ST::string &string, uint16_t &width, ui
 
 void    plFont::CalcStringExtents( const wchar_t *string, uint16_t &width, uint16_t &height, uint16_t &ascent, uint32_t &firstClippedChar, uint16_t &lastX, uint16_t &lastY )
 {
-    IRenderString(nullptr, 0, 0, string, true);
-    width = fRenderInfo.fFarthestX;
-    height = (uint16_t)(fRenderInfo.fY + fFontDescent);//fRenderInfo.fMaxDescent;
-    ascent = fRenderInfo.fMaxAscent;
-    lastX = fRenderInfo.fLastX;
-    lastY = fRenderInfo.fLastY;
-
-    // firstClippedChar is an index into the given string that points to the start of the part of the string
-    // that got clipped (i.e. not rendered).
-    firstClippedChar = fRenderInfo.fVolatileStringPtr - string;
+    plExtentsKey key;
+    key.fString = string;
+    key.fFlags = fRenderInfo.fFlags;
+    key.fClipX = fRenderInfo.fClipRect.fX;
+    key.fClipY = fRenderInfo.fClipRect.fY;
+    key.fClipWidth = fRenderInfo.fClipRect.fWidth;
+    key.fClipHeight = fRenderInfo.fClipRect.fHeight;
+    key.fFirstLineIndent = fRenderInfo.fFirstLineIndent;
+    key.fLineSpacing = fRenderInfo.fLineSpacing;
+
+    auto iter = fExtentsCache.find(key);
+    if (iter == fExtentsCache.end())
+    {
+        IRenderString(nullptr, 0, 0, string, true);
+
+        plExtents extents;
+        extents.fWidth = fRenderInfo.fFarthestX;
+        extents.fHeight = (uint16_t)(fRenderInfo.fY + fFontDescent);//fRenderInfo.fMaxDescent;
+        extents.fAscent = fRenderInfo.fMaxAscent;
+        extents.fLastX = fRenderInfo.fLastX;
+        extents.fLastY = fRenderInfo.fLastY;
+
+        // firstClippedChar is an index into the given string that points to the start of the part of the string
+        // that got clipped (i.e. not rendered).
+        extents.fFirstClippedChar = fRenderInfo.fVolatileStringPtr - string;
+
+        if (fExtentsCache.size() >= kMaxCachedExtents)
+            fExtentsCache.clear();
+        iter = fExtentsCache.emplace(std::move(key), extents).first;
+    }
+
+    width = iter->second.fWidth;
+    height = iter->second.fHeight;
+    ascent = iter->second.fAscent;
+    lastX = iter->second.fLastX;
+    lastY = iter->second.fLastY;
+    firstClippedChar = iter->second.fFirstClippedChar;
+}
+
+bool plFont::plExtentsKey::operator==(const plExtentsKey& other) const
+{
+    return fFlags == other.fFlags && fClipX == other.fClipX && fClipY == other.fClipY &&
+           fClipWidth == other.fClipWidth && fClipHeight == other.fClipHeight &&
+           fFirstLineIndent == other.fFirstLineIndent && fLineSpacing == other.fLineSpacing &&
+           fString == other.fString;
+}
+
+size_t plFont::plExtentsKeyHash::operator()(const plExtentsKey& key) const
+{
+    size_t hash = std::hash<std::wstring>()(key.fString);
+    auto combine = [&hash](size_t value) {
+        hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    };
+    combine(key.fFlags);
+    combine(uint16_t(key.fClipX) | (uint32_t(uint16_t(key.fClipY)) << 16));
+    combine(uint16_t(key.fClipWidth) | (uint32_t(uint16_t(key.fClipHeight)) << 16));
+    combine(uint16_t(key.fFirstLineIndent) | (uint32_t(uint16_t(key.fLineSpacing)) << 16));
+    return hash;
 }
 
 //// IGetFreeCharData /////////////////////////////////////////////////////////
@@ -64,8 +64,11 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 #include "HeadSpin.h"
 #include "hsColorRGBA.h"
+#include "hsCpuID.h"
 #include "pcSmallRect.h"
 
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "pnKeyedObject/hsKeyedObject.h"
@@ -203,12 +206,49 @@ class plFont : public hsKeyedObject
                 const wchar_t   *fVolatileStringPtr;    // Just so we know where we clipped
 
                 CharRenderFunc  fRenderFunc;
+
+                // For the 8-bit alpha render funcs, the dest pixel only depends
+                // on the font pixel, so we look it up instead of blending
+                uint32_t        fPixelLUT[ 256 ];
         };
 
         plRenderInfo    fRenderInfo;
 
+        // Cached results of CalcStringExtents(). GUI controls and text maps
+        // measure the same strings every time they redraw, so keep the last
+        // few around. Keyed on everything that affects the layout.
+        struct plExtentsKey
+        {
+            std::wstring    fString;
+            uint32_t        fFlags;
+            int16_t         fClipX, fClipY, fClipWidth, fClipHeight;
+            int16_t         fFirstLineIndent, fLineSpacing;
+
+            bool operator==(const plExtentsKey& other) const;
+        };
+        struct plExtentsKeyHash
+        {
+            size_t operator()(const plExtentsKey& key) const;
+        };
+        struct plExtents
+        {
+            uint16_t    fWidth, fHeight, fAscent, fLastX, fLastY;
+            uint32_t    fFirstClippedChar;
+        };
+        std::unordered_map<plExtentsKey, plExtents, plExtentsKeyHash> fExtentsCache;
+
+        // Per-character sums of the text shadow kernel, built on first use.
+        // Each is (fWidth + 4) x (fHeight + 4), starting 2 pixels up and left
+        // of the character bitmap.
+        std::vector<std::vector<uint16_t>> fShadowMasks;
+
         void    IClear( bool onConstruct = false );
         void    ICalcFontAscent();
+        void    IClearCaches();
+
+        void    IBuildPixelLUT();
+        const uint16_t *IGetShadowMask( const plCharacter &c );
+        void    IBlitRowLUT( uint32_t *destPtr, const uint8_t *src, int16_t xstart, int16_t xend ) const;
 
         uint8_t   *IGetFreeCharData( uint32_t &newOffset );
 
@@ -232,6 +272,20 @@ class plFont : public hsKeyedObject
             return (x < 0 || y < 0 || (uint32_t)x >= fWidth || (uint32_t)y >= c.fHeight) ? 0 : *(fBMapData + c.fBitmapOff + y*fWidth + x);
         }
 
+    public:
+
+        // CPU-optimized row blitters for the lookup table render funcs, public
+        // so benchmarks can compare them directly. Writes lut[src[x]] into
+        // dest[x] for every nonzero src[x] in [0, count).
+        typedef void(*blit_row_lut_ptr)(uint32_t* dest, const uint8_t* src, size_t count, const uint32_t* lut);
+
+        static void blit_row_lut_fpu(uint32_t* dest, const uint8_t* src, size_t count, const uint32_t* lut);
+        static void blit_row_lut_sse2(uint32_t* dest, const uint8_t* src, size_t count, const uint32_t* lut);
+
+    protected:
+
+        static hsCpuFunctionDispatcher<blit_row_lut_ptr> blit_row_lut;
+
     public:
 
         plFont();
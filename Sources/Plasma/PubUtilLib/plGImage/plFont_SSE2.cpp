@@ -0,0 +1,83 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include "plFont.h"
+
+#include "hsSIMD.h"
+
+void plFont::blit_row_lut_sse2(uint32_t* dest, const uint8_t* src, size_t count, const uint32_t* lut)
+{
+#ifdef HAVE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i full = _mm_set1_epi8(-1);
+    const __m128i solid = _mm_set1_epi32(int32_t(lut[255]));
+
+    size_t x = 0;
+    for (; x + 16 <= count; x += 16) {
+        __m128i vals = _mm_loadu_si128((const __m128i*)(src + x));
+
+        // Most of a character cell is empty, and the inside of the strokes is
+        // usually solid, so handle those 16 pixels at a time
+        int empty = _mm_movemask_epi8(_mm_cmpeq_epi8(vals, zero));
+        if (empty == 0xFFFF)
+            continue;
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(vals, full)) == 0xFFFF) {
+            _mm_storeu_si128((__m128i*)(dest + x), solid);
+            _mm_storeu_si128((__m128i*)(dest + x + 4), solid);
+            _mm_storeu_si128((__m128i*)(dest + x + 8), solid);
+            _mm_storeu_si128((__m128i*)(dest + x + 12), solid);
+            continue;
+        }
+
+        for (size_t i = 0; i < 16; ++i) {
+            if (!(empty & (1 << i)))
+                dest[x + i] = lut[src[x + i]];
+        }
+    }
+
+    for (; x < count; ++x) {
+        if (src[x] != 0)
+            dest[x] = lut[src[x]];
+    }
+#endif // HAVE_SSE2
+}
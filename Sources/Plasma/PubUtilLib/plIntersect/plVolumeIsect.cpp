@@ -50,6 +50,14 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 static const float kDefLength = 5.f;
 
+plVolumeCullResult plVolumeIsect::TestBox(const hsPoint3& mins, const hsPoint3& maxs) const
+{
+    hsBounds3Ext bnd;
+    bnd.Reset(&mins);
+    bnd.Union(&maxs);
+    return Test(bnd);
+}
+
 plSphereIsect::plSphereIsect()
     : fRadius(1.f)
 {
@@ -101,9 +109,11 @@ void plSphereIsect::SetTransform(const hsMatrix44& l2w, const hsMatrix44& w2l)
 // accurate than this box test approx, but whatever.
 plVolumeCullResult plSphereIsect::Test(const hsBounds3Ext& bnd) const
 {
-    const hsPoint3& maxs = bnd.GetMaxs();
-    const hsPoint3& mins = bnd.GetMins();
+    return TestBox(bnd.GetMins(), bnd.GetMaxs());
+}
 
+plVolumeCullResult plSphereIsect::TestBox(const hsPoint3& mins, const hsPoint3& maxs) const
+{
     if( (maxs.fX < fMins.fX)
         ||
         (maxs.fY < fMins.fY)
@@ -578,6 +588,25 @@ plVolumeCullResult plParallelIsect::Test(const hsBounds3Ext& bnd) const
     return retVal;
 }
 
+plVolumeCullResult plParallelIsect::TestBox(const hsPoint3& mins, const hsPoint3& maxs) const
+{
+    plVolumeCullResult retVal = kVolumeClear;
+    for (const ParPlane& plane : fPlanes)
+    {
+        hsPoint2 depth;
+        hsBounds3::TestBoxPlane(mins, maxs, plane.fNorm, depth);
+        if (depth.fY < plane.fMin)
+            return kVolumeCulled;
+        if (depth.fX > plane.fMax)
+            return kVolumeCulled;
+        if (depth.fX < plane.fMin)
+            retVal = kVolumeSplit;
+        if (depth.fY > plane.fMax)
+            retVal = kVolumeSplit;
+    }
+    return retVal;
+}
+
 float plParallelIsect::Test(const hsPoint3& pos) const
 {
     float maxDist = 0;
@@ -721,6 +750,23 @@ plVolumeCullResult plConvexIsect::Test(const hsBounds3Ext& bnd) const
     return retVal;
 }
 
+plVolumeCullResult plConvexIsect::TestBox(const hsPoint3& mins, const hsPoint3& maxs) const
+{
+    plVolumeCullResult retVal = kVolumeClear;
+    for (const SinglePlane& plane : fPlanes)
+    {
+        hsPoint2 depth;
+        hsBounds3::TestBoxPlane(mins, maxs, plane.fWorldNorm, depth);
+
+        if (depth.fX > plane.fWorldDist)
+            return kVolumeCulled;
+
+        if (depth.fY > plane.fWorldDist)
+            retVal = kVolumeSplit;
+    }
+    return retVal;
+}
+
 float plConvexIsect::Test(const hsPoint3& pos) const
 {
     float maxDist = 0;
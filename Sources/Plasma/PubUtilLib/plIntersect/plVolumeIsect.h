@@ -70,6 +70,10 @@ public:
     virtual plVolumeCullResult  Test(const hsBounds3Ext& bnd) const = 0;    
     virtual float            Test(const hsPoint3& pos) const = 0;
 
+    // Test against an axis aligned box. Volumes that can test the box directly
+    // override this, the rest get it wrapped up in an hsBounds3Ext.
+    virtual plVolumeCullResult  TestBox(const hsPoint3& mins, const hsPoint3& maxs) const;
+
     void Read(hsStream* s, hsResMgr* mgr) override = 0;
     void Write(hsStream* s, hsResMgr* mgr) override = 0;
 };
@@ -96,6 +100,7 @@ public:
     void SetTransform(const hsMatrix44& l2w, const hsMatrix44& w2l) override;
 
     plVolumeCullResult  Test(const hsBounds3Ext& bnd) const override;
+    plVolumeCullResult  TestBox(const hsPoint3& mins, const hsPoint3& maxs) const override;
     float            Test(const hsPoint3& pos) const override; // return 0 if point inside, else "distance" from pos to volume
 
     void Read(hsStream* s, hsResMgr* mgr) override;
@@ -203,6 +208,7 @@ public:
     void SetTransform(const hsMatrix44& l2w, const hsMatrix44& w2l) override;
 
     plVolumeCullResult  Test(const hsBounds3Ext& bnd) const override;
+    plVolumeCullResult  TestBox(const hsPoint3& mins, const hsPoint3& maxs) const override;
     float            Test(const hsPoint3& pos) const override;
 
     void Read(hsStream* s, hsResMgr* mgr) override;
@@ -237,6 +243,7 @@ public:
     void SetTransform(const hsMatrix44& l2w, const hsMatrix44& w2l) override;
 
     plVolumeCullResult  Test(const hsBounds3Ext& bnd) const override;
+    plVolumeCullResult  TestBox(const hsPoint3& mins, const hsPoint3& maxs) const override;
     float            Test(const hsPoint3& pos) const override;
 
     void Read(hsStream* s, hsResMgr* mgr) override;
@@ -60,6 +60,31 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 #include <algorithm>
 
+// Runs T's ApplyEffect over a range without going through the vtable for
+// every particle.
+template <class T>
+static inline void IApplyEffectRange(T* effect, const plEffectTargetInfo& target, uint32_t begin, uint32_t end, uint8_t* kill)
+{
+    for (uint32_t i = begin; i < end; i++)
+    {
+        if (kill && kill[i])
+            continue;
+        if (effect->T::ApplyEffect(target, i) && kill)
+            kill[i] = 1;
+    }
+}
+
+void plParticleEffect::ApplyEffectRange(const plEffectTargetInfo& target, uint32_t begin, uint32_t end, uint8_t* kill)
+{
+    for (uint32_t i = begin; i < end; i++)
+    {
+        if (kill && kill[i])
+            continue;
+        if (ApplyEffect(target, i) && kill)
+            kill[i] = 1;
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 plParticleCollisionEffect::plParticleCollisionEffect()
 {
@@ -138,6 +163,14 @@ bool plParticleCollisionEffectBeat::ApplyEffect(const plEffectTargetInfo &target
     return false;
 }
 
+void plParticleCollisionEffectBeat::ApplyEffectRange(const plEffectTargetInfo& target, uint32_t begin, uint32_t end, uint8_t* kill)
+{
+    if( !fBounds )
+        return;
+
+    IApplyEffectRange(this, target, begin, end, kill);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 
 plParticleCollisionEffectDie::plParticleCollisionEffectDie()
@@ -155,6 +188,14 @@ bool plParticleCollisionEffectDie::ApplyEffect(const plEffectTargetInfo &target,
     return fBounds->IsInside(*currPos); 
 }
 
+void plParticleCollisionEffectDie::ApplyEffectRange(const plEffectTargetInfo& target, uint32_t begin, uint32_t end, uint8_t* kill)
+{
+    if( !fBounds )
+        return;
+
+    IApplyEffectRange(this, target, begin, end, kill);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 
 plParticleCollisionEffectBounce::plParticleCollisionEffectBounce()
@@ -177,6 +218,14 @@ bool plParticleCollisionEffectBounce::ApplyEffect(const plEffectTargetInfo &targ
     return false;
 }
 
+void plParticleCollisionEffectBounce::ApplyEffectRange(const plEffectTargetInfo& target, uint32_t begin, uint32_t end, uint8_t* kill)
+{
+    if( !fBounds )
+        return;
+
+    IApplyEffectRange(this, target, begin, end, kill);
+}
+
 void plParticleCollisionEffectBounce::Read(hsStream *s, hsResMgr *mgr)
 {
     plParticleCollisionEffect::Read(s, mgr);
@@ -353,6 +402,11 @@ bool plParticleFadeVolumeEffect::ApplyEffect(const plEffectTargetInfo& target, i
     return false;
 }
 
+void plParticleFadeVolumeEffect::ApplyEffectRange(const plEffectTargetInfo& target, uint32_t begin, uint32_t end, uint8_t* kill)
+{
+    IApplyEffectRange(this, target, begin, end, kill);
+}
+
 void plParticleFadeVolumeEffect::Read(hsStream *s, hsResMgr *mgr)
 {
     hsKeyedObject::Read(s, mgr);
@@ -503,6 +557,11 @@ bool plParticleLocalWind::ApplyEffect(const plEffectTargetInfo& target, int32_t
     return false;
 }
 
+void plParticleLocalWind::ApplyEffectRange(const plEffectTargetInfo& target, uint32_t begin, uint32_t end, uint8_t* kill)
+{
+    IApplyEffectRange(this, target, begin, end, kill);
+}
+
 ////////////////////////////////////////////////////////////////////////
 // Uniform wind - wind changes over time, but not space
 plParticleUniformWind::plParticleUniformWind()
@@ -630,6 +689,21 @@ bool plParticleUniformWind::ApplyEffect(const plEffectTargetInfo& target, int32_
     return false;
 }
 
+void plParticleUniformWind::ApplyEffectRange(const plEffectTargetInfo& target, uint32_t begin, uint32_t end, uint8_t* kill)
+{
+    // Same push for everybody, scaled by mass
+    const hsVector3 windVec = fWindVec * fCurrentStrength;
+    if( windVec.IsEmpty() )
+        return;
+
+    for (uint32_t i = begin; i < end; i++)
+    {
+        hsVector3& vel = *(hsVector3*)(target.fVelocity + i * target.fVelocityStride);
+        const float invMass = *(float*)(target.fInvMass + i * target.fInvMassStride);
+        vel += windVec * invMass;
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////
 // Simplified flocking.
 
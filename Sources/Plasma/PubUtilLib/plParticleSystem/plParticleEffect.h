@@ -69,6 +69,14 @@ public:
     virtual void PrepareEffect(const plEffectTargetInfo& target) {}
     virtual bool ApplyEffect(const plEffectTargetInfo& target, int32_t i) = 0;
     virtual void EndEffect(const plEffectTargetInfo& target) {}
+
+    // ApplyEffect for particles [begin, end). Particles already flagged in
+    //      kill (if there is one) are skipped, and a particle is flagged
+    //      when ApplyEffect returns true for it.
+    //      The emitter calls this on disjoint ranges from several threads
+    //      at once, so between Prepare and End an effect may only write
+    //      to the particles it's handed.
+    virtual void ApplyEffectRange(const plEffectTargetInfo& target, uint32_t begin, uint32_t end, uint8_t* kill);
 };
 
 class plParticleCollisionEffect : public plParticleEffect
@@ -103,6 +111,7 @@ public:
     GETINTERFACE_ANY( plParticleCollisionEffectBeat, plParticleCollisionEffect );
 
     bool ApplyEffect(const plEffectTargetInfo& target, int32_t i) override;
+    void ApplyEffectRange(const plEffectTargetInfo& target, uint32_t begin, uint32_t end, uint8_t* kill) override;
 };
 
 // This particle blocker just kills any particles that hit it.
@@ -115,6 +124,7 @@ public:
     GETINTERFACE_ANY( plParticleCollisionEffectDie, plParticleCollisionEffect );
 
     bool ApplyEffect(const plEffectTargetInfo& target, int32_t i) override;
+    void ApplyEffectRange(const plEffectTargetInfo& target, uint32_t begin, uint32_t end, uint8_t* kill) override;
 };
 
 class plParticleCollisionEffectBounce : public plParticleCollisionEffect
@@ -129,6 +139,7 @@ public:
     GETINTERFACE_ANY( plParticleCollisionEffectBounce, plParticleCollisionEffect );
 
     bool ApplyEffect(const plEffectTargetInfo& target, int32_t i) override;
+    void ApplyEffectRange(const plEffectTargetInfo& target, uint32_t begin, uint32_t end, uint8_t* kill) override;
 
     void Read(hsStream *s, hsResMgr *mgr) override;
     void Write(hsStream *s, hsResMgr *mgr) override;
@@ -158,6 +169,7 @@ public:
 
     void PrepareEffect(const plEffectTargetInfo& target) override;
     bool ApplyEffect(const plEffectTargetInfo& target, int32_t i) override;
+    void ApplyEffectRange(const plEffectTargetInfo& target, uint32_t begin, uint32_t end, uint8_t* kill) override;
 
     void Read(hsStream *s, hsResMgr *mgr) override;
     void Write(hsStream *s, hsResMgr *mgr) override;
@@ -241,6 +253,7 @@ public:
 
     void PrepareEffect(const plEffectTargetInfo& target) override;
     bool ApplyEffect(const plEffectTargetInfo& target, int32_t i) override;
+    void ApplyEffectRange(const plEffectTargetInfo& target, uint32_t begin, uint32_t end, uint8_t* kill) override;
 
     void                SetScale(const hsVector3& v) { fScale = v; }
     const hsVector3&    GetScale() const { return fScale; }
@@ -275,6 +288,7 @@ public:
 
     void PrepareEffect(const plEffectTargetInfo& target) override;
     bool ApplyEffect(const plEffectTargetInfo& target, int32_t i) override;
+    void ApplyEffectRange(const plEffectTargetInfo& target, uint32_t begin, uint32_t end, uint8_t* kill) override;
 
     void        SetFrequencyRange(float minSecsPerCycle, float maxSecsPerCycle);
     void        SetFrequencyRate(float secsPerCycle);
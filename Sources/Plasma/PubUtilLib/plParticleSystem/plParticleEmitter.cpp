@@ -49,6 +49,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 #include "hsColorRGBA.h"
 #include "hsFastMath.h"
+#include "hsParallel.h"
 #include "plProfile.h"
 #include "hsResMgr.h"
 
@@ -126,6 +127,7 @@ void plParticleEmitter::IClear()
     fParticleCores = nullptr;
     delete [] fParticleExts;
     fParticleExts = nullptr;
+    fKillFlags.clear();
     if( !(fMiscFlags & kBorrowedGenerator) )
         delete fGenerator;
     fGenerator = nullptr;
@@ -137,6 +139,7 @@ void plParticleEmitter::ISetupParticleMem()
 
     fParticleCores = new plParticleCore[fMaxParticles];
     fParticleExts = new plParticleExt[fMaxParticles];
+    fKillFlags.assign(fMaxParticles, 0);
 
     fTargetInfo.fPos = (uint8_t *)fParticleCores;
     fTargetInfo.fColor = (uint8_t *)fParticleCores + sizeof(hsPoint3);
@@ -307,19 +310,18 @@ bool plParticleEmitter::IUpdate(float delta)
         return true;
 }
 
+// Fewer particles than this aren't worth handing to another thread
+static const size_t kMinParticlesPerJob = 256;
+
 void plParticleEmitter::IUpdateParticles(float delta)
 {
     // Have to remove particles before adding new ones, or we can run out of room.
     for (uint32_t i = 0; i < fNumValidParticles; i++)
     {
         fParticleExts[i].fLife -= delta;
-        if (fParticleExts[i].fLife <= 0 && !(fParticleExts[i].fMiscFlags & plParticleExt::kImmortal))
-        {
-            IRemoveParticle(i);
-            i--; // so that we hit this index again on the next iteration
-            continue;
-        }
+        fKillFlags[i] = fParticleExts[i].fLife <= 0 && !(fParticleExts[i].fMiscFlags & plParticleExt::kImmortal);
     }
+    IRemoveKilledParticles();
 
     fTargetInfo.fFirstNewParticle = fNumValidParticles;
     
@@ -338,14 +340,6 @@ void plParticleEmitter::IUpdateParticles(float delta)
 
     fTargetInfo.fContext = fSystem->fContext;
     fTargetInfo.fNumValidParticles = fNumValidParticles;
-    const hsVector3 up(0.f, 0.f, 1.0f);
-    hsVector3 currDirection;
-    hsPoint3 *currPos;
-    hsVector3 *currVelocity;
-    hsVector3 *currAccel;
-    hsPoint3 color(fColor.r, fColor.g, fColor.b);
-    float alpha = fColor.a;
-    plController *colorCtl;
 
     // Allow effects a chance to cache any upfront calculations
     // that will apply to all particles.
@@ -362,120 +356,170 @@ void plParticleEmitter::IUpdateParticles(float delta)
         constraint->PrepareEffect(fTargetInfo);
     }
 
-    for (uint32_t i = 0; i < fNumValidParticles; i++)
+    // The controllers cache their last key, so they stay on this thread.
+    IUpdateColorsAndSizes();
+
+    // Everything else only touches the particle it's working on, so split
+    // the particles up and run each stage over a whole batch at a time.
+    hsParallelFor(fNumValidParticles, kMinParticlesPerJob, [this, delta](size_t begin, size_t end) {
+        IUpdateParticleRange(uint32_t(begin), uint32_t(end), delta);
+    });
+
+    // Notify the effects that they are done for now.
+    for (plParticleEffect* forceEffect : fSystem->fForces)
     {
-        if (!( fParticleExts[i].fMiscFlags & plParticleExt::kImmortal ))
-        {           
-            float percent = (1.0f - fParticleExts[i].fLife / fParticleExts[i].fStartLife);
-            colorCtl = (fMiscFlags & kMatIsEmissive ? fSystem->fAmbientCtl : fSystem->fDiffuseCtl);
-            if (colorCtl != nullptr)
-                colorCtl->Interp(colorCtl->GetLength() * percent, &color);
-
-            if (fSystem->fOpacityCtl != nullptr)
-            {
-                fSystem->fOpacityCtl->Interp(fSystem->fOpacityCtl->GetLength() * percent, &alpha);
-                alpha /= 100.0f;
-                if (alpha < 0)
-                    alpha = 0;
-                else if (alpha > 1.f)
-                    alpha = 1.f;
-            }
+        forceEffect->EndEffect(fTargetInfo);
+    }
+    for (plParticleEffect* effect : fSystem->fEffects)
+    {
+        effect->EndEffect(fTargetInfo);
+    }
+    for (plParticleEffect* constraint : fSystem->fConstraints)
+    {
+        constraint->EndEffect(fTargetInfo);
+    }
 
-            if (fSystem->fWidthCtl != nullptr)
-            {
-                fSystem->fWidthCtl->Interp(fSystem->fWidthCtl->GetLength() * percent,
-                                           &fParticleCores[i].fHSize);
-                fParticleCores[i].fHSize *= fParticleExts[i].fScale;
-            }
-            if (fSystem->fHeightCtl != nullptr)
-            {
-                fSystem->fHeightCtl->Interp(fSystem->fHeightCtl->GetLength() * percent,
-                                            &fParticleCores[i].fVSize);
-                fParticleCores[i].fVSize *= fParticleExts[i].fScale;
-            }
+    // Constraints flag the particles they want dead rather than pulling
+    // them out from under the other threads.
+    IRemoveKilledParticles();
+}
 
-            fParticleCores[i].fColor = CreateHexColor(color.fX, color.fY, color.fZ, alpha);                     
+void plParticleEmitter::IUpdateColorsAndSizes()
+{
+    plController* colorCtl = (fMiscFlags & kMatIsEmissive ? fSystem->fAmbientCtl : fSystem->fDiffuseCtl);
+    if (colorCtl == nullptr && fSystem->fOpacityCtl == nullptr &&
+        fSystem->fWidthCtl == nullptr && fSystem->fHeightCtl == nullptr)
+    {
+        // Nothing animates, so everybody gets the material color back
+        uint32_t hexColor = CreateHexColor(fColor);
+        for (uint32_t i = 0; i < fNumValidParticles; i++)
+        {
+            if (!( fParticleExts[i].fMiscFlags & plParticleExt::kImmortal ))
+                fParticleCores[i].fColor = hexColor;
         }
+        return;
+    }
+
+    hsPoint3 color(fColor.r, fColor.g, fColor.b);
+    float alpha = fColor.a;
+
+    for (uint32_t i = 0; i < fNumValidParticles; i++)
+    {
+        if (fParticleExts[i].fMiscFlags & plParticleExt::kImmortal)
+            continue;
+
+        float percent = (1.0f - fParticleExts[i].fLife / fParticleExts[i].fStartLife);
+        if (colorCtl != nullptr)
+            colorCtl->Interp(colorCtl->GetLength() * percent, &color);
 
-        for (plParticleEffect* forceEffect : fSystem->fForces)
+        if (fSystem->fOpacityCtl != nullptr)
         {
-            forceEffect->ApplyEffect(fTargetInfo, i);
+            fSystem->fOpacityCtl->Interp(fSystem->fOpacityCtl->GetLength() * percent, &alpha);
+            alpha /= 100.0f;
+            if (alpha < 0)
+                alpha = 0;
+            else if (alpha > 1.f)
+                alpha = 1.f;
         }
-        
-        currPos = (hsPoint3 *)(fTargetInfo.fPos + i * fTargetInfo.fPosStride);
-        currVelocity = (hsVector3 *)(fTargetInfo.fVelocity + i * fTargetInfo.fVelocityStride);
-        //currAccel = (hsVector3 *)(fTargetInfo.fAcceleration + i * fTargetInfo.fAccelerationStride);
-        currAccel = &fSystem->fAccel; // Nothing accellerates on a per-particle basis (yet)
 
-        *currPos += *currVelocity * delta;
-
-        // This is the only orientation option (so far) that requires an update here
-        if (fMiscFlags & (kOrientationVelocityBased | kOrientationVelocityStretch | kOrientationVelocityFlow))
+        if (fSystem->fWidthCtl != nullptr)
         {
-            // mf - want the orientation to be a delposition
-            hsVector3 tmp = *currVelocity * delta;
-            fParticleCores[i].fOrientation.Set(&tmp);
+            fSystem->fWidthCtl->Interp(fSystem->fWidthCtl->GetLength() * percent,
+                                       &fParticleCores[i].fHSize);
+            fParticleCores[i].fHSize *= fParticleExts[i].fScale;
         }
-        else if( fParticleExts[i].fRadsPerSec != 0 )
+        if (fSystem->fHeightCtl != nullptr)
         {
-            float sinX, cosX;
-            hsFastMath::SinCos(fParticleExts[i].fLife * fParticleExts[i].fRadsPerSec * hsConstants::two_pi<float>, sinX, cosX);
-            fParticleCores[i].fOrientation.Set(sinX, -cosX, 0);
+            fSystem->fHeightCtl->Interp(fSystem->fHeightCtl->GetLength() * percent,
+                                        &fParticleCores[i].fVSize);
+            fParticleCores[i].fVSize *= fParticleExts[i].fScale;
         }
 
-        // Viscous force F(t) = -k V(t)
-        // Integral S from t0 to t1 of F(t) is
-        // = S(-kV(t))[t1..t0]
-        // = -k(P(t1) - P(t0))
-        // = -k*(currVelocity * delta)
-        // or
-        // V = V + -k*(V * delta)
-        // V *= (1 + -k * delta)
-        // Giving the change in velocity.
-        float drag = 1.f + fSystem->fDrag * delta;
-        // Clamp it at 0. Drag should never cause a reversal in velocity direction.
-        if( drag < 0.f )
-            drag = 0.f;
-        *currVelocity *= drag;
-
-        *currVelocity += *currAccel * delta;
-
-        for (plParticleEffect* effect : fSystem->fEffects)
+        fParticleCores[i].fColor = CreateHexColor(color.fX, color.fY, color.fZ, alpha);
+    }
+}
+
+void plParticleEmitter::IUpdateParticleRange(uint32_t begin, uint32_t end, float delta)
+{
+    for (plParticleEffect* forceEffect : fSystem->fForces)
+    {
+        forceEffect->ApplyEffectRange(fTargetInfo, begin, end, nullptr);
+    }
+
+    // This is the only orientation option (so far) that requires an update here
+    if (fMiscFlags & (kOrientationVelocityBased | kOrientationVelocityStretch | kOrientationVelocityFlow))
+    {
+        for (uint32_t i = begin; i < end; i++)
         {
-            effect->ApplyEffect(fTargetInfo, i);
+            // mf - want the orientation to be a delposition
+            hsVector3 tmp = fParticleExts[i].fVelocity * delta;
+            fParticleCores[i].fOrientation.Set(&tmp);
         }
-
-        // We may need to do more than one iteration through the constraints. It's a trade-off
-        // between accurracy and speed (what's new?) but I'm going to go with just one
-        // for now until we decide things don't "look right"
-        for (plParticleEffect* constraint : fSystem->fConstraints)
+    }
+    else
+    {
+        for (uint32_t i = begin; i < end; i++)
         {
-            if (constraint->ApplyEffect(fTargetInfo, i))
+            if( fParticleExts[i].fRadsPerSec != 0 )
             {
-                IRemoveParticle(i);
-                i--; // so that we hit this index again on the next iteration
-                break; 
-                // break will break us out of loop over constraints,
-                // and since we're last, we move onto next particle.
+                float sinX, cosX;
+                hsFastMath::SinCos(fParticleExts[i].fLife * fParticleExts[i].fRadsPerSec * hsConstants::two_pi<float>, sinX, cosX);
+                fParticleCores[i].fOrientation.Set(sinX, -cosX, 0);
             }
         }
     }
 
-    // Notify the effects that they are done for now.
-    for (plParticleEffect* forceEffect : fSystem->fForces)
-    {
-        forceEffect->EndEffect(fTargetInfo);
-    }
+    // Viscous force F(t) = -k V(t)
+    // Integral S from t0 to t1 of F(t) is
+    // = S(-kV(t))[t1..t0]
+    // = -k(P(t1) - P(t0))
+    // = -k*(currVelocity * delta)
+    // or
+    // V = V + -k*(V * delta)
+    // V *= (1 + -k * delta)
+    // Giving the change in velocity.
+    float drag = 1.f + fSystem->fDrag * delta;
+    // Clamp it at 0. Drag should never cause a reversal in velocity direction.
+    if( drag < 0.f )
+        drag = 0.f;
+
+    // Nothing accelerates on a per-particle basis (yet)
+    integrate.call(fParticleCores, fParticleExts, begin, end, delta, drag, fSystem->fAccel);
+
     for (plParticleEffect* effect : fSystem->fEffects)
     {
-        effect->EndEffect(fTargetInfo);
+        effect->ApplyEffectRange(fTargetInfo, begin, end, nullptr);
     }
+
+    // We may need to do more than one iteration through the constraints. It's a trade-off
+    // between accurracy and speed (what's new?) but I'm going to go with just one
+    // for now until we decide things don't "look right"
+    memset(fKillFlags.data() + begin, 0, end - begin);
     for (plParticleEffect* constraint : fSystem->fConstraints)
     {
-        constraint->EndEffect(fTargetInfo);
+        constraint->ApplyEffectRange(fTargetInfo, begin, end, fKillFlags.data());
+    }
+}
+
+void plParticleEmitter::integrate_fpu(plParticleCore* cores, plParticleExt* exts, uint32_t begin, uint32_t end,
+                                      float delta, float drag, const hsVector3& accel)
+{
+    const hsVector3 accelDelta = accel * delta;
+    for (uint32_t i = begin; i < end; i++)
+    {
+        cores[i].fPos += exts[i].fVelocity * delta;
+        exts[i].fVelocity *= drag;
+        exts[i].fVelocity += accelDelta;
     }
 }
 
+// CPU-optimized functions requiring dispatch
+hsCpuFunctionDispatcher<plParticleEmitter::integrate_ptr> plParticleEmitter::integrate {
+    &plParticleEmitter::integrate_fpu,
+    nullptr,                                    // SSE1
+    &plParticleEmitter::integrate_sse2
+};
+
 plProfile_CreateTimer("Bound", "Particles", ParticleBound);
 plProfile_CreateTimer("Normal", "Particles", ParticleNormal);
 
@@ -527,19 +571,23 @@ void plParticleEmitter::IUpdateBoundsAndNormals(float delta)
     plProfile_EndTiming(ParticleNormal);
 }
 
-void plParticleEmitter::IRemoveParticle(uint32_t index)
+void plParticleEmitter::IRemoveKilledParticles()
 {
-    hsAssert(index < fNumValidParticles, "Trying to remove an invalid particle");
-
-    fNumValidParticles--;
-    if (fNumValidParticles <= 0)
+    // Swap the last particle into each dead one's slot.
+    uint32_t i = 0;
+    while (i < fNumValidParticles)
     {
-        fNumValidParticles = 0;
-        return;
-    }
+        if (!fKillFlags[i])
+        {
+            i++;
+            continue;
+        }
 
-    fParticleCores[index] = fParticleCores[fNumValidParticles];
-    fParticleExts[index] = fParticleExts[fNumValidParticles];
+        fNumValidParticles--;
+        fParticleCores[i] = fParticleCores[fNumValidParticles];
+        fParticleExts[i] = fParticleExts[fNumValidParticles];
+        fKillFlags[i] = fKillFlags[fNumValidParticles];
+    }
 }
 
 // Reading and writing doesn't transfer individual particle info. We assume those are expendable.
@@ -45,6 +45,9 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "hsGeometry3.h"
 #include "hsBounds.h"
 #include "hsColorRGBA.h"
+#include "hsCpuID.h"
+
+#include <vector>
 
 #include "plEffectTargetInfo.h"
 
@@ -148,13 +151,30 @@ protected:
     hsMatrix44 fLocalToWorld;
     float fTimeToLive;
 
+    std::vector<uint8_t> fKillFlags;    // One per particle, set for the ones to remove at the end of an update pass.
+
     void IClear();
     void ISetupParticleMem();
     void ISetSystem(plParticleSystem *sys) { fSystem = sys; }
     bool IUpdate(float delta);
     void IUpdateParticles(float delta);
+    void IUpdateColorsAndSizes();
+    void IUpdateParticleRange(uint32_t begin, uint32_t end, float delta);
     void IUpdateBoundsAndNormals(float delta);
-    void IRemoveParticle(uint32_t index);
+    void IRemoveKilledParticles();
+
+    // CPU-optimized integration step. Moves each particle by its velocity, then applies
+    // drag and the system's acceleration to the velocity.
+    typedef void(*integrate_ptr)(plParticleCore* cores, plParticleExt* exts, uint32_t begin, uint32_t end,
+                                 float delta, float drag, const hsVector3& accel);
+
+    static void integrate_fpu(plParticleCore* cores, plParticleExt* exts, uint32_t begin, uint32_t end,
+                              float delta, float drag, const hsVector3& accel);
+    static void integrate_sse2(plParticleCore* cores, plParticleExt* exts, uint32_t begin, uint32_t end,
+                               float delta, float drag, const hsVector3& accel);
+
+private:
+    static hsCpuFunctionDispatcher<integrate_ptr> integrate;
 };
 
 #endif
@@ -0,0 +1,74 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include "plParticleEmitter.h"
+#include "plParticle.h"
+
+#include "hsSIMD.h"
+
+void plParticleEmitter::integrate_sse2(plParticleCore* cores, plParticleExt* exts, uint32_t begin, uint32_t end,
+                                       float delta, float drag, const hsVector3& accel)
+{
+#ifdef HAVE_SSE2
+    // Position and velocity are each followed by another 4 bytes (color and
+    // inverse mass), so we can pull each one in as a whole register and just
+    // leave the last lane alone on the way back out.
+    const __m128 xyzMask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+    const __m128 delta4 = _mm_set1_ps(delta);
+    const __m128 drag4 = _mm_set1_ps(drag);
+    const __m128 accelDelta = _mm_mul_ps(_mm_set_ps(0.f, accel.fZ, accel.fY, accel.fX), delta4);
+
+    for (uint32_t i = begin; i < end; i++) {
+        float* pos = &cores[i].fPos.fX;
+        float* vel = &exts[i].fVelocity.fX;
+
+        __m128 p = _mm_loadu_ps(pos);
+        __m128 v = _mm_loadu_ps(vel);
+
+        __m128 newP = _mm_add_ps(p, _mm_mul_ps(v, delta4));
+        __m128 newV = _mm_add_ps(_mm_mul_ps(v, drag4), accelDelta);
+
+        _mm_storeu_ps(pos, _mm_or_ps(_mm_and_ps(xyzMask, newP), _mm_andnot_ps(xyzMask, p)));
+        _mm_storeu_ps(vel, _mm_or_ps(_mm_and_ps(xyzMask, newV), _mm_andnot_ps(xyzMask, v)));
+    }
+#endif // HAVE_SSE2
+}
@@ -48,6 +48,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "plPXSubWorld.h"
 #include "plSimulationMgr.h"
 
+#include "hsParallel.h"
 #include "plProfile.h"
 
 #include "pnNetCommon/plNetApp.h"
@@ -73,6 +74,7 @@ constexpr float kToleranceScaleSpeed = 32.f;
 
 plProfile_CreateTimer(  "Apply Controller Animations", "Simulation", ApplyController);
 plProfile_CreateTimer(  "PhysX Simulation", "Simulation", Step);
+plProfile_CreateTimer(  "  Subworld Step", "Simulation", SubworldStep);
 plProfile_CreateTimer(  "  Contact Callback", "Simulation", ContactCallback);
 plProfile_CreateTimer(  "  Trigger Callback", "Simulation", TriggerCallback);
 plProfile_CreateCounter("  Active Bodies", "Simulation", ActiveBodies);
@@ -309,7 +311,7 @@ static physx::PxFilterFlags ISimulationFilterShader(physx::PxFilterObjectAttribu
 
 plPXSimulation::plPXSimulation()
     : fPxFoundation(), fDebugger(), fTransport(), fPxPhysics(), fPxCooking(),
-      fPxCpuDispatcher(), fAccumulator()
+      fPxCpuDispatcher(), fAccumulator(), fParallelSubworlds()
 {
 }
 
@@ -339,6 +341,13 @@ plPXSimulation::~plPXSimulation()
 
 // ==========================================================================
 
+static uint32_t s_defaultWorkerThreads = 0;
+
+void plPXSimulation::SetDefaultWorkerThreads(uint32_t threads)
+{
+    s_defaultWorkerThreads = threads;
+}
+
 bool plPXSimulation::Init()
 {
     plStatusLog::AddLineSF("Simulation.log", "Attempting to initialize PhysX {}.{}.{}",
@@ -384,12 +393,14 @@ bool plPXSimulation::Init()
 
     // Worker threads actually slow down our simulation - probably because Uru scenes are mostly
     // composed of static geometry, so the thread synchronization adds more overhead than the
-    // threads help.
-    fPxCpuDispatcher = physx::PxDefaultCpuDispatcherCreate(0);
+    // threads help. So, none by default, but it can be overridden to measure heavier Ages.
+    fPxCpuDispatcher = physx::PxDefaultCpuDispatcherCreate(s_defaultWorkerThreads);
     if (!fPxCpuDispatcher) {
         plStatusLog::AddLineS("Simulation.log", plStatusLog::kRed, "PhysX CPU Dispatcher failed to initialize!");
         return false;
     }
+    plStatusLog::AddLineSF("Simulation.log", "PhysX CPU Dispatcher is using {} worker threads",
+                           s_defaultWorkerThreads);
 
     physx::PxCookingParams params(scale);
     // disable mesh cleaning - perform mesh validation on development configurations
@@ -701,6 +712,24 @@ void plPXSimulation::RemoveFromWorld(physx::PxController* controller)
 
 // ==========================================================================
 
+static inline ST::string IGetWorldName(const plKey& world)
+{
+    return world ? world->GetName() : ST_LITERAL("(main world)");
+}
+
+static void IRecordStatistics(physx::PxScene* scene)
+{
+    physx::PxSimulationStatistics stats;
+    scene->getSimulationStatistics(stats);
+    plProfile_IncCount(ActiveBodies, stats.nbActiveDynamicBodies + stats.nbActiveDynamicBodies);
+    plProfile_IncCount(ActiveDynamics, stats.nbActiveDynamicBodies);
+    plProfile_IncCount(ActiveKinematics, stats.nbActiveKinematicBodies);
+    plProfile_IncCount(TotalBodies, stats.nbDynamicBodies + stats.nbKinematicBodies + stats.nbStaticBodies);
+    plProfile_IncCount(Dynamics, stats.nbDynamicBodies);
+    plProfile_IncCount(Kinematics, stats.nbKinematicBodies);
+    plProfile_IncCount(Statics, stats.nbStaticBodies);
+}
+
 bool plPXSimulation::Advance(float delta)
 {
     fAccumulator += delta;
@@ -730,19 +759,36 @@ bool plPXSimulation::Advance(float delta)
     plProfile_EndTiming(ApplyController);
 
     plProfile_BeginTiming(Step);
-    for (auto [key, world] : fWorlds) {
-        world.fScene->simulate(delta);
-        world.fScene->fetchResults(true);
-
-        physx::PxSimulationStatistics stats;
-        world.fScene->getSimulationStatistics(stats);
-        plProfile_IncCount(ActiveBodies, stats.nbActiveDynamicBodies + stats.nbActiveDynamicBodies);
-        plProfile_IncCount(ActiveDynamics, stats.nbActiveDynamicBodies);
-        plProfile_IncCount(ActiveKinematics, stats.nbActiveKinematicBodies);
-        plProfile_IncCount(TotalBodies, stats.nbDynamicBodies + stats.nbKinematicBodies + stats.nbStaticBodies);
-        plProfile_IncCount(Dynamics, stats.nbDynamicBodies);
-        plProfile_IncCount(Kinematics, stats.nbKinematicBodies);
-        plProfile_IncCount(Statics, stats.nbStaticBodies);
+    if (fParallelSubworlds && fWorlds.size() > 1) {
+        // Kick off every subworld at once. Fetching the results is what fires the contact
+        // and trigger callbacks, so that still happens here, one world at a time. The laps
+        // only see the fetch in this mode, i.e. how long we waited on each world.
+        std::vector<physx::PxScene*> scenes;
+        scenes.reserve(fWorlds.size());
+        for (const auto& [key, world] : fWorlds)
+            scenes.emplace_back(world.fScene);
+
+        hsParallelFor(scenes.size(), 1, [&scenes, delta](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                scenes[i]->simulate(delta);
+        });
+
+        for (auto [key, world] : fWorlds) {
+            plProfile_BeginLap(SubworldStep, IGetWorldName(key));
+            world.fScene->fetchResults(true);
+            plProfile_EndLap(SubworldStep, IGetWorldName(key));
+
+            IRecordStatistics(world.fScene);
+        }
+    } else {
+        for (auto [key, world] : fWorlds) {
+            plProfile_BeginLap(SubworldStep, IGetWorldName(key));
+            world.fScene->simulate(delta);
+            world.fScene->fetchResults(true);
+            plProfile_EndLap(SubworldStep, IGetWorldName(key));
+
+            IRecordStatistics(world.fScene);
+        }
     }
     plProfile_EndTiming(Step);
 
@@ -145,6 +145,7 @@ protected:
     physx::PxDefaultCpuDispatcher* fPxCpuDispatcher;
     std::map<plKey, World> fWorlds;
     float fAccumulator;
+    bool fParallelSubworlds;
 
 protected:
     bool IConnectDebugger(physx::PxPvdTransport* transport);
@@ -183,6 +184,22 @@ public:
 
     bool IsDebuggerConnected() const;
 
+    /**
+     * Sets the number of worker threads for the PhysX CPU dispatcher.
+     * The default of zero runs each scene's simulation on the thread that steps it, which
+     * has historically been fastest for Uru's mostly static scenes. Note that once the
+     * simulation is initialized, changing this value will have no effect.
+     */
+    static void SetDefaultWorkerThreads(uint32_t threads);
+
+    /**
+     * Sets whether subworlds are stepped concurrently.
+     * Subworlds never interact, so their simulations can run on separate threads. Contact and
+     * trigger callbacks are still delivered one subworld at a time on the calling thread.
+     */
+    void SetParallelSubworlds(bool parallel) { fParallelSubworlds = parallel; }
+    bool GetParallelSubworlds() const { return fParallelSubworlds; }
+
 protected:
     /** Creates a scene/subworld. */
     [[nodiscard]]
@@ -42,6 +42,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #ifndef _pl3DPipeline_inc_
 #define _pl3DPipeline_inc_
 
+#include <algorithm>
 #include <stack>
 #include <string_theory/string>
 #include <vector>
@@ -106,6 +107,7 @@ static const float kPerspLayerScaleW = 0.001f;
 static const float kPerspLayerTrans  = 0.00002f;
 
 static const float kAvTexPoolShrinkThresh = 30.f; // seconds
+static const uint32_t kAvTexMaxRebuildsPerFrame = 4;
 
 class plDisplayHelper
 {
@@ -785,6 +787,16 @@ protected:
     void ISetShadowFromGroup(plDrawableSpans* drawable, const plSpan* span, plLightInfo* liInfo);
 
     void IClearClothingOutfits(std::vector<plClothingOutfit*>* outfits);
+
+    /**
+     * Moves outfits that don't have an avatar texture yet ahead of ones that
+     * are merely out of date. Out of date outfits can keep showing their old
+     * texture for a few frames while we work through the queue, so a crowd of
+     * avatars rebuilding at once is spread over kAvTexMaxRebuildsPerFrame
+     * rebuilds a frame instead of stalling a single frame.
+     */
+    void IPrioritizeClothingOutfits();
+
     void IFillAvRTPool();
 
     /**
@@ -1491,6 +1503,15 @@ void pl3DPipeline<DeviceType>::IClearClothingOutfits(std::vector<plClothingOutfi
 }
 
 
+template <class DeviceType>
+void pl3DPipeline<DeviceType>::IPrioritizeClothingOutfits()
+{
+    std::stable_partition(fClothingOutfits.begin(), fClothingOutfits.end(), [](plClothingOutfit* co) {
+        return plRenderTarget::ConvertNoRef(co->fTargetLayer->GetTexture()) == nullptr;
+    });
+}
+
+
 template <class DeviceType>
 void pl3DPipeline<DeviceType>::IFillAvRTPool()
 {
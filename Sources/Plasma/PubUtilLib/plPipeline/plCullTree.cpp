@@ -45,6 +45,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 #include "hsColorRGBA.h"
 #include "hsFastMath.h"
+#include "hsParallel.h"
 #include "plProfile.h"
 #include "plTweak.h"
 
@@ -69,6 +70,11 @@ static const float kTolerance = 1.e-1f;
 
 plProfile_CreateCounter("Harvest Nodes", "Draw", HarvestNodes);
 
+// Don't bother splitting the harvest across the workers for less than this many leaves
+static constexpr int32_t kMinParallelLeaves = 512;
+// Subtrees handed out per thread, so an uneven split still balances out
+static constexpr size_t kRootsPerThread = 4;
+
 //////////////////////////////////////////////////////////////////////
 // Harvest culling section.
 // These are the functions used on a built tree
@@ -137,9 +143,19 @@ plCullNode::plCullStatus plCullNode::TestBounds(const hsBounds3Ext& bnd) const
         return kClear;
 #endif // MF_TEST_SPHERE_FIRST
 
+    return ITestBox(bnd);
+}
+
+plCullNode::plCullStatus plCullNode::ITestBox(const hsBounds3Ext& bnd) const
+{
     hsPoint2 depth;
     bnd.TestPlane(fNorm, depth);
 
+    return ITestDepth(depth);
+}
+
+plCullNode::plCullStatus plCullNode::ITestDepth(const hsPoint2& depth) const
+{
     const float kSafetyDist = -0.1f;
     if( depth.fY + fDist < kSafetyDist )
         return kCulled;
@@ -264,50 +280,49 @@ plCullNode::plCullStatus plCullNode::ITestNode(const plSpaceTree* space, int16_t
 }
 
 // Cycle through the Cull Nodes, paring down the list of who to test (through ITestNode above).
+// Everything here works out of the caller's scratch, so separate subtrees can be run at once.
 // We reclaim the scratch indices in clear and split when we're done (SetCount(0)), but we can't
 // reclaim the culled, because our caller may be looking at who all we culled. See below in split.
 // If a node is disabled, we can just ignore we ever got called.
-void plCullNode::ITestNode(const plSpaceTree* space, int16_t who, hsBitVector& totList, hsBitVector& outList) const
+void plCullNode::ITestNode(const plSpaceTree* space, int16_t who, plCullScratch& scratch) const
 {
     if( space->IsDisabled(who) )
         return;
 
-    size_t myClearStart = ScratchClear().size();
-    size_t mySplitStart = ScratchSplit().size();
-    size_t myCullStart = ScratchCulled().size();
+    size_t myClearStart = scratch.fClear.size();
+    size_t mySplitStart = scratch.fSplit.size();
+    size_t myCullStart = scratch.fCulled.size();
 
-    if( kPureSplit == ITestNode(space, who, ScratchClear(), ScratchSplit(), ScratchCulled()) )
-        ScratchSplit().emplace_back(who);
+    if( kPureSplit == ITestNode(space, who, scratch.fClear, scratch.fSplit, scratch.fCulled) )
+        scratch.fSplit.emplace_back(who);
 
-    size_t myClearEnd = ScratchClear().size();
-    size_t mySplitEnd = ScratchSplit().size();
-    size_t myCullEnd = ScratchCulled().size();
+    size_t myClearEnd = scratch.fClear.size();
+    size_t mySplitEnd = scratch.fSplit.size();
+    size_t myCullEnd = scratch.fCulled.size();
 
     // If there's no OuterChild, everything in clear and split is visible. Everything in culled
     // goes to innerchild (if any).
     if( fOuterChild < 0 )
     {
-        plProfile_IncCount(HarvestNodes, myClearEnd - myClearStart + mySplitEnd - mySplitStart);
-        // Replace these with a memcopy or something!!!!
         for (size_t i = myClearStart; i < myClearEnd; i++)
         {
-            space->HarvestLeaves(ScratchClear()[i], totList, outList);
+            scratch.MarkVisible(scratch.fClear[i]);
         }
         for (size_t i = mySplitStart; i < mySplitEnd; i++)
         {
-            space->HarvestLeaves(ScratchSplit()[i], totList, outList);
+            scratch.MarkVisible(scratch.fSplit[i]);
         }
 
         if( fInnerChild >= 0 )
         {
             for (size_t i = myCullStart; i < myCullEnd; i++)
             {
-                IGetNode(fInnerChild)->ITestNode(space, ScratchCulled()[i], totList, outList);
+                IGetNode(fInnerChild)->ITestNode(space, scratch.fCulled[i], scratch);
             }
         }
-        ScratchClear().resize(myClearStart);
-        ScratchSplit().resize(mySplitStart);
-        ScratchCulled().resize(myCullStart);
+        scratch.fClear.resize(myClearStart);
+        scratch.fSplit.resize(mySplitStart);
+        scratch.fCulled.resize(myCullStart);
 
         return;
     }
@@ -316,7 +331,7 @@ void plCullNode::ITestNode(const plSpaceTree* space, int16_t who, hsBitVector& t
     // everything in ClearList is visible soley on the discretion of OuterChild.
     for (size_t i = myClearStart; i < myClearEnd; i++)
     {
-        IGetNode(fOuterChild)->ITestNode(space, ScratchClear()[i], totList, outList);
+        IGetNode(fOuterChild)->ITestNode(space, scratch.fClear[i], scratch);
     }
 
     // If there's no InnerChild, then the SplitList is also visible soley
@@ -325,12 +340,12 @@ void plCullNode::ITestNode(const plSpaceTree* space, int16_t who, hsBitVector& t
     {
         for (size_t i = mySplitStart; i < mySplitEnd; i++)
         {
-            IGetNode(fOuterChild)->ITestNode(space, ScratchSplit()[i], totList, outList);
+            IGetNode(fOuterChild)->ITestNode(space, scratch.fSplit[i], scratch);
         }
 
-        ScratchClear().resize(myClearStart);
-        ScratchSplit().resize(mySplitStart);
-        ScratchCulled().resize(myCullStart);
+        scratch.fClear.resize(myClearStart);
+        scratch.fSplit.resize(mySplitStart);
+        scratch.fCulled.resize(myCullStart);
 
         return;
     }
@@ -339,7 +354,7 @@ void plCullNode::ITestNode(const plSpaceTree* space, int16_t who, hsBitVector& t
     // soley on its discretion.
     for (size_t i = myCullStart; i < myCullEnd; i++)
     {
-        IGetNode(fInnerChild)->ITestNode(space, ScratchCulled()[i], totList, outList);
+        IGetNode(fInnerChild)->ITestNode(space, scratch.fCulled[i], scratch);
     }
 
     // Okay, here's the rub.
@@ -350,37 +365,25 @@ void plCullNode::ITestNode(const plSpaceTree* space, int16_t who, hsBitVector& t
     // so InnerChild adding a subTree and OuterChild adding a child of that subTree isn't
     // even appending the same value to the list.
     // Sooooo.
-    // What we do is keep track of every node (interior and leaf) that gets harvested.
-    // When we go to harvest a subtree, we check in totList for its bit being set. Bits
-    // set in totList are ENTIRE SUBTREE IS HARVESTED. SpaceTree understands this too in
-    // its HarvestLeaves. Seems obvious now, but I didn't hear you suggest it.
+    // What we do is keep track of every subtree that gets marked visible, and skip
+    // the InnerChild for any the OuterChild already took whole. Anything that slips
+    // through twice is sorted out when the leaves are gathered, because SpaceTree's
+    // HarvestLeaves won't harvest a subtree whose bit is already set in totList.
 
     for (size_t i = mySplitStart; i < mySplitEnd; i++)
     {
-        IGetNode(fOuterChild)->ITestNode(space, ScratchSplit()[i], totList, outList);
+        IGetNode(fOuterChild)->ITestNode(space, scratch.fSplit[i], scratch);
     }
 
     for (size_t i = mySplitStart; i < mySplitEnd; i++)
     {
-        if( !totList.IsBitSet(ScratchSplit()[i]) )
-            IGetNode(fInnerChild)->ITestNode(space, ScratchSplit()[i], totList, outList);
+        if( !scratch.fVisibleBits.IsBitSet(scratch.fSplit[i]) )
+            IGetNode(fInnerChild)->ITestNode(space, scratch.fSplit[i], scratch);
     }
 
-    ScratchClear().resize(myClearStart);
-    ScratchSplit().resize(mySplitStart);
-    ScratchCulled().resize(myCullStart);
-}
-
-void plCullNode::IHarvest(const plSpaceTree* space, std::vector<int16_t>& outList) const
-{
-    ITestNode(space, space->GetRoot(), ScratchTotVec(), ScratchBitVec());
-    ScratchBitVec().Enumerate(outList);
-    ScratchBitVec().Clear();
-    ScratchTotVec().Clear();
-
-    ScratchClear().clear();
-    ScratchSplit().clear();
-    ScratchCulled().clear();
+    scratch.fClear.resize(myClearStart);
+    scratch.fSplit.resize(mySplitStart);
+    scratch.fCulled.resize(myCullStart);
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -1059,12 +1062,188 @@ void plCullTree::SetViewPos(const hsPoint3& p)
 //////////////////////////////////////////////////////////////////////
 // Use the tree
 //////////////////////////////////////////////////////////////////////
+void plCullScratch::Reset()
+{
+    fClear.clear();
+    fSplit.clear();
+    fCulled.clear();
+    fVisible.clear();
+    fVisibleBits.Clear();
+}
+
+void plCullScratch::MarkVisible(int16_t who)
+{
+    if( !fVisibleBits.IsBitSet(who) )
+    {
+        fVisibleBits.SetBit(who);
+        fVisible.emplace_back(who);
+    }
+}
+
+// A tree with no polys added is just the frustum planes, chained through their
+// outer children. Those we can pack up and test together, dropping each plane
+// as soon as a subtree is known to be wholly inside it.
+bool plCullTree::IBuildPlanes() const
+{
+    fPlanes.fNumPlanes = 0;
+    for( int16_t i = fRoot; i >= 0; i = fNodeList[i].fOuterChild )
+    {
+        const plCullNode& node = fNodeList[i];
+        if( node.fInnerChild >= 0 || fPlanes.fNumPlanes >= plCullPlanes::kMaxPlanes )
+            return false;
+
+        uint32_t idx = fPlanes.fNumPlanes++;
+        fPlanes.fNormX[idx] = node.fNorm.fX;
+        fPlanes.fNormY[idx] = node.fNorm.fY;
+        fPlanes.fNormZ[idx] = node.fNorm.fZ;
+        fPlanes.fDist[idx] = node.fDist;
+        fPlanes.fNodes[idx] = i;
+    }
+    if( !fPlanes.fNumPlanes )
+        return false;
+
+    // Pad out to a whole group of four. The padding is never in the active mask.
+    for( uint32_t i = fPlanes.fNumPlanes; i < ((fPlanes.fNumPlanes + 3) & ~3); i++ )
+    {
+        fPlanes.fNormX[i] = fPlanes.fNormY[i] = fPlanes.fNormZ[i] = 0;
+        fPlanes.fDist[i] = 0;
+        fPlanes.fNodes[i] = -1;
+    }
+    return true;
+}
+
+// Split the top of the space tree into enough independent subtrees to keep the
+// workers busy. Small trees aren't worth it, so they go in whole.
+void plCullTree::IBuildHarvestRoots(const plSpaceTree* space) const
+{
+    fHarvestRoots.clear();
+    fHarvestRoots.emplace_back(space->GetRoot());
+
+    const size_t numThreads = hsParallelThreadCount();
+    if( numThreads < 2 || space->GetNumLeaves() < kMinParallelLeaves )
+        return;
+
+    const size_t wantRoots = numThreads * kRootsPerThread;
+    std::vector<int16_t> next;
+    while( fHarvestRoots.size() < wantRoots )
+    {
+        bool split = false;
+        next.clear();
+        for( int16_t who : fHarvestRoots )
+        {
+            // Disabled or degenerate subtrees would be thrown away whole anyway.
+            const plSpaceTreeNode& node = space->GetNode(who);
+            if( space->IsDisabled(who) || (node.fWorldBounds.GetType() != kBoundsNormal) )
+                continue;
+
+            if( node.IsLeaf() )
+            {
+                next.emplace_back(who);
+            }
+            else
+            {
+                next.emplace_back(node.GetChild(0));
+                next.emplace_back(node.GetChild(1));
+                split = true;
+            }
+        }
+        fHarvestRoots.swap(next);
+        if( !split )
+            break;
+    }
+}
+
+// Frustum only version of plCullNode::ITestNode, run over the space tree's compact
+// nodes. The sphere test is done against all the remaining planes at once, and only
+// the planes the sphere straddles get the tighter box test. A subtree is visible
+// once no planes remain.
+void plCullTree::ITestPlanesRecur(const plSpaceTree* space, int16_t c, uint32_t active, plCullScratch& scratch) const
+{
+    const plSpaceTreeCompact& compact = space->GetCompact();
+    if( space->IsCompactDisabled(c) || !compact.IsNormal(c) )
+        return;
+
+    uint32_t culled, clear;
+    test_spheres.call(fPlanes, compact.GetCenter(c), compact.fRadius[c], culled, clear);
+    if( culled & active )
+        return;
+    active &= ~clear;
+
+    if( active )
+    {
+        const hsPoint3 mins = compact.GetMins(c);
+        const hsPoint3 maxs = compact.GetMaxs(c);
+        for( uint32_t i = 0; active >> i; i++ )
+        {
+            if( !(active & (1 << i)) )
+                continue;
+
+            const plCullNode* node = IGetNode(fPlanes.fNodes[i]);
+            plCullNode::plCullStatus stat;
+            if( compact.IsAxisAligned(c) )
+            {
+                hsPoint2 depth;
+                hsBounds3::TestBoxPlane(mins, maxs, node->fNorm, depth);
+                stat = node->ITestDepth(depth);
+            }
+            else
+            {
+                stat = node->ITestBox(space->GetNode(compact.fNode[c]).fWorldBounds);
+            }
+
+            if( stat == plCullNode::kCulled )
+                return;
+            if( stat == plCullNode::kClear )
+                active &= ~(1 << i);
+        }
+    }
+
+    if( !active || compact.IsLeaf(c) )
+    {
+        scratch.MarkVisible(compact.fNode[c]);
+        return;
+    }
+
+    ITestPlanesRecur(space, c + 1, active, scratch);
+    ITestPlanesRecur(space, compact.fSecondChild[c], active, scratch);
+}
+
 void plCullTree::Harvest(const plSpaceTree* space, std::vector<int16_t>& outList) const
 {
     outList.clear();
-    if (!space->IsEmpty())
-        IGetRoot()->IHarvest(space, outList);
+    if (space->IsEmpty())
+        return;
 
+    IBuildHarvestRoots(space);
+    if (fHarvestScratch.size() < fHarvestRoots.size())
+        fHarvestScratch.resize(fHarvestRoots.size());
+
+    // Only the plane tests run on the workers. They each record which subtrees
+    // they found visible, and we gather up the leaves here afterwards.
+    bool frustumOnly = IBuildPlanes();
+    uint32_t allPlanes = frustumOnly ? (1 << fPlanes.fNumPlanes) - 1 : 0;
+    hsParallelFor(fHarvestRoots.size(), 1, [this, space, frustumOnly, allPlanes](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            plCullScratch& scratch = fHarvestScratch[i];
+            scratch.Reset();
+            if (frustumOnly)
+                ITestPlanesRecur(space, space->GetCompactIndex(fHarvestRoots[i]), allPlanes, scratch);
+            else
+                IGetRoot()->ITestNode(space, fHarvestRoots[i], scratch);
+        }
+    });
+
+    for (size_t i = 0; i < fHarvestRoots.size(); ++i)
+    {
+        const plCullScratch& scratch = fHarvestScratch[i];
+        plProfile_IncCount(HarvestNodes, scratch.fVisible.size());
+        for (int16_t who : scratch.fVisible)
+            space->HarvestLeaves(who, ScratchTotVec(), ScratchBitVec());
+    }
+    ScratchBitVec().Enumerate(outList);
+    ScratchBitVec().Clear();
+    ScratchTotVec().Clear();
 }
 
 bool plCullTree::BoundsVisible(const hsBounds3Ext& bnd) const
@@ -1077,3 +1256,25 @@ bool plCullTree::SphereVisible(const hsPoint3& center, float rad) const
     return plCullNode::kCulled != IGetRoot()->ITestSphereRecur(center, rad);
 }
 
+
+void plCullTree::test_spheres_fpu(const plCullPlanes& planes, const hsPoint3& center, float rad,
+                                  uint32_t& culled, uint32_t& clear)
+{
+    culled = clear = 0;
+    for (uint32_t i = 0; i < planes.fNumPlanes; ++i)
+    {
+        float dist = planes.fNormX[i] * center.fX + planes.fNormY[i] * center.fY + planes.fNormZ[i] * center.fZ
+                   + planes.fDist[i];
+        if (dist < -rad)
+            culled |= 1 << i;
+        else if (dist > rad)
+            clear |= 1 << i;
+    }
+}
+
+// CPU-optimized functions requiring dispatch
+hsCpuFunctionDispatcher<plCullTree::test_spheres_ptr> plCullTree::test_spheres {
+    &plCullTree::test_spheres_fpu,
+    nullptr,                                    // SSE1
+    &plCullTree::test_spheres_sse2
+};
@@ -46,6 +46,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include <vector>
 
 #include "hsBounds.h"
+#include "hsCpuID.h"
 #include "hsGeometry3.h"
 #include "hsBitVector.h"
 #include "plCuller.h"
@@ -63,6 +64,34 @@ struct hsPoint3;
 struct hsVector3;
 struct hsColorRGBA;
 
+// Working lists for running one subtree of the space tree through the cull tree.
+// Each concurrent harvest task gets its own, so nothing is shared between them.
+// Visible subtrees are only recorded here, the leaves are gathered afterwards.
+struct plCullScratch
+{
+    std::vector<int16_t>    fClear;
+    std::vector<int16_t>    fSplit;
+    std::vector<int16_t>    fCulled;
+    std::vector<int16_t>    fVisible;
+    hsBitVector             fVisibleBits;
+
+    void Reset();
+    void MarkVisible(int16_t who);
+};
+
+// The planes of a frustum-only cull tree, laid out for testing several at once.
+struct plCullPlanes
+{
+    enum { kMaxPlanes = 16 };
+
+    alignas(16) float   fNormX[kMaxPlanes];
+    alignas(16) float   fNormY[kMaxPlanes];
+    alignas(16) float   fNormZ[kMaxPlanes];
+    alignas(16) float   fDist[kMaxPlanes];
+    int16_t             fNodes[kMaxPlanes];
+    uint32_t            fNumPlanes;
+};
+
 class plCullTree : public plCuller
 {
 protected:
@@ -76,12 +105,14 @@ protected:
     mutable float                       fVisYon;
 
     mutable std::vector<plCullPoly> fScratchPolys;
-    mutable std::vector<int16_t>    fScratchClear;
-    mutable std::vector<int16_t>    fScratchSplit;
-    mutable std::vector<int16_t>    fScratchCulled;
     mutable hsBitVector             fScratchBitVec;
     mutable hsBitVector             fScratchTotVec;
 
+    // Harvest state, one scratch per subtree root handed out to the workers.
+    mutable std::vector<int16_t>        fHarvestRoots;
+    mutable std::vector<plCullScratch>  fHarvestScratch;
+    mutable plCullPlanes                fPlanes;
+
     void        IVisPolyShape(const plCullPoly& poly, bool dark) const;
     void        IVisPolyEdge(const hsPoint3& p0, const hsPoint3& p1, bool dark) const;
     void        IVisPoly(const plCullPoly& poly, bool dark) const;
@@ -99,11 +130,13 @@ protected:
     int16_t               IMakePolySubTree(const plCullPoly& poly) const;
     int16_t               IMakePolyNode(const plCullPoly& poly, int i0, int i1) const;
 
+    // Harvesting
+    bool                IBuildPlanes() const;
+    void                IBuildHarvestRoots(const plSpaceTree* space) const;
+    void                ITestPlanesRecur(const plSpaceTree* space, int16_t c, uint32_t active, plCullScratch& scratch) const;
+
     // Some scratch areas for the nodes use when building the tree etc.
     std::vector<plCullPoly>&        ScratchPolys() const { return fScratchPolys; }
-    std::vector<int16_t>&           ScratchClear() const { return fScratchClear; }
-    std::vector<int16_t>&           ScratchSplit() const { return fScratchSplit; }
-    std::vector<int16_t>&           ScratchCulled() const { return fScratchCulled; }
     hsBitVector&                    ScratchBitVec() const { return fScratchBitVec; }
     hsBitVector&                    ScratchTotVec() const { return fScratchTotVec; }
 
@@ -135,6 +168,20 @@ public:
     std::vector<hsColorRGBA>& GetCaptureColors() const { return fVisColors; }
     std::vector<uint16_t>&  GetCaptureTris() const { return fVisTris; }
     void                    ReleaseCapture() const;
+
+    // CPU-optimized sphere tests against every frustum plane at once. Sets a bit in
+    // culled for each plane the sphere is wholly behind, and in clear for each plane
+    // it's wholly in front of.
+    typedef void(*test_spheres_ptr)(const plCullPlanes& planes, const hsPoint3& center, float rad,
+                                    uint32_t& culled, uint32_t& clear);
+
+    static void test_spheres_fpu(const plCullPlanes& planes, const hsPoint3& center, float rad,
+                                 uint32_t& culled, uint32_t& clear);
+    static void test_spheres_sse2(const plCullPlanes& planes, const hsPoint3& center, float rad,
+                                  uint32_t& culled, uint32_t& clear);
+
+private:
+    static hsCpuFunctionDispatcher<test_spheres_ptr> test_spheres;
 };
 
 class plCullNode
@@ -174,9 +221,10 @@ protected:
     plCullNode::plCullStatus    ITestSphereRecur(const hsPoint3& center, float rad) const;
 
     // Using the nodes
+    plCullNode::plCullStatus    ITestBox(const hsBounds3Ext& bnd) const;
+    plCullNode::plCullStatus    ITestDepth(const hsPoint2& depth) const;
     plCullNode::plCullStatus    ITestNode(const plSpaceTree* space, int16_t who, std::vector<int16_t>& clear, std::vector<int16_t>& split, std::vector<int16_t>& culled) const;
-    void                        ITestNode(const plSpaceTree* space, int16_t who, hsBitVector& totList, hsBitVector& outList) const;
-    void                        IHarvest(const plSpaceTree* space, std::vector<int16_t>& outList) const;
+    void                        ITestNode(const plSpaceTree* space, int16_t who, plCullScratch& scratch) const;
 
     // Constructing the tree
     float                    IInterpVert(const hsPoint3& p0, const hsPoint3& p1, hsPoint3& out) const;
@@ -193,11 +241,6 @@ protected:
                                     plCullPoly& srcPoly) const;
 
     std::vector<plCullPoly>&        ScratchPolys() const { return fTree->ScratchPolys(); }
-    std::vector<int16_t>&           ScratchClear() const { return fTree->ScratchClear(); }
-    std::vector<int16_t>&           ScratchSplit() const { return fTree->ScratchSplit(); }
-    std::vector<int16_t>&           ScratchCulled() const { return fTree->ScratchCulled(); }
-    hsBitVector&                    ScratchBitVec() const { return fTree->ScratchBitVec(); }
-    hsBitVector&                    ScratchTotVec() const { return fTree->ScratchTotVec(); }
 
     friend class plCullTree;
 public:
@@ -0,0 +1,73 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include "plCullTree.h"
+
+#include "hsSIMD.h"
+
+void plCullTree::test_spheres_sse2(const plCullPlanes& planes, const hsPoint3& center, float rad,
+                                   uint32_t& culled, uint32_t& clear)
+{
+#ifdef HAVE_SSE2
+    const __m128 cx = _mm_set1_ps(center.fX);
+    const __m128 cy = _mm_set1_ps(center.fY);
+    const __m128 cz = _mm_set1_ps(center.fZ);
+    const __m128 posRad = _mm_set1_ps(rad);
+    const __m128 negRad = _mm_set1_ps(-rad);
+
+    culled = clear = 0;
+    for (uint32_t i = 0; i < planes.fNumPlanes; i += 4) {
+        __m128 dist = _mm_mul_ps(_mm_load_ps(&planes.fNormX[i]), cx);
+        dist = _mm_add_ps(dist, _mm_mul_ps(_mm_load_ps(&planes.fNormY[i]), cy));
+        dist = _mm_add_ps(dist, _mm_mul_ps(_mm_load_ps(&planes.fNormZ[i]), cz));
+        dist = _mm_add_ps(dist, _mm_load_ps(&planes.fDist[i]));
+
+        culled |= uint32_t(_mm_movemask_ps(_mm_cmplt_ps(dist, negRad))) << i;
+        clear |= uint32_t(_mm_movemask_ps(_mm_cmpgt_ps(dist, posRad))) << i;
+    }
+
+    // Drop whatever the padding planes said
+    const uint32_t valid = (1 << planes.fNumPlanes) - 1;
+    culled &= valid;
+    clear &= valid;
+#endif // HAVE_SSE2
+}
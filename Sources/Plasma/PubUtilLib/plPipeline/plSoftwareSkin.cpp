@@ -0,0 +1,134 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include "plSoftwareSkin.h"
+
+#include "hsParallel.h"
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#   include <arm_neon.h>
+#   define PL_SKIN_NEON
+#endif
+
+#include "plSoftwareSkin.inl"
+
+// Don't bother waking the workers for less than this many verts
+static constexpr uint32_t kMinParallelVerts = 2048;
+
+#ifdef PL_SKIN_NEON
+static inline float32x4_t ISkinDpNEON(const float* src, const float32x4_t& mc0,
+                                      const float32x4_t& mc1, const float32x4_t& mc2)
+{
+    float32x4_t msr = vld1q_f32(src);
+    float32x4_t res = vdupq_n_f32(0.f);
+    res = vsetq_lane_f32(vaddvq_f32(vmulq_f32(mc0, msr)), res, 0);
+    res = vsetq_lane_f32(vaddvq_f32(vmulq_f32(mc1, msr)), res, 1);
+    res = vsetq_lane_f32(vaddvq_f32(vmulq_f32(mc2, msr)), res, 2);
+    return res;
+}
+
+static inline void ISkinVertexNEON(const hsMatrix44& xfm, float wgt, const float* src, float* dst)
+{
+    float32x4_t mc0 = vld1q_f32(xfm.fMap[0]);
+    float32x4_t mc1 = vld1q_f32(xfm.fMap[1]);
+    float32x4_t mc2 = vld1q_f32(xfm.fMap[2]);
+
+    vst1q_f32(&dst[0], vmlaq_n_f32(vld1q_f32(&dst[0]), ISkinDpNEON(&src[0], mc0, mc1, mc2), wgt));
+    vst1q_f32(&dst[4], vmlaq_n_f32(vld1q_f32(&dst[4]), ISkinDpNEON(&src[4], mc0, mc1, mc2), wgt));
+}
+#else
+static inline void ISkinVertexFPU(const hsMatrix44& xfm, float wgt, const float* src, float* dst)
+{
+    const float (&m)[4][4] = xfm.fMap;
+
+    // position
+    dst[0] += (src[0] * m[0][0] + src[1] * m[0][1] + src[2] * m[0][2] + m[0][3]) * wgt;
+    dst[1] += (src[0] * m[1][0] + src[1] * m[1][1] + src[2] * m[1][2] + m[1][3]) * wgt;
+    dst[2] += (src[0] * m[2][0] + src[1] * m[2][1] + src[2] * m[2][2] + m[2][3]) * wgt;
+
+    // normal
+    dst[4] += (src[4] * m[0][0] + src[5] * m[0][1] + src[6] * m[0][2]) * wgt;
+    dst[5] += (src[4] * m[1][0] + src[5] * m[1][1] + src[6] * m[1][2]) * wgt;
+    dst[6] += (src[4] * m[2][0] + src[5] * m[2][1] + src[6] * m[2][2]) * wgt;
+}
+#endif // PL_SKIN_NEON
+
+// NEON is part of the baseline on 64-bit ARM, so it takes the fallback slot there
+void plSoftwareSkin::blend_verts_fpu(const Span& span)
+{
+#ifdef PL_SKIN_NEON
+    IBlendVerts<ISkinVertexNEON>(span);
+#else
+    IBlendVerts<ISkinVertexFPU>(span);
+#endif
+}
+
+void plSoftwareSkin::BlendSpans(const std::vector<Span>& spans)
+{
+    uint32_t totalVerts = 0;
+    for (const Span& span : spans)
+        totalVerts += span.fCount;
+
+    if (spans.size() < 2 || totalVerts < kMinParallelVerts) {
+        for (const Span& span : spans)
+            BlendVerts(span);
+        return;
+    }
+
+    hsParallelFor(spans.size(), 1, [&spans](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            BlendVerts(spans[i]);
+    });
+}
+
+// CPU-optimized functions requiring dispatch
+hsCpuFunctionDispatcher<plSoftwareSkin::blend_verts_ptr> plSoftwareSkin::blend_verts {
+    &plSoftwareSkin::blend_verts_fpu,
+    nullptr,                                    // SSE1
+    nullptr,                                    // SSE2
+    &plSoftwareSkin::blend_verts_sse3,
+    nullptr,                                    // SSSE3
+    nullptr,                                    // SSE41
+    nullptr,                                    // SSE42
+    nullptr,                                    // AVX
+    &plSoftwareSkin::blend_verts_avx2
+};
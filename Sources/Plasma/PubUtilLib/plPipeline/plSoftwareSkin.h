@@ -0,0 +1,95 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#ifndef plSoftwareSkin_inc
+#define plSoftwareSkin_inc
+
+#include <vector>
+
+#include "HeadSpin.h"
+#include "hsCpuID.h"
+#include "hsMatrix44.h"
+
+/**
+ * Backend-neutral software vertex blending, shared by every pipeline that
+ * skins on the CPU.
+ *
+ * Source verts are in plGBufferGroup's skinned layout (position, weights,
+ * optional packed indices, normal, colors, UVWs).  Blended verts are written
+ * to the destination in the same layout minus the weights and indices.
+ */
+class plSoftwareSkin
+{
+public:
+    struct Span
+    {
+        /** Used in place of palette entry 0, which is the span's own transform. */
+        hsMatrix44          fLocalToWorld;
+        const hsMatrix44*   fPalette;
+        const uint8_t*      fSrc;
+        uint8_t*            fDest;
+        uint32_t            fCount;
+        uint8_t             fFormat;
+    };
+
+    /** Blends a single span on the calling thread. */
+    static void BlendVerts(const Span& span) { blend_verts.call(span); }
+
+    /**
+     * Blends a whole batch of spans, spread across the hsParallelFor workers
+     * once there's enough work to be worth it.  Spans must not overlap in
+     * their destinations.
+     */
+    static void BlendSpans(const std::vector<Span>& spans);
+
+    //  CPU-optimized kernels, public so benchmarks can compare them directly
+    typedef void(*blend_verts_ptr)(const Span& span);
+
+    static void blend_verts_fpu(const Span& span);
+    static void blend_verts_sse3(const Span& span);
+    static void blend_verts_avx2(const Span& span);
+
+private:
+    static hsCpuFunctionDispatcher<blend_verts_ptr> blend_verts;
+};
+
+#endif // plSoftwareSkin_inc
@@ -0,0 +1,109 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+// Vertex loop shared by the plSoftwareSkin kernels.  Each kernel file defines
+// its per-influence transform and instantiates IBlendVerts with it.
+
+#include <cstring>
+
+#include "plDrawable/plGBufferGroup.h"
+
+// Position in [0..3] with w = 1, normal in [4..7] with w = 0
+typedef void(*skin_vert_ptr)(const hsMatrix44& xfm, float wgt, const float* src, float* dst);
+
+template<skin_vert_ptr T>
+static void IBlendVerts(const plSoftwareSkin::Span& span)
+{
+    alignas(32) float srcBuf[8] { 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f };
+    float weights[4];
+
+    const size_t uvChanSize = plGBufferGroup::CalcNumUVs(span.fFormat) * sizeof(float) * 3;
+    const size_t tailSize = sizeof(uint32_t) * 2 + uvChanSize;
+    const uint8_t numWeights = (span.fFormat & plGBufferGroup::kSkinWeightMask) >> 4;
+    const bool hasIndices = (span.fFormat & plGBufferGroup::kSkinIndices) != 0;
+
+    const uint8_t* src = span.fSrc;
+    uint8_t* dest = span.fDest;
+    for (uint32_t i = 0; i < span.fCount; ++i) {
+        // Extract data
+        memcpy(&srcBuf[0], src, sizeof(float) * 3);
+        src += sizeof(float) * 3;
+
+        float weightSum = 0.f;
+        for (uint8_t j = 0; j < numWeights; ++j) {
+            memcpy(&weights[j], src, sizeof(float));
+            src += sizeof(float);
+            weightSum += weights[j];
+        }
+        weights[numWeights] = 1.f - weightSum;
+
+        uint32_t indices = 1 << 8;
+        if (hasIndices) {
+            memcpy(&indices, src, sizeof(uint32_t));
+            src += sizeof(uint32_t);
+        }
+
+        memcpy(&srcBuf[4], src, sizeof(float) * 3);
+        src += sizeof(float) * 3;
+
+        // Blend
+        alignas(32) float destBuf[8] {};
+        for (uint32_t j = 0; j < numWeights + 1u; ++j) {
+            if (weights[j]) {
+                uint32_t idx = indices & 0xFF;
+                T(idx ? span.fPalette[idx] : span.fLocalToWorld, weights[j], srcBuf, destBuf);
+            }
+            indices >>= 8;
+        }
+        // Probably don't really need to renormalize the normal. The errors
+        // are going to be subtle and "smooth".
+
+        // Slam data into position now, then copy the colors and UVs
+        memcpy(dest, &destBuf[0], sizeof(float) * 3);
+        memcpy(dest + sizeof(float) * 3, &destBuf[4], sizeof(float) * 3);
+        dest += sizeof(float) * 6;
+
+        memcpy(dest, src, tailSize);
+        src += tailSize;
+        dest += tailSize;
+    }
+}
@@ -0,0 +1,79 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include "plSoftwareSkin.h"
+
+#include "hsSIMD.h"
+
+#include "plSoftwareSkin.inl"
+
+#ifdef HAVE_AVX2
+// Transforms the position and normal together, one per 128-bit lane
+static inline void ISkinVertexAVX2(const hsMatrix44& xfm, float wgt, const float* src, float* dst)
+{
+    __m256 mc0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(xfm.fMap[0]));
+    __m256 mc1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(xfm.fMap[1]));
+    __m256 mc2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(xfm.fMap[2]));
+
+    __m256 msr = _mm256_load_ps(src);
+    __m256 _x  = _mm256_mul_ps(mc0, msr);
+    __m256 _y  = _mm256_mul_ps(mc1, msr);
+    __m256 _z  = _mm256_mul_ps(mc2, msr);
+
+    __m256 hbuf1 = _mm256_hadd_ps(_x, _y);
+    __m256 hbuf2 = _mm256_hadd_ps(_z, _z);
+    hbuf1 = _mm256_hadd_ps(hbuf1, hbuf2);
+
+    __m256 _dst = _mm256_load_ps(dst);
+    _dst = _mm256_add_ps(_dst, _mm256_mul_ps(hbuf1, _mm256_set1_ps(wgt)));
+    _mm256_store_ps(dst, _dst);
+}
+#endif // HAVE_AVX2
+
+void plSoftwareSkin::blend_verts_avx2(const Span& span)
+{
+#ifdef HAVE_AVX2
+    IBlendVerts<ISkinVertexAVX2>(span);
+#else
+    blend_verts_fpu(span);
+#endif
+}
@@ -65,15 +65,71 @@ plRegistryKeyList::~plRegistryKeyList()
     }
 }
 
+static inline uint32_t IHashName(const ST::string& name)
+{
+    return (uint32_t)ST::hash_i()(name);
+}
+
+void plRegistryKeyList::IIndexName(uint32_t slot)
+{
+    // Keep the table at most half full so probe sequences stay short
+    if ((fNameIndexCount + 1) * 2 > fNameIndex.size())
+    {
+        IRebuildNameIndex();
+        return;
+    }
+
+    plKeyImp* key = fKeys[slot];
+    uint32_t hash = IHashName(key->GetName());
+    size_t mask = fNameIndex.size() - 1;
+    size_t i = hash & mask;
+    while (fNameIndex[i].fSlot != 0)
+        i = (i + 1) & mask;
+
+    fNameIndex[i].fHash = hash;
+    fNameIndex[i].fSlot = slot + 1;
+    ++fNameIndexCount;
+}
+
+void plRegistryKeyList::IRebuildNameIndex()
+{
+    size_t numKeys = std::count_if(fKeys.begin(), fKeys.end(), [](plKeyImp* key) { return key != nullptr; });
+    size_t size = 16;
+    while (size < numKeys * 2 + 2)
+        size <<= 1;
+
+    fNameIndex.assign(size, NameIndexEntry{ 0, 0 });
+    fNameIndexCount = 0;
+
+    // Insert in list order, so the first key with a given name is also the
+    // first one found when probing
+    for (uint32_t slot = 0; slot < fKeys.size(); ++slot)
+    {
+        if (fKeys[slot])
+            IIndexName(slot);
+    }
+}
+
 plKeyImp* plRegistryKeyList::FindKey(const ST::string& keyName) const
 {
-    auto it = std::find_if(fKeys.begin(), fKeys.end(),
-        [&] (plKeyImp* key) { return key && key->GetName().compare_i(keyName) == 0; }
-    );
-    if (it != fKeys.end())
-        return *it;
-    else
+    if (fNameIndex.empty())
         return nullptr;
+
+    uint32_t hash = IHashName(keyName);
+    size_t mask = fNameIndex.size() - 1;
+    for (size_t i = hash & mask; fNameIndex[i].fSlot != 0; i = (i + 1) & mask)
+    {
+        if (fNameIndex[i].fHash != hash)
+            continue;
+
+        // Slots can be reused by AddKey, so make sure this is still the key
+        // that was indexed under this name
+        plKeyImp* key = fKeys[fNameIndex[i].fSlot - 1];
+        if (key && key->GetName().compare_i(keyName) == 0)
+            return key;
+    }
+
+    return nullptr;
 }
 
 plKeyImp* plRegistryKeyList::FindKey(const plUoid& uoid) const
@@ -158,6 +214,7 @@ void plRegistryKeyList::AddKey(plKeyImp* key, LoadStatus& loadStatusChange)
                 fKeys.resize(id);
             fKeys[id - 1] = key;
         }
+        IIndexName(key->GetUoid().GetObjectID() - 1);
         ++fReffedKeys;
     }
 }
@@ -238,6 +295,7 @@ void plRegistryKeyList::Read(hsStream* s)
         fKeys[id - 1] = newKey;
     }
     fKeys.shrink_to_fit();
+    IRebuildNameIndex();
 }
 
 void plRegistryKeyList::Write(hsStream* s)
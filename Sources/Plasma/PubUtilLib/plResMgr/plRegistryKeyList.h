@@ -65,9 +65,23 @@ protected:
 
     std::vector<plKeyImp*> fKeys;
 
-    plRegistryKeyList() {}
+    // Open addressed hash table of indices into fKeys, keyed by the
+    // case-insensitive key name, so FindKey by name doesn't have to walk
+    // every key.  A slot of zero means the entry is empty; otherwise it's
+    // the index into fKeys plus one.
+    struct NameIndexEntry
+    {
+        uint32_t fHash;
+        uint32_t fSlot;
+    };
+    std::vector<NameIndexEntry> fNameIndex;
+    uint32_t fNameIndexCount;
+
+    plRegistryKeyList() : fNameIndexCount() {}
 
     void IRepack();
+    void IIndexName(uint32_t slot);
+    void IRebuildNameIndex();
     void ILock() { ++fLocked; }
     void IUnlock() { --fLocked; }
 
@@ -80,7 +94,7 @@ public:
     };
 
     plRegistryKeyList(uint16_t classType)
-        : fClassType(classType), fReffedKeys(0), fLocked(0)
+        : fClassType(classType), fReffedKeys(0), fLocked(0), fNameIndexCount(0)
     { }
     ~plRegistryKeyList();
 
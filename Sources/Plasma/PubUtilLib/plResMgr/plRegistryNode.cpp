@@ -46,11 +46,13 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "hsStream.h"
 #include "plRegistryHelpers.h"
 #include "plRegistryKeyList.h"
+#include "plResMgrSettings.h"
 #include "plVersion.h"
 
 #include "pnKeyedObject/plKeyImp.h"
 
 plRegistryPageNode::plRegistryPageNode()
+    : fPageData()
 {}
 
 plRegistryPageNode::plRegistryPageNode(const plFileName& path)
@@ -58,6 +60,7 @@ plRegistryPageNode::plRegistryPageNode(const plFileName& path)
     , fPath(path)
     , fLoadedTypes(0)
     , fStream(nullptr)
+    , fPageData()
     , fOpenRequests(0)
     , fIsNewPage(false)
 {
@@ -76,6 +79,7 @@ plRegistryPageNode::plRegistryPageNode(const plLocation& location, const ST::str
     , fPageInfo(location)
     , fLoadedTypes(0)
     , fStream(nullptr)
+    , fPageData()
     , fOpenRequests(0)
     , fIsNewPage(true)
 {
@@ -132,11 +136,23 @@ hsStream* plRegistryPageNode::OpenStream()
     if (fOpenRequests == 0)
     {
         hsAssert(fStream == nullptr, "plRegistryPageNode::fStream should be nullptr when not open!");
-        auto stream = std::make_unique<hsBufferedStream>();
-        if (!stream->Open(fPath, "rb")) {
-            return nullptr;
+        if (!fPreloadedData.empty()) {
+            fPageData = fPreloadedData.data();
+            fStream = std::make_unique<hsReadOnlyStream>(fPreloadedData.size(), fPageData);
+        } else if (plResMgrSettings::Get().GetMemoryMapPages()) {
+            auto stream = std::make_unique<hsMappedStream>();
+            if (!stream->Open(fPath)) {
+                return nullptr;
+            }
+            fPageData = stream->GetData();
+            fStream = std::move(stream);
+        } else {
+            auto stream = std::make_unique<hsBufferedStream>();
+            if (!stream->Open(fPath, "rb")) {
+                return nullptr;
+            }
+            fStream = std::move(stream);
         }
-        fStream = std::move(stream);
     }
     fOpenRequests++;
     return fStream.get();
@@ -148,10 +164,18 @@ void plRegistryPageNode::CloseStream()
         fOpenRequests--;
 
     if (fOpenRequests == 0) {
+        fPageData = nullptr;
         fStream.reset();
+        fPreloadedData = {};
     }
 }
 
+void plRegistryPageNode::SetPreloadedData(std::vector<uint8_t> data)
+{
+    if (fOpenRequests == 0)
+        fPreloadedData = std::move(data);
+}
+
 void plRegistryPageNode::LoadKeys()
 {
     hsAssert(IsValid(), "Trying to load keys for invalid page");
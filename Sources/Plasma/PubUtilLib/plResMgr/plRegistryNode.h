@@ -48,6 +48,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 #include <map>
 #include <memory>
+#include <vector>
 
 class hsStream;
 class plRegistryKeyList;
@@ -81,6 +82,8 @@ protected:
     plPageInfo  fPageInfo;      // Info about this page
 
     std::unique_ptr<hsStream> fStream; // Stream for reading/writing our page
+    const uint8_t* fPageData;          // Contents of the page, if fStream is in memory
+    std::vector<uint8_t> fPreloadedData; // Page contents read ahead by the page preloader
     uint8_t fOpenRequests;        // How many handles there are to fStream (or
                                 // zero if it's closed)
     bool fIsNewPage;          // True if this page is new (not read off disk)
@@ -139,6 +142,16 @@ public:
     hsStream*   OpenStream();
     void        CloseStream();
 
+    // If the page is currently open and held in memory (memory mapped or
+    // preloaded), returns a pointer to the start of the page data so objects
+    // can be read without seeking fStream.
+    const uint8_t* GetPageData() const { return fPageData; }
+
+    // Hands the node the entire contents of its page file, read ahead of time.
+    // The next OpenStream will read from it, and it is released when that
+    // stream is closed.  Ignored if the stream is already open.
+    void SetPreloadedData(std::vector<uint8_t> data);
+
     // Export time only.  Before we write to disk, assign all the loaded keys
     // sequential object IDs that they can use to do fast lookups at load time.
     void PrepForWrite();
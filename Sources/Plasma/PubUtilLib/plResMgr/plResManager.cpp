@@ -45,6 +45,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "plRegistryNode.h"
 #include "plResManagerHelper.h"
 #include "plResMgrSettings.h"
+#include "plResPagePreloader.h"
 
 #include "hsStream.h"
 #include "hsTimer.h"
@@ -103,6 +104,7 @@ plResManager::plResManager():
     fCloningCounter(),
     fProgressProc(),
     fMyHelper(),
+    fPagePreloader(),
     fLogReadTimes(),
     fPageListLock(),
     fPagesNeedCleanup(),
@@ -196,6 +198,14 @@ void plResManager::IShutdown()
 
     IPageOutSceneNodes(false);
 
+    // Stop reading ahead; nobody is going to claim any of it now
+    if (fPagePreloader)
+    {
+        fPagePreloader->Shutdown();
+        delete fPagePreloader;
+        fPagePreloader = nullptr;
+    }
+
     // Shut down our helper
     fMyHelper->Shutdown();  // This will call UnregisterAs(), which will delete itself
     fMyHelper = nullptr;
@@ -330,8 +340,9 @@ bool plResManager::ReadObject(plKeyImp* key)
         kResMgrLog(3, ILog(3, "   ...Data stream failed to open on read!"));
         return false;
     }
+    pageNode->OpenStream();
     fReadingObject = true;
-    bool ret = IReadObject(key, pageNode->OpenStream());
+    bool ret = IReadObject(key, pageNode);
     fReadingObject = false;
 
     if (!fQueuedReads.empty())
@@ -355,7 +366,7 @@ bool plResManager::ReadObject(plKeyImp* key)
     return ret;
 }
 
-bool plResManager::IReadObject(plKeyImp* pKey, hsStream *stream)
+bool plResManager::IReadObject(plKeyImp* pKey, plRegistryPageNode* pageNode)
 {
     static uint64_t totalTime = 0;
 
@@ -417,10 +428,38 @@ bool plResManager::IReadObject(plKeyImp* pKey, hsStream *stream)
     // If we couldn't share the object, read in a fresh copy
     if (!ko)
     {
-        stream->SetPosition(pKey->GetStartPos());
-        kResMgrLog(4, ILog(4, "   ...Reading from position {} bytes...", pKey->GetStartPos()));
+        plCreatable* cre = nullptr;
+        hsStream* stream = pageNode->OpenStream();
+        if (stream == nullptr)
+        {
+            kResMgrLog(3, ILog(3, "   ...Data stream failed to open on read!"));
+        }
+        else if (const uint8_t* pageData = pageNode->GetPageData())
+        {
+            kResMgrLog(4, ILog(4, "   ...Reading from in-memory position {} bytes...", pKey->GetStartPos()));
+
+            // The page is in memory, so just point a stream at the object's own
+            // data.  This keeps the object from reading into its neighbors and
+            // doesn't disturb the position of the shared page stream.
+            if (uint64_t(pKey->GetStartPos()) + pKey->GetDataLen() <= stream->GetEOF())
+            {
+                hsReadOnlyStream objStream(pKey->GetDataLen(), pageData + pKey->GetStartPos());
+                cre = ReadCreatable(&objStream);
+            }
+            else
+            {
+                kResMgrLog(3, ILog(3, "   ...ERROR: Object data runs past the end of the page!"));
+            }
+        }
+        else
+        {
+            stream->SetPosition(pKey->GetStartPos());
+            kResMgrLog(4, ILog(4, "   ...Reading from position {} bytes...", pKey->GetStartPos()));
+
+            cre = ReadCreatable(stream);
+        }
+        pageNode->CloseStream();
 
-        plCreatable* cre = ReadCreatable(stream);
         hsAssert(cre, "Could not Create Object");
         if (cre)
         {   
@@ -1150,6 +1189,7 @@ void plResManager::PageInRoom(const plLocation& page, uint16_t objClassToRef, pl
     {
         kResMgrLog(1, ILog(1, "...Page not found!"));
         hsAssert(false, "Invalid location given to PageInRoom()");
+        CancelPreload(page);
         return;
     }
 
@@ -1172,10 +1212,23 @@ void plResManager::PageInRoom(const plLocation& page, uint16_t objClassToRef, pl
             pageNode->GetPageInfo().GetAge(), pageNode->GetPageInfo().GetPage(), condStr);
         hsMessageBox(msg, ST_LITERAL("Error"), hsMessageBoxNormal, hsMessageBoxIconError);
 
+        CancelPreload(page);
         hsRefCnt_SafeUnRef(refMsg);
         return;
     }
 
+    // Step 0.8: If the page was read ahead of time, hand the data over so we
+    // don't have to go to the disk for it
+    if (fPagePreloader)
+    {
+        std::vector<uint8_t> pageData;
+        if (fPagePreloader->ClaimPage(page, pageData))
+        {
+            kResMgrLog(2, ILog(2, "...Using {} bytes of preloaded page data...", pageData.size()));
+            pageNode->SetPreloadedData(std::move(pageData));
+        }
+    }
+
     // Step 0.9: Open the stream on this page, so it remains open for the entire loading process
     pageNode->OpenStream();
 
@@ -1232,6 +1285,36 @@ void plResManager::PageInRoom(const plLocation& page, uint16_t objClassToRef, pl
     }
 }
 
+//// PreloadPage /////////////////////////////////////////////////////////////
+//  Only the raw page data is read on the preloader thread. Keys and objects
+//  still get created on the main thread by PageInRoom, since the registry
+//  isn't safe to touch from anywhere else.
+
+void plResManager::PreloadPage(const plLocation& page)
+{
+    if (!plResMgrSettings::Get().GetPreloadPages())
+        return;
+
+    plRegistryPageNode* pageNode = FindPage(page);
+    if (pageNode == nullptr || !pageNode->IsValid() || pageNode->IsNewPage())
+        return;
+
+    if (fPagePreloader == nullptr)
+    {
+        fPagePreloader = new plResPagePreloader;
+        fPagePreloader->Init();
+    }
+
+    kResMgrLog(2, ILog(2, "Preloading page {}>{}", pageNode->GetPageInfo().GetAge(), pageNode->GetPageInfo().GetPage()));
+    fPagePreloader->QueuePage(page, pageNode->GetPagePath());
+}
+
+void plResManager::CancelPreload(const plLocation& page)
+{
+    if (fPagePreloader)
+        fPagePreloader->CancelPage(page);
+}
+
 class plPageInAgeIter : public plRegistryPageIterator
 {
 private:
@@ -54,6 +54,7 @@ class plRegistryPageIterator;
 class plRegistryDataStream;
 class plResAgeHolder;
 class plResManagerHelper;
+class plResPagePreloader;
 class plDispatch;
 
 // plProgressProc is a proc called every time an object loads, to keep a progress bar for
@@ -136,6 +137,12 @@ public:
     void LoadAgeKeys(const ST::string& age);
     void DropAgeKeys(const ST::string& age);
     void PageInRoom(const plLocation& page, uint16_t objClassToRef, plRefMsg* refMsg);
+    // Starts reading a page's data into memory on a background thread, so a
+    // later PageInRoom on it only has to deserialize the objects.
+    void PreloadPage(const plLocation& page);
+    // Drops a page queued with PreloadPage that isn't going to be paged in
+    // after all, so its data doesn't sit around forever.
+    void CancelPreload(const plLocation& page);
     void PageInAge(const ST::string& age);
 
     // Usually, a page file is kept open during load because the first keyed object
@@ -176,7 +183,7 @@ protected:
 
     plKey   ReRegister(const ST::string& nm, const plUoid& uoid) override;
     bool    ReadObject(plKeyImp* key) override; // plKeys call this when needed
-    virtual bool    IReadObject(plKeyImp* pKey, hsStream *stream);  
+    virtual bool    IReadObject(plKeyImp* pKey, plRegistryPageNode* pageNode);
 
     plCreatable*    IReadCreatable(hsStream* s) const;
     plKey           ICloneKey(const plUoid& objUoid, uint32_t playerID, uint32_t cloneID);
@@ -227,6 +234,7 @@ protected:
     plProgressProc  fProgressProc;
 
     plResManagerHelper  *fMyHelper;
+    plResPagePreloader  *fPagePreloader;
 
     bool    fLogReadTimes;
 
@@ -67,6 +67,8 @@ protected:
 
     bool fPassiveKeyRead;
     bool fLoadPagesOnInit;
+    bool fMemoryMapPages;
+    bool fPreloadPages;
 
     plResMgrSettings()
     {
@@ -74,6 +76,8 @@ protected:
         fFilterNewerPageVersions = true;
         fPassiveKeyRead = false;
         fLoadPagesOnInit = true;
+        fMemoryMapPages = false;
+        fPreloadPages = true;
         fLoggingLevel = 0;
     }
 
@@ -102,6 +106,16 @@ public:
     bool GetLoadPagesOnInit() const { return fLoadPagesOnInit; }
     void SetLoadPagesOnInit(bool load) { fLoadPagesOnInit = load; }
 
+    // If set, page files are mapped into memory instead of being read through
+    // a buffered file stream.  Only affects pages opened after the change.
+    bool GetMemoryMapPages() const { return fMemoryMapPages; }
+    void SetMemoryMapPages(bool map) { fMemoryMapPages = map; }
+
+    // If set, plResManager::PreloadPage reads queued pages into memory on a
+    // background thread so PageInRoom doesn't have to wait on the disk.
+    bool GetPreloadPages() const { return fPreloadPages; }
+    void SetPreloadPages(bool preload) { fPreloadPages = preload; }
+
     static plResMgrSettings& Get();
 };
 
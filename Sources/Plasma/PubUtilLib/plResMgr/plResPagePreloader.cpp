@@ -0,0 +1,154 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include "plResPagePreloader.h"
+
+#include "hsStream.h"
+
+#include <algorithm>
+
+void plResPagePreloader::Init()
+{
+    fRunning = true;
+    Start();
+}
+
+void plResPagePreloader::Shutdown()
+{
+    {
+        hsLockGuard(fMutex);
+        fRunning = false;
+    }
+    fCondition.notify_all();
+    Stop();
+
+    // The worker is gone, so nothing can be holding on to a request now
+    fRequests.clear();
+    fBytesHeld = 0;
+}
+
+std::list<plResPagePreloader::Request>::iterator plResPagePreloader::IFind(const plLocation& loc)
+{
+    return std::find_if(fRequests.begin(), fRequests.end(),
+                        [&loc](const Request& req) { return req.fLocation == loc; });
+}
+
+void plResPagePreloader::QueuePage(const plLocation& loc, const plFileName& path)
+{
+    {
+        hsLockGuard(fMutex);
+        if (IFind(loc) != fRequests.end())
+            return;
+        fRequests.emplace_back(loc, path);
+    }
+    fCondition.notify_all();
+}
+
+bool plResPagePreloader::ClaimPage(const plLocation& loc, std::vector<uint8_t>& data)
+{
+    std::unique_lock<std::mutex> lock(fMutex);
+    auto it = IFind(loc);
+    if (it == fRequests.end())
+        return false;
+
+    // Requests are never removed while they're being read, so the iterator
+    // is still good after we wake up.
+    fCondition.wait(lock, [it]() { return it->fState != kReading; });
+
+    bool claimed = false;
+    if (it->fState == kDone)
+    {
+        fBytesHeld -= it->fData.size();
+        data = std::move(it->fData);
+        claimed = !data.empty();
+    }
+    fRequests.erase(it);
+    lock.unlock();
+
+    // We may have freed up room for the worker to read ahead again
+    fCondition.notify_all();
+    return claimed;
+}
+
+void plResPagePreloader::CancelPage(const plLocation& loc)
+{
+    std::vector<uint8_t> data;
+    ClaimPage(loc, data);
+}
+
+void plResPagePreloader::Run()
+{
+    SetThisThreadName(ST_LITERAL("PagePreloader"));
+
+    std::unique_lock<std::mutex> lock(fMutex);
+    while (fRunning)
+    {
+        auto it = std::find_if(fRequests.begin(), fRequests.end(),
+                               [](const Request& req) { return req.fState == kPending; });
+        if (it == fRequests.end() || fBytesHeld >= kMaxBytesHeld)
+        {
+            fCondition.wait(lock);
+            continue;
+        }
+
+        it->fState = kReading;
+        plFileName path = it->fPath;
+
+        std::vector<uint8_t> data;
+        {
+            hsUnlockGuard(lock);
+
+            hsUNIXStream stream;
+            if (stream.Open(path, "rb"))
+            {
+                data.resize(stream.GetEOF());
+                if (stream.Read(data.size(), data.data()) != data.size())
+                    data.clear();
+            }
+        }
+
+        fBytesHeld += data.size();
+        it->fData = std::move(data);
+        it->fState = kDone;
+        fCondition.notify_all();
+    }
+}
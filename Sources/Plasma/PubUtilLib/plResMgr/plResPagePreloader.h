@@ -0,0 +1,122 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+//////////////////////////////////////////////////////////////////////////////
+//
+//  plResPagePreloader - Background thread that reads page files into memory
+//                       ahead of plResManager::PageInRoom, so the main
+//                       thread only has to deserialize the objects.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _plResPagePreloader_h
+#define _plResPagePreloader_h
+
+#include "HeadSpin.h"
+#include "hsThread.h"
+#include "plFileSystem.h"
+
+#include "pnKeyedObject/plUoid.h"
+
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <vector>
+
+class plResPagePreloader : public hsThread
+{
+protected:
+    enum RequestState
+    {
+        kPending,
+        kReading,
+        kDone,
+    };
+
+    struct Request
+    {
+        plLocation              fLocation;
+        plFileName              fPath;
+        RequestState            fState;
+        std::vector<uint8_t>    fData;
+
+        Request(const plLocation& loc, plFileName path)
+            : fLocation(loc), fPath(std::move(path)), fState(kPending)
+        { }
+    };
+
+    std::list<Request>      fRequests;
+    std::mutex              fMutex;
+    std::condition_variable fCondition;     // Signaled when work is queued or a read completes
+    bool                    fRunning;
+
+    // Total bytes held by completed requests that haven't been claimed yet
+    size_t                  fBytesHeld;
+
+    std::list<Request>::iterator IFind(const plLocation& loc);
+
+public:
+    // Don't read ahead any more pages once this much data is waiting to be claimed
+    enum { kMaxBytesHeld = 256 * 1024 * 1024 };
+
+    plResPagePreloader() : fRunning(false), fBytesHeld() { }
+
+    void Run() override;
+
+    void Init();
+    void Shutdown();
+    bool IsRunning() const { return fRunning; }
+
+    // Queue up a page to be read into memory. Requests for pages that are
+    // already queued are ignored.
+    void QueuePage(const plLocation& loc, const plFileName& path);
+
+    // Take the contents of a preloaded page. If the page is currently being
+    // read, this will block until the read completes. If the read hasn't
+    // started yet, the request is dropped and false is returned so the caller
+    // can just read the page itself.
+    bool ClaimPage(const plLocation& loc, std::vector<uint8_t>& data);
+
+    // Forget about a page, whether or not it was read
+    void CancelPage(const plLocation& loc);
+};
+
+#endif // _plResPagePreloader_h
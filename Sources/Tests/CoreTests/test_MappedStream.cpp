@@ -0,0 +1,91 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include <gtest/gtest.h>
+#include <string_view>
+
+#include "hsStream.h"
+
+static const plFileName kMappedTestFile = "test_MappedStream.dat";
+
+TEST(hsMappedStream, readMappedFile)
+{
+    constexpr std::string_view str = "hsMappedStream readMappedFile";
+    {
+        hsUNIXStream out;
+        ASSERT_TRUE(out.Open(kMappedTestFile, "wb"));
+        out.WriteLE32(0xDEADBEEF);
+        out.WriteSafeString(str);
+        out.WriteLE16(42);
+    }
+
+    {
+        hsMappedStream s;
+        ASSERT_TRUE(s.Open(kMappedTestFile));
+        ASSERT_NE(s.GetData(), nullptr);
+        EXPECT_EQ(s.GetEOF(), 4 + str.size() + 2 + 2);
+
+        EXPECT_EQ(s.ReadLE32(), 0xDEADBEEF);
+        EXPECT_EQ(s.ReadSafeString(), str);
+        EXPECT_EQ(s.ReadLE16(), 42);
+        EXPECT_TRUE(s.AtEnd());
+
+        // Seeking is just pointer arithmetic, and the data pointer can be
+        // used to look at the file directly.
+        s.SetPosition(4);
+        EXPECT_EQ(s.GetPosition(), 4);
+        EXPECT_EQ(s.ReadSafeString(), str);
+        EXPECT_EQ(s.GetData()[0], 0xEF);
+
+        s.Close();
+        EXPECT_EQ(s.GetData(), nullptr);
+    }
+
+    plFileSystem::Unlink(kMappedTestFile);
+}
+
+TEST(hsMappedStream, missingFile)
+{
+    hsMappedStream s;
+    EXPECT_FALSE(s.Open("test_MappedStream.missing"));
+    EXPECT_EQ(s.GetData(), nullptr);
+}
@@ -0,0 +1,88 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <numeric>
+#include <vector>
+
+#include "hsParallel.h"
+
+TEST(hsParallel, covers_every_index_once)
+{
+    std::vector<int> hits(10007, 0);
+    hsParallelFor(hits.size(), 16, [&hits](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            hits[i]++;
+    });
+
+    for (int h : hits)
+        EXPECT_EQ(h, 1);
+}
+
+TEST(hsParallel, small_job_runs_inline)
+{
+    size_t calls = 0;
+    hsParallelFor(8, 64, [&calls](size_t begin, size_t end) {
+        EXPECT_EQ(begin, 0);
+        EXPECT_EQ(end, 8);
+        calls++;
+    });
+    EXPECT_EQ(calls, 1);
+
+    hsParallelFor(0, 1, [&calls](size_t, size_t) { calls++; });
+    EXPECT_EQ(calls, 1);
+}
+
+TEST(hsParallel, nested)
+{
+    std::atomic<size_t> total = 0;
+    hsParallelFor(32, 1, [&total](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            hsParallelFor(100, 10, [&total](size_t b, size_t e) {
+                total += e - b;
+            });
+        }
+    });
+    EXPECT_EQ(total, 3200);
+}
@@ -0,0 +1,105 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include <cstring>
+#include <gtest/gtest.h>
+#include <numeric>
+#include <vector>
+
+#include "pnEncryption/plRC4.h"
+
+static std::vector<uint8_t> Process(const char* key, const char* text)
+{
+    std::vector<uint8_t> buffer(text, text + strlen(text));
+    plRC4 rc4(key, strlen(key));
+    rc4.Process(buffer.data(), buffer.size());
+    return buffer;
+}
+
+TEST(plRC4, well_known_vectors)
+{
+    EXPECT_EQ(Process("Key", "Plaintext"),
+              std::vector<uint8_t>({ 0xBB, 0xF3, 0x16, 0xE8, 0xD9, 0x40, 0xAF, 0x0A, 0xD3 }));
+    EXPECT_EQ(Process("Wiki", "pedia"),
+              std::vector<uint8_t>({ 0x10, 0x21, 0xBF, 0x04, 0x20 }));
+    EXPECT_EQ(Process("Secret", "Attack at dawn"),
+              std::vector<uint8_t>({ 0x45, 0xA0, 0x1F, 0x64, 0x5F, 0xC3, 0x5B, 0x38,
+                                     0x35, 0x52, 0x54, 0x4B, 0x9B, 0xF5 }));
+}
+
+TEST(plRC4, chunked_matches_whole)
+{
+    // Odd chunk sizes cross both the SIMD widths and the keystream block size
+    std::vector<uint8_t> plain(3 * plRC4::kKeystreamBytes + 123);
+    std::iota(plain.begin(), plain.end(), uint8_t(0));
+
+    std::vector<uint8_t> whole = plain;
+    plRC4 wholeKey("0123456789abcdef", 16);
+    wholeKey.Process(whole.data(), whole.size());
+
+    std::vector<uint8_t> chunked = plain;
+    plRC4 chunkedKey("0123456789abcdef", 16);
+    size_t pos = 0;
+    for (size_t chunk = 1; pos < chunked.size(); chunk = (chunk * 7) % 1021 + 1) {
+        size_t count = std::min(chunk, chunked.size() - pos);
+        chunkedKey.Process(chunked.data() + pos, count);
+        pos += count;
+    }
+
+    EXPECT_EQ(whole, chunked);
+    EXPECT_NE(whole, plain);
+}
+
+TEST(plRC4, round_trip)
+{
+    std::vector<uint8_t> plain(10000);
+    std::iota(plain.begin(), plain.end(), uint8_t(7));
+
+    std::vector<uint8_t> buffer = plain;
+    plRC4 encrypt("Plasma", 6);
+    encrypt.Process(buffer.data(), buffer.size());
+
+    plRC4 decrypt("Plasma", 6);
+    decrypt.Process(buffer.data(), buffer.size());
+
+    EXPECT_EQ(plain, buffer);
+}
@@ -0,0 +1,176 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011 Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "plAudioCore/plAudioCore.h"
+#include "plAudioCore/plCachedFileReader.h"
+
+static plWAVHeader MakeHeader(uint16_t numChannels, uint16_t bitsPerSample = 16)
+{
+    plWAVHeader header{};
+    header.fFormatTag = plWAVHeader::kPCMFormatTag;
+    header.fNumChannels = numChannels;
+    header.fNumSamplesPerSec = 22050;
+    header.fBitsPerSample = bitsPerSample;
+    header.fBlockAlign = numChannels * bitsPerSample / 8;
+    header.fAvgBytesPerSec = header.fNumSamplesPerSec * header.fBlockAlign;
+    return header;
+}
+
+// Encodes and decodes one block, checks it comes back bit-exact, and returns
+// how it was stored
+static uint8_t RoundTrip(const std::vector<uint8_t>& pcm, const plWAVHeader& header)
+{
+    std::vector<uint8_t> encoded;
+    plCachedFileReader::EncodeBlock(pcm.data(), uint32_t(pcm.size()), header, encoded);
+    EXPECT_FALSE(encoded.empty());
+    if (encoded.empty())
+        return 0xFF;
+
+    std::vector<uint8_t> decoded(pcm.size(), 0xCD);
+    EXPECT_TRUE(plCachedFileReader::DecodeBlock(encoded.data(), uint32_t(encoded.size()), header,
+                                                decoded.data(), uint32_t(decoded.size())));
+    EXPECT_EQ(0, memcmp(pcm.data(), decoded.data(), pcm.size()));
+    return encoded[0];
+}
+
+static std::vector<uint8_t> ToPCM(const std::vector<int16_t>& samples)
+{
+    std::vector<uint8_t> pcm(samples.size() * sizeof(int16_t));
+    memcpy(pcm.data(), samples.data(), pcm.size());
+    return pcm;
+}
+
+static int16_t Tone(size_t i, double period, double amplitude)
+{
+    return int16_t(std::lround(amplitude * std::sin(i * 6.283185307179586 / period)));
+}
+
+TEST(plCachedFileReader, RoundTripMono)
+{
+    std::vector<int16_t> samples(16384);
+    for (size_t i = 0; i < samples.size(); ++i)
+        samples[i] = Tone(i, 100.0, 8000.0);
+
+    EXPECT_EQ(plCachedFileReader::kBlockRice, RoundTrip(ToPCM(samples), MakeHeader(1)));
+}
+
+TEST(plCachedFileReader, RoundTripStereo)
+{
+    // Different content per channel, so a channel mixup can't round-trip
+    std::vector<int16_t> samples(2 * 8192);
+    for (size_t i = 0; i < samples.size() / 2; ++i) {
+        samples[2 * i] = Tone(i, 100.0, 8000.0);
+        samples[2 * i + 1] = Tone(i, 37.0, -3000.0);
+    }
+
+    EXPECT_EQ(plCachedFileReader::kBlockRice, RoundTrip(ToPCM(samples), MakeHeader(2)));
+}
+
+TEST(plCachedFileReader, RoundTripFullScale)
+{
+    // Square wave slamming between both rails, the biggest residuals we can get
+    std::vector<int16_t> samples(2 * 4096);
+    for (size_t i = 0; i < samples.size(); ++i)
+        samples[i] = ((i / 64) & 1) ? INT16_MIN : INT16_MAX;
+
+    RoundTrip(ToPCM(samples), MakeHeader(1));
+    RoundTrip(ToPCM(samples), MakeHeader(2));
+}
+
+TEST(plCachedFileReader, RoundTripEscape)
+{
+    // Near silence picks a tiny Rice parameter, so the spikes have to escape
+    std::vector<int16_t> samples(16384);
+    for (size_t i = 0; i < samples.size(); ++i)
+        samples[i] = int16_t(i & 1);
+    for (size_t i = 500; i < samples.size(); i += 1000)
+        samples[i] = (i & 1) ? INT16_MIN : INT16_MAX;
+
+    EXPECT_EQ(plCachedFileReader::kBlockRice, RoundTrip(ToPCM(samples), MakeHeader(1)));
+}
+
+TEST(plCachedFileReader, RoundTripNoise)
+{
+    // White noise doesn't shrink, so it should fall back to raw
+    std::mt19937 rng(0x5eed);
+    std::uniform_int_distribution<int> dist(INT16_MIN, INT16_MAX);
+    std::vector<int16_t> samples(2 * 8192);
+    for (int16_t& sample : samples)
+        sample = int16_t(dist(rng));
+
+    EXPECT_EQ(plCachedFileReader::kBlockRaw, RoundTrip(ToPCM(samples), MakeHeader(2)));
+}
+
+TEST(plCachedFileReader, RoundTripRawFallback)
+{
+    // 8-bit PCM and partial frames are never Rice coded
+    std::vector<uint8_t> pcm(4096);
+    for (size_t i = 0; i < pcm.size(); ++i)
+        pcm[i] = uint8_t(128 + Tone(i, 50.0, 100.0));
+    EXPECT_EQ(plCachedFileReader::kBlockRaw, RoundTrip(pcm, MakeHeader(1, 8)));
+
+    std::vector<uint8_t> partial(4098, 0);
+    EXPECT_EQ(plCachedFileReader::kBlockRaw, RoundTrip(partial, MakeHeader(2)));
+}
+
+TEST(plCachedFileReader, DecodeTruncated)
+{
+    std::vector<int16_t> samples(4096);
+    for (size_t i = 0; i < samples.size(); ++i)
+        samples[i] = Tone(i, 100.0, 8000.0);
+    std::vector<uint8_t> pcm = ToPCM(samples);
+
+    // A raw block shorter than the PCM it claims to hold is rejected
+    std::vector<uint8_t> raw(1 + pcm.size() / 2, plCachedFileReader::kBlockRaw);
+    std::vector<uint8_t> decoded(pcm.size());
+    EXPECT_FALSE(plCachedFileReader::DecodeBlock(raw.data(), uint32_t(raw.size()), MakeHeader(1),
+                                                 decoded.data(), uint32_t(decoded.size())));
+    EXPECT_FALSE(plCachedFileReader::DecodeBlock(raw.data(), 0, MakeHeader(1),
+                                                 decoded.data(), uint32_t(decoded.size())));
+}
@@ -0,0 +1,132 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include <chrono>
+#include <numeric>
+#include <vector>
+#include <string_theory/stdio>
+
+#include <openssl/rc4.h>
+
+#include "plCmdParser.h"
+#include "hsMain.inl"
+
+#include "pnEncryption/plRC4.h"
+
+enum CmdLineArgs
+{
+    kArgMegabytes,
+    kArgPacketSize,
+};
+
+static const plCmdArgDef s_cmdLineArgs[] = {
+    { (kCmdTypeUint | kCmdArgFlagged), "Megabytes", kArgMegabytes },
+    { (kCmdTypeUint | kCmdArgFlagged), "PacketSize", kArgPacketSize },
+};
+
+using ClockT = std::chrono::steady_clock;
+
+static const uint8_t kKey[] = { 0x6c, 0x0b, 0x3e, 0x17, 0x42, 0x9a, 0xd5, 0x21,
+                                0x8f, 0x70, 0x13, 0xc4, 0x5e, 0xa8, 0x36, 0xf9 };
+
+static void PrintResult(const char* name, ClockT::duration elapsed, size_t bytes)
+{
+    auto total_sec = std::chrono::duration_cast<std::chrono::duration<double>>(elapsed);
+    ST::printf("{}: {.4f} seconds ({.1f} MiB/s)\n", name, total_sec.count(),
+               (bytes / (1024.0 * 1024.0)) / total_sec.count());
+}
+
+static int hsMain(std::vector<ST::string> args)
+{
+    plCmdParser parser(s_cmdLineArgs, std::size(s_cmdLineArgs));
+    parser.Parse(args);
+
+    uint32_t megabytes = 256;
+    if (parser.IsSpecified(kArgMegabytes))
+        megabytes = parser.GetUint(kArgMegabytes);
+
+    // Default to the size of a full NetCli send buffer
+    uint32_t packetSize = 1460;
+    if (parser.IsSpecified(kArgPacketSize))
+        packetSize = parser.GetUint(kArgPacketSize);
+
+    if (!megabytes || !packetSize) {
+        ST::printf(stderr, "Megabytes and PacketSize must be greater than 0.\n");
+        return 1;
+    }
+
+    std::vector<uint8_t> buffer(packetSize);
+    std::iota(buffer.begin(), buffer.end(), uint8_t(0));
+    std::vector<uint8_t> temp(packetSize);
+
+    const size_t totalBytes = size_t(megabytes) * 1024 * 1024;
+    const size_t packets = (totalBytes + packetSize - 1) / packetSize;
+
+    ST::printf("Encrypting {} MiB in {} byte packets...\n", megabytes, packetSize);
+
+    // This is what CryptEncrypt used to do for each packet
+    IGNORE_WARNINGS_BEGIN("deprecated-declarations")
+    RC4_KEY sslKey;
+    RC4_set_key(&sslKey, sizeof(kKey), kKey);
+    auto begin = ClockT::now();
+    for (size_t i = 0; i < packets; ++i) {
+        RC4(&sslKey, packetSize, buffer.data(), temp.data());
+        memcpy(buffer.data(), temp.data(), packetSize);
+    }
+    auto sslElapsed = ClockT::now() - begin;
+    IGNORE_WARNINGS_END
+
+    plRC4 rc4(kKey, sizeof(kKey));
+    begin = ClockT::now();
+    for (size_t i = 0; i < packets; ++i)
+        rc4.Process(buffer.data(), packetSize);
+    auto plElapsed = ClockT::now() - begin;
+
+    ST::printf("\n... Done!\n\n");
+
+    size_t bytes = packets * packetSize;
+    ST::printf("Results:\n");
+    PrintResult("OpenSSL RC4", sslElapsed, bytes);
+    PrintResult("plRC4", plElapsed, bytes);
+
+    return 0;
+}
@@ -0,0 +1,256 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+#include <string_theory/stdio>
+
+#include "hsColorRGBA.h"
+#include "hsCpuID.h"
+#include "hsParallel.h"
+#include "plCmdParser.h"
+#include "hsMain.inl"
+
+#include "plGImage/hsCodecManager.h"
+#include "plGImage/hsDXTSoftwareCodec.h"
+#include "plGImage/plMipmap.h"
+
+enum CmdLineArgs
+{
+    kArgSize,
+    kArgTextures,
+};
+
+static const plCmdArgDef s_cmdLineArgs[] = {
+    { (kCmdTypeUint | kCmdArgFlagged), "Size", kArgSize },
+    { (kCmdTypeUint | kCmdArgFlagged), "Textures", kArgTextures },
+};
+
+using ClockT = std::chrono::steady_clock;
+
+// Smooth gradients with a bit of noise, so the endpoint search has real work
+// to do instead of hitting flat blocks
+static std::unique_ptr<plMipmap> ICreateTexture(uint32_t size, bool alpha, std::mt19937& rng)
+{
+    auto mipmap = std::make_unique<plMipmap>(size, size, plMipmap::kARGB32Config, 0);
+    if (alpha)
+        mipmap->SetFlags(plMipmap::kAlphaChannelFlag);
+
+    std::uniform_int_distribution<int> noise(-24, 24);
+    for (uint8_t level = 0; level < mipmap->GetNumLevels(); ++level) {
+        mipmap->SetCurrLevel(level);
+        uint32_t width = mipmap->GetCurrWidth();
+        uint32_t height = mipmap->GetCurrHeight();
+        for (uint32_t y = 0; y < height; ++y) {
+            for (uint32_t x = 0; x < width; ++x) {
+                auto channel = [&noise, &rng](uint32_t base) {
+                    return uint32_t(std::clamp<int>(int(base & 0xFF) + noise(rng), 0, 255));
+                };
+                uint32_t a = alpha ? channel(x + y) : 0xFF;
+                uint32_t r = channel(x * 3);
+                uint32_t g = channel(y * 5);
+                uint32_t b = channel((x ^ y) * 2);
+                *mipmap->GetAddr32(x, y) = (a << 24) | (r << 16) | (g << 8) | b;
+            }
+        }
+    }
+    mipmap->SetCurrLevel(0);
+    return mipmap;
+}
+
+// Decodes every 4x4-aligned level of a compressed mipmap through both the
+// threaded codec path and the serial row decoder, and returns how many levels
+// came out different
+static size_t ICompareDecodes(hsDXTSoftwareCodec& codec, plMipmap* compressed, size_t& levels)
+{
+    std::unique_ptr<plMipmap> threaded(codec.CreateUncompressedMipmap(compressed, hsCodecManager::k32BitDepth));
+    std::unique_ptr<plMipmap> serial(codec.CreateUncompressedMipmap(compressed, hsCodecManager::k32BitDepth));
+    memset(serial->GetImage(), 0, serial->GetTotalSize());
+
+    size_t mismatches = 0;
+    for (uint8_t level = 0; level < compressed->GetNumLevels(); ++level) {
+        compressed->SetCurrLevel(level);
+        serial->SetCurrLevel(level);
+        if ((compressed->GetCurrWidth() | compressed->GetCurrHeight()) & 3)
+            break;
+
+        codec.UncompressLevelSerial32(serial.get(), compressed);
+        if (memcmp(threaded->GetLevelPtr(level), serial->GetLevelPtr(level), threaded->GetLevelSize(level)) != 0)
+            ++mismatches;
+        ++levels;
+    }
+    compressed->SetCurrLevel(0);
+    return mismatches;
+}
+
+// Gathers every 4x4 block of the top level in the column-major order the
+// compressor hands to the endpoint search
+static void IGatherBlocks(plMipmap* mipmap, std::vector<hsRGBAColor32>& pixels)
+{
+    mipmap->SetCurrLevel(0);
+    for (uint32_t by = 0; by < mipmap->GetCurrHeight(); by += 4) {
+        for (uint32_t bx = 0; bx < mipmap->GetCurrWidth(); bx += 4) {
+            for (uint32_t xx = 0; xx < 4; ++xx) {
+                for (uint32_t yy = 0; yy < 4; ++yy)
+                    pixels.push_back(*reinterpret_cast<hsRGBAColor32*>(mipmap->GetAddr32(bx + xx, by + yy)));
+            }
+        }
+    }
+}
+
+static void PrintResult(const char* name, ClockT::duration elapsed, size_t blocks)
+{
+    auto total_sec = std::chrono::duration_cast<std::chrono::duration<double>>(elapsed);
+    ST::printf("{}: {.4f} seconds ({.2f} Mblocks/s)\n", name, total_sec.count(),
+               (blocks / 1000000.0) / total_sec.count());
+}
+
+static int hsMain(std::vector<ST::string> args)
+{
+    plCmdParser parser(s_cmdLineArgs, std::size(s_cmdLineArgs));
+    parser.Parse(args);
+
+    uint32_t size = 1024;
+    if (parser.IsSpecified(kArgSize))
+        size = parser.GetUint(kArgSize);
+
+    uint32_t textures = 8;
+    if (parser.IsSpecified(kArgTextures))
+        textures = parser.GetUint(kArgTextures);
+
+    if (size < 4 || (size & (size - 1)) || !textures) {
+        ST::printf(stderr, "Size must be a power of two of at least 4, and Textures greater than 0.\n");
+        return 1;
+    }
+
+    hsDXTSoftwareCodec::Init();
+    hsDXTSoftwareCodec& codec = hsDXTSoftwareCodec::Instance();
+
+    // Half opaque (DXT1), half with alpha (DXT5)
+    std::mt19937 rng(0x5eed);
+    std::vector<std::unique_ptr<plMipmap>> sources;
+    for (uint32_t i = 0; i < textures; ++i)
+        sources.emplace_back(ICreateTexture(size, (i & 1) != 0, rng));
+
+    ST::printf("Compressing {} {}x{} textures on up to {} threads...\n",
+               textures, size, size, hsParallelThreadCount());
+
+    std::vector<hsRGBAColor32> pixels;
+    for (const auto& source : sources)
+        IGatherBlocks(source.get(), pixels);
+    const size_t blocks = pixels.size() / 16;
+
+    // The codec also compresses every mip level that is still a multiple of 4
+    size_t codecBlocks = 0;
+    for (uint32_t levelSize = size; levelSize >= 4; levelSize >>= 1)
+        codecBlocks += (levelSize / 4) * (levelSize / 4);
+    codecBlocks *= textures;
+
+    std::vector<uint8_t> reference(blocks * 2);
+    auto begin = ClockT::now();
+    for (size_t i = 0; i < blocks; ++i) {
+        uint32_t first, second;
+        hsDXTSoftwareCodec::find_endpoints_fpu(&pixels[i * 16], first, second);
+        reference[i * 2] = uint8_t(first);
+        reference[i * 2 + 1] = uint8_t(second);
+    }
+    auto fpuElapsed = ClockT::now() - begin;
+
+    const hsCpuId& cpu = hsCpuId::Instance();
+    ClockT::duration sse2Elapsed{};
+    size_t sse2Mismatches = 0;
+    if (cpu.has_sse2) {
+        std::vector<uint8_t> results(blocks * 2);
+        begin = ClockT::now();
+        for (size_t i = 0; i < blocks; ++i) {
+            uint32_t first, second;
+            hsDXTSoftwareCodec::find_endpoints_sse2(&pixels[i * 16], first, second);
+            results[i * 2] = uint8_t(first);
+            results[i * 2 + 1] = uint8_t(second);
+        }
+        sse2Elapsed = ClockT::now() - begin;
+
+        for (size_t i = 0; i < blocks * 2; i += 2) {
+            if (results[i] != reference[i] || results[i + 1] != reference[i + 1])
+                ++sse2Mismatches;
+        }
+    }
+
+    std::vector<std::unique_ptr<plMipmap>> compressed;
+    begin = ClockT::now();
+    for (const auto& source : sources)
+        compressed.emplace_back(codec.CreateCompressedMipmap(source.get()));
+    auto compressElapsed = ClockT::now() - begin;
+
+    begin = ClockT::now();
+    for (const auto& mipmap : compressed)
+        delete codec.CreateUncompressedMipmap(mipmap.get(), hsCodecManager::k32BitDepth);
+    auto decompressElapsed = ClockT::now() - begin;
+
+    size_t dxt1Levels = 0, dxt1Mismatches = 0;
+    size_t dxt5Levels = 0, dxt5Mismatches = 0;
+    for (const auto& mipmap : compressed) {
+        if (mipmap->fDirectXInfo.fCompressionType == plMipmap::DirectXInfo::kDXT5)
+            dxt5Mismatches += ICompareDecodes(codec, mipmap.get(), dxt5Levels);
+        else
+            dxt1Mismatches += ICompareDecodes(codec, mipmap.get(), dxt1Levels);
+    }
+
+    ST::printf("\n... Done!\n\n");
+
+    ST::printf("Results:\n");
+    PrintResult("Endpoint search (scalar)", fpuElapsed, blocks);
+    if (cpu.has_sse2) {
+        PrintResult("Endpoint search (SSE2)", sse2Elapsed, blocks);
+        ST::printf("  {} of {} blocks differ from scalar\n", sse2Mismatches, blocks);
+    }
+    PrintResult("CreateCompressedMipmap (dispatched, threaded)", compressElapsed, codecBlocks);
+    PrintResult("CreateUncompressedMipmap (threaded)", decompressElapsed, codecBlocks);
+    ST::printf("  {} of {} DXT1 levels differ from serial decode\n", dxt1Mismatches, dxt1Levels);
+    ST::printf("  {} of {} DXT5 levels differ from serial decode\n", dxt5Mismatches, dxt5Levels);
+
+    return (sse2Mismatches || dxt1Mismatches || dxt5Mismatches) ? 1 : 0;
+}
@@ -0,0 +1,411 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <string_theory/stdio>
+
+#include "plCmdParser.h"
+#include "plFileSystem.h"
+#include "hsMain.inl"
+#include "hsStream.h"
+
+#include "pnFactory/plFactory.h"
+#include "pnNetBase/pnNbKeys.h"
+#include "pnNetBase/pnNbProtocol.h"
+#include "pnNetCli/pnNetCli.h"
+#include "pnNetProtocol/pnNpCli2Auth.h"
+#include "pnNetProtocol/pnNpCli2Game.h"
+#include "pnNetProtocol/pnNpCli2GateKeeper.h"
+#include "pnNetProtocol/pnNpCommon.h"
+
+#include "plNetMessage/plNetMessageCreatable.h"
+
+enum CmdLineArgs
+{
+    kArgProtocol,
+    kArgLogFile,
+    kArgCount,
+};
+
+static const plCmdArgDef s_cmdLineArgs[] = {
+    { (kCmdTypeString | kCmdArgRequired), "Protocol", kArgProtocol },
+    { (kCmdTypeString | kCmdArgRequired), "LogFile", kArgLogFile },
+    { (kCmdTypeUint | kCmdArgFlagged), "Count", kArgCount },
+};
+
+using ClockT = std::chrono::steady_clock;
+
+/*****************************************************************************
+*
+*   Message handling
+*
+***/
+
+struct MsgStats
+{
+    const char*         fName;
+    size_t              fCount;
+    size_t              fBytes;
+    ClockT::duration    fDecodeTime;
+
+    MsgStats() : fName(), fCount(), fBytes(), fDecodeTime(ClockT::duration::zero()) { }
+};
+
+struct ReplayState
+{
+    // Message IDs are only unique within a protocol
+    std::map<std::pair<uint32_t, uint32_t>, MsgStats> fStats;
+    size_t fMessages;
+    size_t fDecodeErrors;
+
+    ReplayState() : fMessages(), fDecodeErrors() { }
+};
+
+// Does the same work as the client's propagate buffer callback, up to the
+// point where the message would be handed off to plNetClientMgr
+static bool DecodePropagateBuffer(uint32_t type, uint32_t bytes, const uint8_t buffer[])
+{
+    if (!plFactory::IsValidClassIndex(type))
+        return false;
+
+    plNetMessage* msg = plNetMessage::ConvertNoRef(plFactory::Create(type));
+    if (!msg)
+        return false;
+
+    hsReadOnlyStream stream(bytes, buffer);
+    bool result = msg->PeekBuffer(&stream) != 0;
+    msg->UnRef();
+    return result;
+}
+
+static bool DecodeVaultNode(uint32_t bytes, const uint8_t buffer[])
+{
+    hsRef<NetVaultNode> node(new NetVaultNode, hsStealRef);
+    return node->Read(buffer, bytes);
+}
+
+static void RecordMsg(ReplayState* state, uint32_t protocol, uint32_t msgId, unsigned bytes,
+                      ClockT::duration elapsed, bool decoded)
+{
+    MsgStats& stats = state->fStats[std::make_pair(protocol, msgId)];
+    stats.fCount++;
+    stats.fBytes += bytes;
+    stats.fDecodeTime += elapsed;
+    state->fMessages++;
+    if (!decoded)
+        state->fDecodeErrors++;
+}
+
+static bool RecvGateKeeperMsg(const uint8_t msg[], unsigned bytes, void* param)
+{
+    uint32_t msgId = *reinterpret_cast<const uint32_t*>(msg);
+    RecordMsg(static_cast<ReplayState*>(param), kNetProtocolCli2GateKeeper, msgId, bytes,
+              ClockT::duration::zero(), true);
+    return true;
+}
+
+static bool RecvAuthMsg(const uint8_t msg[], unsigned bytes, void* param)
+{
+    uint32_t msgId = *reinterpret_cast<const uint32_t*>(msg);
+
+    auto begin = ClockT::now();
+    bool decoded = true;
+    switch (msgId) {
+    case kAuth2Cli_PropagateBuffer: {
+        const Auth2Cli_PropagateBuffer& reply = *reinterpret_cast<const Auth2Cli_PropagateBuffer*>(msg);
+        decoded = DecodePropagateBuffer(reply.type, reply.bytes, reply.buffer);
+    }
+    break;
+
+    case kAuth2Cli_VaultNodeFetched: {
+        const Auth2Cli_VaultNodeFetched& reply = *reinterpret_cast<const Auth2Cli_VaultNodeFetched*>(msg);
+        if (IS_NET_SUCCESS(reply.result))
+            decoded = DecodeVaultNode(reply.nodeBytes, reply.nodeBuffer);
+    }
+    break;
+    }
+    auto elapsed = ClockT::now() - begin;
+
+    RecordMsg(static_cast<ReplayState*>(param), kNetProtocolCli2Auth, msgId, bytes, elapsed, decoded);
+    return true;
+}
+
+static bool RecvGameMsg(const uint8_t msg[], unsigned bytes, void* param)
+{
+    uint32_t msgId = *reinterpret_cast<const uint32_t*>(msg);
+
+    auto begin = ClockT::now();
+    bool decoded = true;
+    switch (msgId) {
+    case kGame2Cli_PropagateBuffer: {
+        const Game2Cli_PropagateBuffer& reply = *reinterpret_cast<const Game2Cli_PropagateBuffer*>(msg);
+        decoded = DecodePropagateBuffer(reply.type, reply.bytes, reply.buffer);
+    }
+    break;
+    }
+    auto elapsed = ClockT::now() - begin;
+
+    RecordMsg(static_cast<ReplayState*>(param), kNetProtocolCli2Game, msgId, bytes, elapsed, decoded);
+    return true;
+}
+
+#define RECV(msg, fn) { &kNetMsg_##msg, fn }
+
+static const NetMsgInitRecv s_gateKeeperRecv[] = {
+    RECV(GateKeeper2Cli_PingReply, RecvGateKeeperMsg),
+    RECV(GateKeeper2Cli_FileSrvIpAddressReply, RecvGateKeeperMsg),
+    RECV(GateKeeper2Cli_AuthSrvIpAddressReply, RecvGateKeeperMsg),
+};
+
+static const NetMsgInitRecv s_authRecv[] = {
+    RECV(Auth2Cli_PingReply, RecvAuthMsg),
+    RECV(Auth2Cli_ServerAddr, RecvAuthMsg),
+    RECV(Auth2Cli_NotifyNewBuild, RecvAuthMsg),
+    RECV(Auth2Cli_ClientRegisterReply, RecvAuthMsg),
+    RECV(Auth2Cli_AcctLoginReply, RecvAuthMsg),
+    RECV(Auth2Cli_AcctPlayerInfo, RecvAuthMsg),
+    RECV(Auth2Cli_AcctSetPlayerReply, RecvAuthMsg),
+    RECV(Auth2Cli_AcctCreateReply, RecvAuthMsg),
+    RECV(Auth2Cli_AcctChangePasswordReply, RecvAuthMsg),
+    RECV(Auth2Cli_AcctSetRolesReply, RecvAuthMsg),
+    RECV(Auth2Cli_AcctSetBillingTypeReply, RecvAuthMsg),
+    RECV(Auth2Cli_AcctActivateReply, RecvAuthMsg),
+    RECV(Auth2Cli_AcctCreateFromKeyReply, RecvAuthMsg),
+    RECV(Auth2Cli_PlayerCreateReply, RecvAuthMsg),
+    RECV(Auth2Cli_PlayerDeleteReply, RecvAuthMsg),
+    RECV(Auth2Cli_UpgradeVisitorReply, RecvAuthMsg),
+    RECV(Auth2Cli_SetPlayerBanStatusReply, RecvAuthMsg),
+    RECV(Auth2Cli_ChangePlayerNameReply, RecvAuthMsg),
+    RECV(Auth2Cli_SendFriendInviteReply, RecvAuthMsg),
+    RECV(Auth2Cli_VaultNodeCreated, RecvAuthMsg),
+    RECV(Auth2Cli_VaultNodeFetched, RecvAuthMsg),
+    RECV(Auth2Cli_VaultNodeChanged, RecvAuthMsg),
+    RECV(Auth2Cli_VaultNodeDeleted, RecvAuthMsg),
+    RECV(Auth2Cli_VaultNodeAdded, RecvAuthMsg),
+    RECV(Auth2Cli_VaultNodeRemoved, RecvAuthMsg),
+    RECV(Auth2Cli_VaultNodeRefsFetched, RecvAuthMsg),
+    RECV(Auth2Cli_VaultInitAgeReply, RecvAuthMsg),
+    RECV(Auth2Cli_VaultNodeFindReply, RecvAuthMsg),
+    RECV(Auth2Cli_VaultSaveNodeReply, RecvAuthMsg),
+    RECV(Auth2Cli_VaultAddNodeReply, RecvAuthMsg),
+    RECV(Auth2Cli_VaultRemoveNodeReply, RecvAuthMsg),
+    RECV(Auth2Cli_AgeReply, RecvAuthMsg),
+    RECV(Auth2Cli_FileListReply, RecvAuthMsg),
+    RECV(Auth2Cli_FileDownloadChunk, RecvAuthMsg),
+    RECV(Auth2Cli_PropagateBuffer, RecvAuthMsg),
+    RECV(Auth2Cli_KickedOff, RecvAuthMsg),
+    RECV(Auth2Cli_PublicAgeList, RecvAuthMsg),
+    RECV(Auth2Cli_ScoreCreateReply, RecvAuthMsg),
+    RECV(Auth2Cli_ScoreDeleteReply, RecvAuthMsg),
+    RECV(Auth2Cli_ScoreGetScoresReply, RecvAuthMsg),
+    RECV(Auth2Cli_ScoreAddPointsReply, RecvAuthMsg),
+    RECV(Auth2Cli_ScoreTransferPointsReply, RecvAuthMsg),
+    RECV(Auth2Cli_ScoreSetPointsReply, RecvAuthMsg),
+    RECV(Auth2Cli_ScoreGetRanksReply, RecvAuthMsg),
+    RECV(Auth2Cli_ScoreGetHighScoresReply, RecvAuthMsg),
+    RECV(Auth2Cli_ServerCaps, RecvAuthMsg),
+};
+
+static const NetMsgInitRecv s_gameRecv[] = {
+    RECV(Game2Cli_PingReply, RecvGameMsg),
+    RECV(Game2Cli_JoinAgeReply, RecvGameMsg),
+    RECV(Game2Cli_PropagateBuffer, RecvGameMsg),
+    RECV(Game2Cli_GameMgrMsg, RecvGameMsg),
+};
+
+#undef RECV
+
+/*****************************************************************************
+*
+*   Log parsing
+*
+***/
+
+// Reads the server-to-client chunks out of a log written by plNetLog.  Each
+// chunk looks like "[<<< time]" followed by lines of space separated hex bytes.
+static bool ReadCapture(const plFileName& filename, std::vector<std::vector<uint8_t>>& chunks)
+{
+    std::unique_ptr<FILE, decltype(&fclose)> file(plFileSystem::Open(filename, "rb"), &fclose);
+    if (!file)
+        return false;
+
+    std::vector<uint8_t>* chunk = nullptr;
+    char line[512];
+    while (fgets(line, sizeof(line), file.get())) {
+        if (line[0] == '[') {
+            if (strncmp(line + 1, "<<<", 3) == 0) {
+                chunk = &chunks.emplace_back();
+            } else {
+                // Client-to-server traffic doesn't go through NetCliDispatch
+                chunk = nullptr;
+            }
+            continue;
+        }
+
+        if (!chunk)
+            continue;
+
+        char* cur = line;
+        for (;;) {
+            char* end;
+            unsigned long value = strtoul(cur, &end, 16);
+            if (end == cur)
+                break;
+            chunk->push_back(uint8_t(value));
+            cur = end;
+        }
+    }
+
+    return true;
+}
+
+/*****************************************************************************
+*
+*   Main
+*
+***/
+
+static int hsMain(std::vector<ST::string> args)
+{
+    plCmdParser parser(s_cmdLineArgs, std::size(s_cmdLineArgs));
+    if (!parser.Parse(args)) {
+        ST::printf(stderr, "Usage: plNetReplayBenchmark gatekeeper|auth|game LogFile [-Count N]\n");
+        return 1;
+    }
+
+    ST::string protocolName = parser.GetString(kArgProtocol);
+    uint32_t protocol;
+    const NetMsgInitRecv* recv;
+    size_t recvCount;
+    if (protocolName.compare_i("gatekeeper") == 0) {
+        protocol = kNetProtocolCli2GateKeeper;
+        recv = s_gateKeeperRecv;
+        recvCount = std::size(s_gateKeeperRecv);
+    } else if (protocolName.compare_i("auth") == 0) {
+        protocol = kNetProtocolCli2Auth;
+        recv = s_authRecv;
+        recvCount = std::size(s_authRecv);
+    } else if (protocolName.compare_i("game") == 0) {
+        protocol = kNetProtocolCli2Game;
+        recv = s_gameRecv;
+        recvCount = std::size(s_gameRecv);
+    } else {
+        ST::printf(stderr, "Unknown protocol '{}'.\n", protocolName);
+        return 1;
+    }
+
+    uint32_t count = 10;
+    if (parser.IsSpecified(kArgCount))
+        count = parser.GetUint(kArgCount);
+    if (count == 0) {
+        ST::printf(stderr, "Cannot iterate less than 1 time.\n");
+        return 1;
+    }
+
+    plFileName logFile = parser.GetString(kArgLogFile);
+    std::vector<std::vector<uint8_t>> chunks;
+    if (!ReadCapture(logFile, chunks)) {
+        ST::printf(stderr, "Could not read '{}'.\n", logFile);
+        return 1;
+    }
+
+    size_t captureBytes = 0;
+    for (const std::vector<uint8_t>& chunk : chunks)
+        captureBytes += chunk.size();
+    if (!captureBytes) {
+        ST::printf(stderr, "No server-to-client traffic was found in '{}'.\n", logFile);
+        return 1;
+    }
+
+    ST::printf("Replaying {} chunks ({} bytes) {} times...\n", chunks.size(), captureBytes, count);
+
+    ReplayState state;
+    NetMsgChannel* channel = NetMsgChannelCreate(protocol, nullptr, 0, recv, uint32_t(recvCount), NetDhConstants());
+
+    auto elapsed = ClockT::duration::zero();
+    for (uint32_t i = 0; i < count; ++i) {
+        // A fresh connection each pass, so a truncated message at the end of
+        // the capture doesn't bleed into the next pass
+        NetCli* cli = NetCliCreateReplay(channel);
+        auto begin = ClockT::now();
+        for (const std::vector<uint8_t>& chunk : chunks) {
+            if (!NetCliDispatch(cli, chunk.data(), unsigned(chunk.size()), &state))
+                break;
+        }
+        elapsed += ClockT::now() - begin;
+        NetCliDelete(cli, false);
+    }
+
+    NetMsgChannelDelete(channel);
+
+    for (size_t i = 0; i < recvCount; ++i) {
+        auto it = state.fStats.find(std::make_pair(protocol, recv[i].msg->messageId));
+        if (it != state.fStats.end())
+            it->second.fName = recv[i].msg->name;
+    }
+
+    ST::printf("\n... Done!\n\n");
+
+    auto total_sec = std::chrono::duration_cast<std::chrono::duration<double>>(elapsed);
+    ST::printf("Results:\n");
+    ST::printf("{} messages in {.4f} seconds ({.0f} messages/sec, {.1f} MiB/s)\n",
+               state.fMessages, total_sec.count(), state.fMessages / total_sec.count(),
+               (captureBytes * count / (1024.0 * 1024.0)) / total_sec.count());
+    if (state.fDecodeErrors)
+        ST::printf("WARNING: {} messages failed to decode\n", state.fDecodeErrors);
+
+    ST::printf("\n{<40} {>10} {>12} {>14}\n", "Message", "Count", "Avg bytes", "Avg decode ns");
+    for (const auto& [id, stats] : state.fStats) {
+        auto decode_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(stats.fDecodeTime / stats.fCount);
+        ST::printf("{<40} {>10} {>12} {>14}\n",
+                   stats.fName ? stats.fName : ST::format("(unknown {})", id.second).c_str(),
+                   stats.fCount, stats.fBytes / stats.fCount, decode_ns.count());
+    }
+
+    return 0;
+}
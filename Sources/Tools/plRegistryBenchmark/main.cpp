@@ -0,0 +1,185 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include <chrono>
+#include <set>
+#include <vector>
+#include <string_theory/stdio>
+
+#include "plCmdParser.h"
+#include "plFileSystem.h"
+#include "hsMain.inl"
+
+#include "pnKeyedObject/plUoid.h"
+
+#include "plResMgr/plRegistryHelpers.h"
+#include "plResMgr/plRegistryNode.h"
+#include "plResMgr/plResManager.h"
+#include "plResMgr/plResMgrSettings.h"
+
+enum CmdLineArgs
+{
+    kArgCount,
+    kArgDirectory,
+};
+
+static const plCmdArgDef s_cmdLineArgs[] = {
+    { (kCmdTypeUint | kCmdArgFlagged), "Count", kArgCount },
+    { (kCmdTypeString | kCmdArgOptional), "Directory", kArgDirectory },
+};
+
+using ClockT = std::chrono::steady_clock;
+
+// Loads the keys for every page and holds on to them until we're done
+class plLoadAllKeysIterator : public plRegistryPageIterator, public plKeyCollector
+{
+public:
+    plLoadAllKeysIterator(std::set<plKey>& keys) : plKeyCollector(keys) { }
+
+    bool EatPage(plRegistryPageNode* page) override
+    {
+        page->LoadKeys();
+        return page->IterateKeys(this);
+    }
+};
+
+static void PrintResult(const char* name, ClockT::duration elapsed, size_t lookups)
+{
+    auto total_sec = std::chrono::duration_cast<std::chrono::duration<double>>(elapsed);
+    auto per_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed / lookups);
+    ST::printf("{}: {.4f} seconds ({} ns per lookup)\n", name, total_sec.count(), per_ns.count());
+}
+
+static int hsMain(std::vector<ST::string> args)
+{
+    plCmdParser parser(s_cmdLineArgs, std::size(s_cmdLineArgs));
+    parser.Parse(args);
+
+    plFileName dataDir;
+    if (parser.IsSpecified(kArgDirectory))
+        dataDir = parser.GetString(kArgDirectory);
+    else
+        dataDir = plFileSystem::GetCWD();
+
+    if (!dataDir.IsValid() || !plFileInfo(dataDir).IsDirectory()) {
+        ST::printf(stderr, "The directory '{}' does not exist.\n", dataDir);
+        return 1;
+    }
+
+    int32_t count = 100;
+    if (parser.IsSpecified(kArgCount))
+        count = parser.GetInt(kArgCount);
+    if (count <= 0) {
+        ST::printf(stderr, "Cannot iterate less than 1 time.\n");
+        return 1;
+    }
+
+    ST::printf("Loading the page keys from '{}'...\n", dataDir);
+
+    plResMgrSettings::Get().SetFilterNewerPageVersions(false);
+    plResMgrSettings::Get().SetFilterOlderPageVersions(false);
+    plResManager* resMgr = new plResManager;
+    resMgr->SetDataPath(dataDir);
+    hsgResMgr::Init(resMgr);
+
+    std::set<plKey> keys;
+    {
+        plLoadAllKeysIterator loader(keys);
+        resMgr->IterateAllPages(&loader);
+    }
+
+    // Strip the object IDs off, so the lookups have to go by name like the
+    // ones from Python and plKeyFinder do.
+    std::vector<plUoid> byName;
+    byName.reserve(keys.size());
+    for (const plKey& key : keys) {
+        const plUoid& uoid = key->GetUoid();
+        byName.emplace_back(uoid.GetLocation(), uoid.GetClassType(), uoid.GetObjectName(), uoid.GetLoadMask());
+    }
+
+    if (byName.empty()) {
+        ST::printf(stderr, "No keys were found.\n");
+        keys.clear();
+        hsgResMgr::Shutdown();
+        return 1;
+    }
+
+    ST::printf("Looking up {} keys {} times...\n", byName.size(), count);
+
+    size_t misses = 0;
+    auto pageElapsed = ClockT::duration::zero();
+    auto resMgrElapsed = ClockT::duration::zero();
+    for (int32_t i = 0; i < count; ++i) {
+        auto begin = ClockT::now();
+        for (const plUoid& uoid : byName) {
+            plRegistryPageNode* page = resMgr->FindPage(uoid.GetLocation());
+            if (!page || !page->FindKey(uoid.GetClassType(), uoid.GetObjectName()))
+                ++misses;
+        }
+        auto end = ClockT::now();
+        pageElapsed += end - begin;
+
+        begin = ClockT::now();
+        for (const plUoid& uoid : byName) {
+            if (!resMgr->FindKey(uoid))
+                ++misses;
+        }
+        end = ClockT::now();
+        resMgrElapsed += end - begin;
+    }
+
+    ST::printf("\n... Done!\n\n");
+
+    size_t lookups = byName.size() * count;
+    ST::printf("Results:\n");
+    PrintResult("plRegistryPageNode::FindKey", pageElapsed, lookups);
+    PrintResult("plResManager::FindKey", resMgrElapsed, lookups);
+    if (misses)
+        ST::printf("WARNING: {} lookups failed\n", misses);
+
+    keys.clear();
+    plIndirectUnloadIterator unloader;
+    resMgr->IterateAllPages(&unloader);
+    hsgResMgr::Shutdown();
+
+    return 0;
+}
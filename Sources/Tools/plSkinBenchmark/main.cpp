@@ -0,0 +1,232 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <string_theory/stdio>
+
+#include "hsCpuID.h"
+#include "hsParallel.h"
+#include "plCmdParser.h"
+#include "hsMain.inl"
+
+#include "plDrawable/plGBufferGroup.h"
+#include "plPipeline/plSoftwareSkin.h"
+
+enum CmdLineArgs
+{
+    kArgAvatars,
+    kArgFrames,
+};
+
+static const plCmdArgDef s_cmdLineArgs[] = {
+    { (kCmdTypeUint | kCmdArgFlagged), "Avatars", kArgAvatars },
+    { (kCmdTypeUint | kCmdArgFlagged), "Frames", kArgFrames },
+};
+
+using ClockT = std::chrono::steady_clock;
+
+// Roughly the shape of an avatar: a few skinned spans sharing one palette
+static constexpr uint32_t kSpansPerAvatar = 8;
+static constexpr uint32_t kVertsPerSpan = 600;
+static constexpr uint32_t kBonesPerAvatar = 64;
+
+// Position, 3 weights, packed indices, normal, two colors, one UVW channel
+static constexpr uint8_t kFormat = plGBufferGroup::kSkin3Weights | plGBufferGroup::kSkinIndices | 1;
+static constexpr size_t kSrcVertSize = sizeof(float) * 3 + sizeof(float) * 3 + sizeof(uint32_t)
+                                     + sizeof(float) * 3 + sizeof(uint32_t) * 2 + sizeof(float) * 3;
+static constexpr size_t kDestVertSize = kSrcVertSize - sizeof(float) * 3 - sizeof(uint32_t);
+
+struct SkinScene
+{
+    std::vector<hsMatrix44> fPalettes;
+    std::vector<uint8_t>    fSrc;
+    std::vector<uint8_t>    fDest;
+    std::vector<plSoftwareSkin::Span> fSpans;
+};
+
+static void IBuildScene(SkinScene& scene, uint32_t avatars)
+{
+    std::mt19937 rng(0x5eed);
+    std::uniform_real_distribution<float> unit(-1.f, 1.f);
+
+    scene.fPalettes.resize(size_t(avatars) * kBonesPerAvatar);
+    for (hsMatrix44& xfm : scene.fPalettes) {
+        xfm.Reset();
+        for (int r = 0; r < 3; ++r) {
+            for (int c = 0; c < 4; ++c)
+                xfm.fMap[r][c] = unit(rng);
+        }
+    }
+
+    const size_t numVerts = size_t(avatars) * kSpansPerAvatar * kVertsPerSpan;
+    scene.fSrc.resize(numVerts * kSrcVertSize);
+    scene.fDest.resize(numVerts * kDestVertSize);
+
+    for (size_t i = 0; i < numVerts; ++i) {
+        float* vert = reinterpret_cast<float*>(scene.fSrc.data() + i * kSrcVertSize);
+        vert[0] = unit(rng) * 5.f;
+        vert[1] = unit(rng) * 5.f;
+        vert[2] = unit(rng) * 5.f;
+
+        float w0 = std::abs(unit(rng)) * 0.5f;
+        float w1 = std::abs(unit(rng)) * (1.f - w0) * 0.5f;
+        vert[3] = w0;
+        vert[4] = w1;
+        vert[5] = 0.f;
+
+        uint32_t indices = 0;
+        for (int j = 0; j < 4; ++j)
+            indices |= (rng() % kBonesPerAvatar) << (j * 8);
+        memcpy(&vert[6], &indices, sizeof(indices));
+
+        vert[7] = unit(rng);
+        vert[8] = unit(rng);
+        vert[9] = unit(rng);
+        for (int j = 10; j < 15; ++j)
+            vert[j] = unit(rng);
+    }
+
+    for (uint32_t a = 0; a < avatars; ++a) {
+        const hsMatrix44* palette = &scene.fPalettes[size_t(a) * kBonesPerAvatar];
+        for (uint32_t s = 0; s < kSpansPerAvatar; ++s) {
+            size_t firstVert = (size_t(a) * kSpansPerAvatar + s) * kVertsPerSpan;
+
+            plSoftwareSkin::Span& span = scene.fSpans.emplace_back();
+            span.fLocalToWorld = palette[0];
+            span.fPalette = palette;
+            span.fSrc = scene.fSrc.data() + firstVert * kSrcVertSize;
+            span.fDest = scene.fDest.data() + firstVert * kDestVertSize;
+            span.fCount = kVertsPerSpan;
+            span.fFormat = kFormat;
+        }
+    }
+}
+
+static float IMaxError(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b)
+{
+    const float* fa = reinterpret_cast<const float*>(a.data());
+    const float* fb = reinterpret_cast<const float*>(b.data());
+    float maxErr = 0.f;
+    for (size_t i = 0; i < a.size() / sizeof(float); ++i)
+        maxErr = std::max(maxErr, std::abs(fa[i] - fb[i]));
+    return maxErr;
+}
+
+static void PrintResult(const char* name, ClockT::duration elapsed, size_t verts, float maxErr)
+{
+    auto total_sec = std::chrono::duration_cast<std::chrono::duration<double>>(elapsed);
+    ST::printf("{}: {.4f} seconds ({.1f} Mverts/s, max error {.2e})\n", name, total_sec.count(),
+               (verts / 1000000.0) / total_sec.count(), maxErr);
+}
+
+static int hsMain(std::vector<ST::string> args)
+{
+    plCmdParser parser(s_cmdLineArgs, std::size(s_cmdLineArgs));
+    parser.Parse(args);
+
+    uint32_t avatars = 32;
+    if (parser.IsSpecified(kArgAvatars))
+        avatars = parser.GetUint(kArgAvatars);
+
+    uint32_t frames = 200;
+    if (parser.IsSpecified(kArgFrames))
+        frames = parser.GetUint(kArgFrames);
+
+    if (!avatars || !frames) {
+        ST::printf(stderr, "Avatars and Frames must be greater than 0.\n");
+        return 1;
+    }
+
+    SkinScene scene;
+    IBuildScene(scene, avatars);
+    const size_t verts = size_t(avatars) * kSpansPerAvatar * kVertsPerSpan * frames;
+
+    ST::printf("Skinning {} avatars ({} verts each) for {} frames on up to {} threads...\n",
+               avatars, kSpansPerAvatar * kVertsPerSpan, frames, hsParallelThreadCount());
+
+    auto runKernel = [&scene, frames](plSoftwareSkin::blend_verts_ptr kernel) {
+        auto begin = ClockT::now();
+        for (uint32_t f = 0; f < frames; ++f) {
+            for (const plSoftwareSkin::Span& span : scene.fSpans)
+                kernel(span);
+        }
+        return ClockT::now() - begin;
+    };
+
+    auto fpuElapsed = runKernel(&plSoftwareSkin::blend_verts_fpu);
+    std::vector<uint8_t> reference = scene.fDest;
+
+    const hsCpuId& cpu = hsCpuId::Instance();
+    ClockT::duration sse3Elapsed{}, avx2Elapsed{};
+    float sse3Err = 0.f, avx2Err = 0.f;
+    if (cpu.has_sse3) {
+        sse3Elapsed = runKernel(&plSoftwareSkin::blend_verts_sse3);
+        sse3Err = IMaxError(reference, scene.fDest);
+    }
+    if (cpu.has_avx2) {
+        avx2Elapsed = runKernel(&plSoftwareSkin::blend_verts_avx2);
+        avx2Err = IMaxError(reference, scene.fDest);
+    }
+
+    auto begin = ClockT::now();
+    for (uint32_t f = 0; f < frames; ++f)
+        plSoftwareSkin::BlendSpans(scene.fSpans);
+    auto threadedElapsed = ClockT::now() - begin;
+    float threadedErr = IMaxError(reference, scene.fDest);
+
+    ST::printf("\n... Done!\n\n");
+
+    ST::printf("Results:\n");
+    PrintResult("Scalar", fpuElapsed, verts, 0.f);
+    if (cpu.has_sse3)
+        PrintResult("SSE3", sse3Elapsed, verts, sse3Err);
+    if (cpu.has_avx2)
+        PrintResult("AVX2", avx2Elapsed, verts, avx2Err);
+    PrintResult("BlendSpans (dispatched, threaded)", threadedElapsed, verts, threadedErr);
+
+    return 0;
+}